@@ -0,0 +1,241 @@
+#include "OutputBuffer.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdint.h>
+
+// Powers of ten up to 10^27 are exact in an x87 80-bit long double.
+static const int MAX_EXACT_POWER = 27;
+static const long double POWERS_OF_TEN[MAX_EXACT_POWER + 1] = {
+	1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L,
+	1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L,
+	1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+};
+
+OutputBuffer::OutputBuffer(void)
+	: _sink(NULL), _data(NULL), _size(0), _capacity(0),
+	  _flushBytes(DEFAULT_FLUSH_BYTES), _precision(6) {
+}
+
+OutputBuffer::OutputBuffer(std::ostream& sink, size_t flushBytes)
+	: _sink(&sink), _data(NULL), _size(0), _capacity(0),
+	  _flushBytes(flushBytes == 0 ? 1 : flushBytes), _precision(6) {
+}
+
+OutputBuffer::~OutputBuffer(void) {
+	try {
+		flush();
+	} catch (...) {
+	}
+	delete[] _data;
+}
+
+void OutputBuffer::setPrecision(int precision) {
+	_precision = precision;
+}
+
+void OutputBuffer::reserve(size_t capacity) {
+	if (capacity <= _capacity)
+		return;
+	size_t grown = _capacity < 4096 ? 4096 : _capacity * 2;
+	if (grown < capacity)
+		grown = capacity;
+	char* data = new char[grown];
+	if (_size > 0)
+		std::memcpy(data, _data, _size);
+	delete[] _data;
+	_data = data;
+	_capacity = grown;
+}
+
+OutputBuffer& OutputBuffer::write(const char* text, size_t length) {
+	if (length == 0)
+		return *this;
+	if (_sink != NULL && _size + length > _flushBytes) {
+		flush();
+		if (length >= _flushBytes) {
+			_sink->write(text, static_cast<std::streamsize>(length));
+			return *this;
+		}
+	}
+	if (_size + length > _capacity)
+		reserve(_size + length);
+	std::memcpy(_data + _size, text, length);
+	_size += length;
+	return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(const char* text) {
+	return write(text, std::strlen(text));
+}
+
+OutputBuffer& OutputBuffer::operator<<(const std::string& text) {
+	return write(text.data(), text.size());
+}
+
+OutputBuffer& OutputBuffer::operator<<(char character) {
+	return write(&character, 1);
+}
+
+OutputBuffer& OutputBuffer::operator<<(int value) {
+	return *this << static_cast<long>(value);
+}
+
+OutputBuffer& OutputBuffer::operator<<(long value) {
+	if (value < 0) {
+		*this << '-';
+		appendUnsigned(0UL - static_cast<unsigned long>(value));
+	} else {
+		appendUnsigned(static_cast<unsigned long>(value));
+	}
+	return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(unsigned long value) {
+	appendUnsigned(value);
+	return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(double value) {
+	appendDouble(value);
+	return *this;
+}
+
+void OutputBuffer::appendUnsigned(unsigned long value) {
+	char digits[24];
+	size_t count = 0;
+	do {
+		digits[sizeof(digits) - 1 - count] = static_cast<char>('0' + value % 10);
+		value /= 10;
+		count++;
+	} while (value != 0);
+	write(digits + sizeof(digits) - count, count);
+}
+
+void OutputBuffer::appendDouble(double value) {
+	char text[64];
+	size_t length = formatGeneral(value, text);
+	if (length > 0) {
+		write(text, length);
+		return;
+	}
+	std::ostringstream fallback;
+	fallback.precision(_precision);
+	fallback << value;
+	*this << fallback.str();
+}
+
+// Produces what an ostream prints for `value` in default floatfield (the
+// %g rules). The value is scaled to `precision` integer digits with a single
+// rounding in long double; results whose rounding could depend on that error,
+// or that need an inexact power of ten, return 0 and go through ostringstream.
+size_t OutputBuffer::formatGeneral(double value, char* text) const {
+	int precision = _precision <= 0 ? 1 : _precision;
+	if (precision > 17 || std::numeric_limits<long double>::digits < 64)
+		return 0;
+	if (value != value || value - value != 0.0)
+		return 0;
+
+	size_t length = 0;
+	if (value < 0.0 || (value == 0.0 && 1.0 / value < 0.0))
+		text[length++] = '-';
+	if (value == 0.0) {
+		text[length++] = '0';
+		return length;
+	}
+
+	long double magnitude = std::fabs(static_cast<long double>(value));
+	long double low = POWERS_OF_TEN[precision - 1];
+	long double high = POWERS_OF_TEN[precision];
+	int exponent = static_cast<int>(std::floor(std::log10(std::fabs(value))));
+	long double scaled = 0.0L;
+	for (int attempt = 0; ; attempt++) {
+		int shift = precision - 1 - exponent;
+		if (attempt == 3 || shift > MAX_EXACT_POWER || shift < -MAX_EXACT_POWER)
+			return 0;
+		scaled = shift >= 0 ? magnitude * POWERS_OF_TEN[shift]
+			: magnitude / POWERS_OF_TEN[-shift];
+		if (scaled < low)
+			exponent--;
+		else if (scaled >= high)
+			exponent++;
+		else
+			break;
+	}
+
+	uint64_t mantissa = static_cast<uint64_t>(scaled);
+	long double fraction = scaled - static_cast<long double>(mantissa);
+	long double margin = std::ldexp(scaled, -60);
+	if (fraction > 0.5L - margin && fraction < 0.5L + margin)
+		return 0;
+	if (fraction > 0.5L)
+		mantissa++;
+	if (static_cast<long double>(mantissa) >= high) {
+		mantissa /= 10;
+		exponent++;
+	}
+
+	char digits[20];
+	for (int i = precision - 1; i >= 0; i--) {
+		digits[i] = static_cast<char>('0' + mantissa % 10);
+		mantissa /= 10;
+	}
+	int significant = precision;
+	while (significant > 1 && digits[significant - 1] == '0')
+		significant--;
+
+	if (exponent < -4 || exponent >= precision) {
+		text[length++] = digits[0];
+		if (significant > 1) {
+			text[length++] = '.';
+			for (int i = 1; i < significant; i++)
+				text[length++] = digits[i];
+		}
+		text[length++] = 'e';
+		text[length++] = exponent < 0 ? '-' : '+';
+		int power = exponent < 0 ? -exponent : exponent;
+		if (power >= 100)
+			text[length++] = static_cast<char>('0' + power / 100);
+		text[length++] = static_cast<char>('0' + power / 10 % 10);
+		text[length++] = static_cast<char>('0' + power % 10);
+	} else if (exponent >= 0) {
+		for (int i = 0; i <= exponent; i++)
+			text[length++] = i < significant ? digits[i] : '0';
+		if (significant > exponent + 1) {
+			text[length++] = '.';
+			for (int i = exponent + 1; i < significant; i++)
+				text[length++] = digits[i];
+		}
+	} else {
+		text[length++] = '0';
+		text[length++] = '.';
+		for (int i = -1; i > exponent; i--)
+			text[length++] = '0';
+		for (int i = 0; i < significant; i++)
+			text[length++] = digits[i];
+	}
+	return length;
+}
+
+const char* OutputBuffer::data(void) const {
+	return _data;
+}
+
+size_t OutputBuffer::size(void) const {
+	return _size;
+}
+
+void OutputBuffer::clear(void) {
+	_size = 0;
+}
+
+void OutputBuffer::flush(void) {
+	if (_sink == NULL)
+		return;
+	if (_size > 0)
+		_sink->write(_data, static_cast<std::streamsize>(_size));
+	_size = 0;
+	_sink->flush();
+}
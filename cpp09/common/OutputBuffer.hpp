@@ -0,0 +1,52 @@
+#ifndef OUTPUTBUFFER_HPP
+#define OUTPUTBUFFER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+// Batched text output for the cpp09 tools. Text and numbers are formatted
+// into one reusable buffer that is handed to the sink stream in large
+// blocks; without a sink the buffer just accumulates. Doubles use the same
+// digits as an ostream in default floatfield with the same precision.
+class OutputBuffer {
+private:
+	static const size_t DEFAULT_FLUSH_BYTES = 64 * 1024;
+
+	std::ostream* _sink;
+	char* _data;
+	size_t _size;
+	size_t _capacity;
+	size_t _flushBytes;
+	int _precision;
+
+	OutputBuffer(const OutputBuffer& other);
+	OutputBuffer& operator=(const OutputBuffer& other);
+
+	void reserve(size_t capacity);
+	void appendUnsigned(unsigned long value);
+	void appendDouble(double value);
+	size_t formatGeneral(double value, char* text) const;
+
+public:
+	OutputBuffer(void);
+	explicit OutputBuffer(std::ostream& sink, size_t flushBytes = DEFAULT_FLUSH_BYTES);
+	~OutputBuffer(void);
+
+	void setPrecision(int precision);
+	OutputBuffer& write(const char* text, size_t length);
+	OutputBuffer& operator<<(const char* text);
+	OutputBuffer& operator<<(const std::string& text);
+	OutputBuffer& operator<<(char character);
+	OutputBuffer& operator<<(int value);
+	OutputBuffer& operator<<(long value);
+	OutputBuffer& operator<<(unsigned long value);
+	OutputBuffer& operator<<(double value);
+
+	const char* data(void) const;
+	size_t size(void) const;
+	void clear(void);
+	void flush(void);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "TaskFailure.hpp"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+TaskFailure::TaskFailure(void) : _kind(NONE) {
+	_message[0] = '\0';
+}
+
+TaskFailure::TaskFailure(const TaskFailure& other) : _kind(other._kind) {
+	std::memcpy(_message, other._message, MESSAGE_CAPACITY);
+}
+
+TaskFailure& TaskFailure::operator=(const TaskFailure& other) {
+	if (this != &other) {
+		_kind = other._kind;
+		std::memcpy(_message, other._message, MESSAGE_CAPACITY);
+	}
+	return *this;
+}
+
+TaskFailure::~TaskFailure(void) {
+}
+
+void TaskFailure::clear(void) {
+	_kind = NONE;
+	_message[0] = '\0';
+}
+
+bool TaskFailure::failed(void) const {
+	return _kind != NONE;
+}
+
+// The most derived standard family wins: length_error and out_of_range
+// are logic_errors too.
+void TaskFailure::capture(const std::exception& error) throw() {
+	if (dynamic_cast<const std::bad_alloc*>(&error) != NULL) {
+		_kind = OUT_OF_MEMORY;
+	} else if (dynamic_cast<const std::length_error*>(&error) != NULL) {
+		_kind = LENGTH_ERROR;
+	} else if (dynamic_cast<const std::out_of_range*>(&error) != NULL) {
+		_kind = OUT_OF_RANGE;
+	} else if (dynamic_cast<const std::logic_error*>(&error) != NULL) {
+		_kind = LOGIC_ERROR;
+	} else {
+		_kind = RUNTIME_ERROR;
+	}
+	const char* text = error.what();
+	size_t length = text == NULL ? 0 : std::strlen(text);
+	if (length >= MESSAGE_CAPACITY)
+		length = MESSAGE_CAPACITY - 1;
+	if (length != 0)
+		std::memcpy(_message, text, length);
+	_message[length] = '\0';
+}
+
+void TaskFailure::captureUnknown(void) throw() {
+	static const char text[] = "unknown exception in worker thread";
+	_kind = RUNTIME_ERROR;
+	std::memcpy(_message, text, sizeof(text));
+}
+
+void TaskFailure::rethrow(void) const {
+	switch (_kind) {
+	case NONE:
+		return;
+	case OUT_OF_MEMORY:
+		throw std::bad_alloc();
+	case LENGTH_ERROR:
+		throw std::length_error(_message);
+	case OUT_OF_RANGE:
+		throw std::out_of_range(_message);
+	case LOGIC_ERROR:
+		throw std::logic_error(_message);
+	case RUNTIME_ERROR:
+		throw std::runtime_error(_message);
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef TASKFAILURE_HPP
+#define TASKFAILURE_HPP
+
+#include <cstddef>
+#include <exception>
+
+// Carries an exception out of a worker thread. C++98 has no
+// exception_ptr, so the worker records the kind and what() text of what it
+// caught, without allocating, and the joining thread throws an exception
+// of the same standard family with the same text.
+class TaskFailure {
+public:
+	static const size_t MESSAGE_CAPACITY = 256;
+
+private:
+	enum Kind {
+		NONE,
+		OUT_OF_MEMORY,
+		LENGTH_ERROR,
+		OUT_OF_RANGE,
+		LOGIC_ERROR,
+		RUNTIME_ERROR
+	};
+
+	Kind _kind;
+	char _message[MESSAGE_CAPACITY];
+
+public:
+	TaskFailure(void);
+	TaskFailure(const TaskFailure& other);
+	TaskFailure& operator=(const TaskFailure& other);
+	~TaskFailure(void);
+
+	void clear(void);
+	bool failed(void) const;
+	void capture(const std::exception& error) throw();
+	void captureUnknown(void) throw();
+	// Throws the recorded exception; does nothing when none was recorded.
+	void rethrow(void) const;
+};
+
+#endif
@@ -0,0 +1,562 @@
+#include "AssetRateStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// First row of an asset without samples.
+static const size_t NO_ROW = static_cast<size_t>(-1);
+
+// Gorilla XOR coding: a repeated value costs one bit; otherwise the
+// changed bits are written inside the previous leading/trailing-zero
+// window when they fit, or with a new 5-bit leading and 6-bit length
+// header when they do not.
+static const unsigned NO_WINDOW = 64;
+static const unsigned MAX_LEADING_ZEROS = 31;
+
+struct GorillaState {
+	uint64_t previous;
+	unsigned leading;
+	unsigned trailing;
+	bool started;
+};
+
+static unsigned leadingZeros(uint64_t value) {
+#if defined(__GNUC__)
+	return static_cast<unsigned>(__builtin_clzll(value));
+#else
+	unsigned count = 0;
+	for (uint64_t bit = static_cast<uint64_t>(1) << 63; (value & bit) == 0; bit >>= 1)
+		count++;
+	return count;
+#endif
+}
+
+static unsigned trailingZeros(uint64_t value) {
+#if defined(__GNUC__)
+	return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+	unsigned count = 0;
+	for (; (value & 1) == 0; value >>= 1)
+		count++;
+	return count;
+#endif
+}
+
+static uint64_t lowBits(unsigned count) {
+	return count >= 64 ? ~static_cast<uint64_t>(0) : (static_cast<uint64_t>(1) << count) - 1;
+}
+
+// The value columns are encoded into one zero-filled word array that
+// doubles when full; `position` is the next bit to write.
+struct AssetRateStore::BitWriter {
+	uint64_t* words;
+	size_t capacity;
+	size_t position;
+
+	void write(uint64_t value, unsigned count);
+	void encode(GorillaState& state, uint64_t bits);
+	void alignToWord(void);
+};
+
+// Bits are stored most significant first; count is 1 to 64.
+void AssetRateStore::BitWriter::write(uint64_t value, unsigned count) {
+	value &= lowBits(count);
+	size_t word = position / 64;
+	unsigned room = 64 - static_cast<unsigned>(position % 64);
+	if (word + 1 >= capacity) {
+		size_t grown = capacity < 256 ? 256 : capacity * 2;
+		uint64_t* copy = new uint64_t[grown]();
+		for (size_t i = 0; i < capacity; i++)
+			copy[i] = words[i];
+		delete[] words;
+		words = copy;
+		capacity = grown;
+	}
+	if (count <= room) {
+		words[word] |= value << (room - count);
+	} else {
+		words[word] |= value >> (count - room);
+		words[word + 1] = value << (64 - (count - room));
+	}
+	position += count;
+}
+
+void AssetRateStore::BitWriter::alignToWord(void) {
+	position = (position + 63) / 64 * 64;
+}
+
+static uint64_t readBits(const uint64_t* words, size_t& position, unsigned count) {
+	size_t word = position / 64;
+	unsigned room = 64 - static_cast<unsigned>(position % 64);
+	position += count;
+	if (count <= room)
+		return words[word] >> (room - count) & lowBits(count);
+	uint64_t high = words[word] & lowBits(room);
+	return high << (count - room) | words[word + 1] >> (64 - (count - room));
+}
+
+static void resetGorilla(GorillaState& state) {
+	state.previous = 0;
+	state.leading = NO_WINDOW;
+	state.trailing = 0;
+	state.started = false;
+}
+
+void AssetRateStore::BitWriter::encode(GorillaState& state, uint64_t bits) {
+	if (!state.started) {
+		write(bits, 64);
+		state.previous = bits;
+		state.started = true;
+		return;
+	}
+	uint64_t changed = bits ^ state.previous;
+	state.previous = bits;
+	if (changed == 0) {
+		write(0, 1);
+		return;
+	}
+	unsigned leading = leadingZeros(changed);
+	unsigned trailing = trailingZeros(changed);
+	if (leading > MAX_LEADING_ZEROS)
+		leading = MAX_LEADING_ZEROS;
+	if (state.leading != NO_WINDOW && leading >= state.leading && trailing >= state.trailing) {
+		write(2, 2);
+		write(changed >> state.trailing,
+			64 - state.leading - state.trailing);
+		return;
+	}
+	unsigned length = 64 - leading - trailing;
+	write(3, 2);
+	write(leading, 5);
+	write(length - 1, 6);
+	write(changed >> trailing, length);
+	state.leading = leading;
+	state.trailing = trailing;
+}
+
+static uint64_t decodeValue(const uint64_t* words, size_t& position, GorillaState& state) {
+	if (!state.started) {
+		state.previous = readBits(words, position, 64);
+		state.started = true;
+		return state.previous;
+	}
+	if (readBits(words, position, 1) == 0)
+		return state.previous;
+	if (readBits(words, position, 1) == 1) {
+		state.leading = static_cast<unsigned>(readBits(words, position, 5));
+		unsigned length = static_cast<unsigned>(readBits(words, position, 6)) + 1;
+		state.trailing = 64 - state.leading - length;
+	}
+	unsigned length = 64 - state.leading - state.trailing;
+	state.previous ^= readBits(words, position, length) << state.trailing;
+	return state.previous;
+}
+
+static size_t varintBytes(unsigned int value) {
+	size_t bytes = 1;
+	for (; value >= 0x80; value >>= 7)
+		bytes++;
+	return bytes;
+}
+
+static void writeVarint(unsigned char*& cursor, unsigned int value) {
+	while (value >= 0x80) {
+		*cursor++ = static_cast<unsigned char>(value | 0x80);
+		value >>= 7;
+	}
+	*cursor++ = static_cast<unsigned char>(value);
+}
+
+static unsigned int readVarint(const unsigned char*& cursor) {
+	unsigned int value = 0;
+	for (unsigned shift = 0; ; shift += 7) {
+		unsigned char byte = *cursor++;
+		value |= static_cast<unsigned int>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return value;
+	}
+}
+
+static uint64_t doubleBits(double value) {
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+// Grows `data`, which holds `size` elements, to at least `needed` slots.
+template <typename T>
+static void reserveArray(T*& data, size_t size, size_t& capacity, size_t needed) {
+	if (needed <= capacity)
+		return;
+	size_t grown = capacity < 8 ? 8 : capacity * 2;
+	if (grown < needed)
+		grown = needed;
+	T* copy = new T[grown];
+	try {
+		for (size_t i = 0; i < size; i++)
+			copy[i] = data[i];
+	} catch (...) {
+		delete[] copy;
+		throw;
+	}
+	delete[] data;
+	data = copy;
+	capacity = grown;
+}
+
+// A new[] copy of `count` elements, or NULL when there are none.
+template <typename T>
+static T* copyArray(const T* source, size_t count) {
+	if (count == 0)
+		return NULL;
+	T* copy = new T[count];
+	try {
+		for (size_t i = 0; i < count; i++)
+			copy[i] = source[i];
+	} catch (...) {
+		delete[] copy;
+		throw;
+	}
+	return copy;
+}
+
+AssetRateStore::AssetRateStore(void)
+	: _names(NULL), _assetCount(0), _nameCapacity(0), _pending(NULL), _pendingCount(0),
+	  _pendingCapacity(0), _blockFirstDays(NULL), _blockDayOffsets(NULL), _blocks(0),
+	  _dayDeltas(NULL), _dayDeltaBytes(0), _firstRows(NULL), _columnOffsets(NULL),
+	  _columnAssets(0), _valueBits(NULL), _valueWords(0), _rows(0) {
+}
+
+AssetRateStore::AssetRateStore(const AssetRateStore& other)
+	: _names(NULL), _assetCount(other._assetCount), _nameCapacity(other._assetCount),
+	  _pending(NULL), _pendingCount(other._pendingCount),
+	  _pendingCapacity(other._pendingCount), _blockFirstDays(NULL),
+	  _blockDayOffsets(NULL), _blocks(other._blocks), _dayDeltas(NULL),
+	  _dayDeltaBytes(other._dayDeltaBytes), _firstRows(NULL), _columnOffsets(NULL),
+	  _columnAssets(other._columnAssets), _valueBits(NULL),
+	  _valueWords(other._valueWords), _rows(other._rows) {
+	try {
+		_names = copyArray(other._names, _assetCount);
+		_pending = copyArray(other._pending, _pendingCount);
+		_blockFirstDays = copyArray(other._blockFirstDays, _blocks);
+		_blockDayOffsets = copyArray(other._blockDayOffsets, _blocks);
+		_dayDeltas = copyArray(other._dayDeltas, _dayDeltaBytes);
+		_firstRows = copyArray(other._firstRows, _columnAssets);
+		_columnOffsets = copyArray(other._columnOffsets, _columnAssets * _blocks);
+		_valueBits = copyArray(other._valueBits, _valueWords);
+	} catch (...) {
+		release();
+		throw;
+	}
+}
+
+AssetRateStore& AssetRateStore::operator=(const AssetRateStore& other) {
+	if (this != &other) {
+		AssetRateStore copy(other);
+		swap(copy);
+	}
+	return *this;
+}
+
+AssetRateStore::~AssetRateStore(void) {
+	release();
+}
+
+void AssetRateStore::release(void) {
+	delete[] _names;
+	delete[] _pending;
+	_names = NULL;
+	_pending = NULL;
+	clearColumns();
+}
+
+// Keeps the name and sample arrays for reuse.
+void AssetRateStore::clear(void) {
+	_assetCount = 0;
+	_pendingCount = 0;
+	clearColumns();
+}
+
+void AssetRateStore::clearColumns(void) {
+	delete[] _blockFirstDays;
+	delete[] _blockDayOffsets;
+	delete[] _dayDeltas;
+	delete[] _firstRows;
+	delete[] _columnOffsets;
+	delete[] _valueBits;
+	_blockFirstDays = NULL;
+	_blockDayOffsets = NULL;
+	_dayDeltas = NULL;
+	_firstRows = NULL;
+	_columnOffsets = NULL;
+	_valueBits = NULL;
+	_blocks = 0;
+	_dayDeltaBytes = 0;
+	_columnAssets = 0;
+	_valueWords = 0;
+	_rows = 0;
+}
+
+void AssetRateStore::swap(AssetRateStore& other) {
+	std::swap(_names, other._names);
+	std::swap(_assetCount, other._assetCount);
+	std::swap(_nameCapacity, other._nameCapacity);
+	std::swap(_pending, other._pending);
+	std::swap(_pendingCount, other._pendingCount);
+	std::swap(_pendingCapacity, other._pendingCapacity);
+	std::swap(_blockFirstDays, other._blockFirstDays);
+	std::swap(_blockDayOffsets, other._blockDayOffsets);
+	std::swap(_blocks, other._blocks);
+	std::swap(_dayDeltas, other._dayDeltas);
+	std::swap(_dayDeltaBytes, other._dayDeltaBytes);
+	std::swap(_firstRows, other._firstRows);
+	std::swap(_columnOffsets, other._columnOffsets);
+	std::swap(_columnAssets, other._columnAssets);
+	std::swap(_valueBits, other._valueBits);
+	std::swap(_valueWords, other._valueWords);
+	std::swap(_rows, other._rows);
+}
+
+// Returns the id of the asset called `name`, adding it if needed.
+size_t AssetRateStore::addAsset(const std::string& name) {
+	size_t asset;
+	if (findAsset(name, asset))
+		return asset;
+	reserveArray(_names, _assetCount, _nameCapacity, _assetCount + 1);
+	_names[_assetCount] = name;
+	return _assetCount++;
+}
+
+bool AssetRateStore::findAsset(const std::string& name, size_t& asset) const {
+	for (size_t i = 0; i < _assetCount; i++) {
+		if (_names[i] == name) {
+			asset = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t AssetRateStore::assetCount(void) const {
+	return _assetCount;
+}
+
+const std::string& AssetRateStore::assetName(size_t asset) const {
+	return _names[asset];
+}
+
+// Samples become visible to find() at the next finalize(). Appending to
+// a finalized store first decodes it back into samples, one per change
+// of value, which keeps every lookup result.
+void AssetRateStore::append(size_t asset, int day, double rate) {
+	if (_rows > 0)
+		expand();
+	stage(asset, day, rate);
+}
+
+void AssetRateStore::stage(size_t asset, int day, double rate) {
+	reserveArray(_pending, _pendingCount, _pendingCapacity, _pendingCount + 1);
+	Sample& sample = _pending[_pendingCount++];
+	sample.asset = asset;
+	sample.day = day;
+	sample.rate = rate;
+}
+
+bool AssetRateStore::sampleBefore(const Sample& left, const Sample& right) {
+	if (left.asset != right.asset)
+		return left.asset < right.asset;
+	return left.day < right.day;
+}
+
+void AssetRateStore::encodeDays(const int* days, size_t count) {
+	size_t bytes = 0;
+	for (size_t row = 0; row < count; row++) {
+		if (row % BLOCK_ROWS != 0)
+			bytes += varintBytes(static_cast<unsigned int>(days[row] - days[row - 1]));
+	}
+	_blocks = (count + BLOCK_ROWS - 1) / BLOCK_ROWS;
+	_blockFirstDays = new int[_blocks];
+	_blockDayOffsets = new size_t[_blocks];
+	_dayDeltas = new unsigned char[bytes == 0 ? 1 : bytes];
+	_dayDeltaBytes = bytes;
+	unsigned char* cursor = _dayDeltas;
+	for (size_t row = 0; row < count; row++) {
+		if (row % BLOCK_ROWS == 0) {
+			_blockFirstDays[row / BLOCK_ROWS] = days[row];
+			_blockDayOffsets[row / BLOCK_ROWS] = static_cast<size_t>(cursor - _dayDeltas);
+		} else {
+			writeVarint(cursor, static_cast<unsigned int>(days[row] - days[row - 1]));
+		}
+	}
+}
+
+// Rows before the first sample repeat the first rate; find() never
+// returns them, and repeats cost one bit each.
+void AssetRateStore::encodeColumn(BitWriter& out, size_t asset, const int* days,
+	const Sample* samples, size_t count) {
+	_firstRows[asset] = static_cast<size_t>(
+		std::lower_bound(days, days + _rows, samples[0].day) - days);
+	out.alignToWord();
+	size_t next = 0;
+	uint64_t current = doubleBits(samples[0].rate);
+	GorillaState state;
+	resetGorilla(state);
+	for (size_t row = 0; row < _rows; row++) {
+		if (row % BLOCK_ROWS == 0) {
+			_columnOffsets[asset * _blocks + row / BLOCK_ROWS] = out.position;
+			resetGorilla(state);
+		}
+		if (next < count && samples[next].day == days[row])
+			current = doubleBits(samples[next++].rate);
+		out.encode(state, current);
+	}
+}
+
+// Sorts the staged samples (the last one appended wins for a repeated
+// asset and day) and rebuilds the compressed columns from them.
+void AssetRateStore::finalize(void) {
+	if (_pendingCount == 0)
+		return;
+	std::stable_sort(_pending, _pending + _pendingCount, sampleBefore);
+	size_t kept = 0;
+	for (size_t i = 0; i < _pendingCount; i++) {
+		if (kept > 0 && _pending[kept - 1].asset == _pending[i].asset
+			&& _pending[kept - 1].day == _pending[i].day)
+			_pending[kept - 1] = _pending[i];
+		else
+			_pending[kept++] = _pending[i];
+	}
+	_pendingCount = kept;
+
+	int* days = new int[_pendingCount];
+	for (size_t i = 0; i < _pendingCount; i++)
+		days[i] = _pending[i].day;
+	std::sort(days, days + _pendingCount);
+	size_t dayCount = static_cast<size_t>(std::unique(days, days + _pendingCount) - days);
+
+	BitWriter out;
+	out.words = NULL;
+	out.capacity = 0;
+	out.position = 0;
+	clearColumns();
+	try {
+		_rows = dayCount;
+		encodeDays(days, dayCount);
+		_firstRows = new size_t[_assetCount];
+		_columnOffsets = new size_t[_assetCount * _blocks]();
+		_columnAssets = _assetCount;
+		for (size_t asset = 0; asset < _assetCount; asset++)
+			_firstRows[asset] = NO_ROW;
+		for (size_t begin = 0; begin < _pendingCount;) {
+			size_t end = begin;
+			while (end < _pendingCount && _pending[end].asset == _pending[begin].asset)
+				end++;
+			encodeColumn(out, _pending[begin].asset, days, &_pending[begin], end - begin);
+			begin = end;
+		}
+	} catch (...) {
+		delete[] out.words;
+		delete[] days;
+		clearColumns();
+		throw;
+	}
+	delete[] days;
+	_valueBits = out.words;
+	_valueWords = (out.position + 63) / 64;
+	delete[] _pending;
+	_pending = NULL;
+	_pendingCount = 0;
+	_pendingCapacity = 0;
+}
+
+void AssetRateStore::decodeColumn(size_t asset, uint64_t* values) const {
+	GorillaState state;
+	size_t position = 0;
+	for (size_t row = 0; row < _rows; row++) {
+		if (row % BLOCK_ROWS == 0) {
+			position = _columnOffsets[asset * _blocks + row / BLOCK_ROWS];
+			resetGorilla(state);
+		}
+		values[row] = decodeValue(_valueBits, position, state);
+	}
+}
+
+void AssetRateStore::expand(void) {
+	int* days = new int[_rows];
+	uint64_t* values = NULL;
+	try {
+		values = new uint64_t[_rows];
+		const unsigned char* cursor = _dayDeltas;
+		for (size_t row = 0; row < _rows; row++) {
+			days[row] = row % BLOCK_ROWS == 0 ? _blockFirstDays[row / BLOCK_ROWS]
+				: days[row - 1] + static_cast<int>(readVarint(cursor));
+		}
+		for (size_t asset = 0; asset < _columnAssets; asset++) {
+			if (_firstRows[asset] == NO_ROW)
+				continue;
+			decodeColumn(asset, values);
+			for (size_t row = _firstRows[asset]; row < _rows; row++) {
+				if (row != _firstRows[asset] && values[row] == values[row - 1])
+					continue;
+				double rate;
+				std::memcpy(&rate, &values[row], sizeof(rate));
+				stage(asset, days[row], rate);
+			}
+		}
+	} catch (...) {
+		delete[] values;
+		delete[] days;
+		throw;
+	}
+	delete[] values;
+	delete[] days;
+	clearColumns();
+}
+
+// The rate of the closest date at or before `day` on which the asset has
+// a sample.
+bool AssetRateStore::find(size_t asset, int day, double& rate) const {
+	if (asset >= _columnAssets || _firstRows[asset] == NO_ROW || day < _blockFirstDays[0])
+		return false;
+	size_t block = static_cast<size_t>(std::upper_bound(_blockFirstDays,
+		_blockFirstDays + _blocks, day) - _blockFirstDays) - 1;
+	size_t first = block * BLOCK_ROWS;
+	size_t last = first + BLOCK_ROWS < _rows ? first + BLOCK_ROWS : _rows;
+	size_t row = first;
+	int current = _blockFirstDays[block];
+	const unsigned char* cursor = _dayDeltas + _blockDayOffsets[block];
+	while (row + 1 < last) {
+		const unsigned char* next = cursor;
+		int following = current + static_cast<int>(readVarint(next));
+		if (following > day)
+			break;
+		current = following;
+		cursor = next;
+		row++;
+	}
+	if (row < _firstRows[asset])
+		return false;
+
+	size_t position = _columnOffsets[asset * _blocks + block];
+	GorillaState state;
+	resetGorilla(state);
+	uint64_t bits = 0;
+	for (size_t i = first; i <= row; i++)
+		bits = decodeValue(_valueBits, position, state);
+	std::memcpy(&rate, &bits, sizeof(rate));
+	return true;
+}
+
+size_t AssetRateStore::rows(void) const {
+	return _rows;
+}
+
+// Bytes held by the date and value columns and their block indexes.
+size_t AssetRateStore::compressedBytes(void) const {
+	return _blocks * sizeof(int)
+		+ _blocks * sizeof(size_t)
+		+ _dayDeltaBytes
+		+ _columnAssets * sizeof(size_t)
+		+ _columnAssets * _blocks * sizeof(size_t)
+		+ _valueWords * sizeof(uint64_t);
+}
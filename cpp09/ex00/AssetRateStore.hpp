@@ -0,0 +1,75 @@
+#ifndef ASSETRATESTORE_HPP
+#define ASSETRATESTORE_HPP
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+// Rate histories of many assets in compressed columns. All assets share
+// one ascending date column, kept per block of BLOCK_ROWS rows as the
+// block's first day and varint day deltas. Each asset has a value column
+// over the same rows in which a row repeats the asset's last rate until
+// its next sample, so a row holds the rate of the closest earlier date.
+// Values are Gorilla-compressed (XOR with the previous row) and restart
+// at every block. A lookup binary-searches the block first days and
+// decodes one block of the date column and of the asset's column.
+class AssetRateStore {
+public:
+	static const size_t BLOCK_ROWS = 16;
+
+private:
+	struct Sample {
+		size_t asset;
+		int day;
+		double rate;
+	};
+	struct BitWriter;
+
+	std::string* _names;
+	size_t _assetCount;
+	size_t _nameCapacity;
+	Sample* _pending;
+	size_t _pendingCount;
+	size_t _pendingCapacity;
+	int* _blockFirstDays;
+	size_t* _blockDayOffsets;
+	size_t _blocks;
+	unsigned char* _dayDeltas;
+	size_t _dayDeltaBytes;
+	size_t* _firstRows;
+	size_t* _columnOffsets;
+	size_t _columnAssets;
+	uint64_t* _valueBits;
+	size_t _valueWords;
+	size_t _rows;
+
+	static bool sampleBefore(const Sample& left, const Sample& right);
+	void stage(size_t asset, int day, double rate);
+	void encodeDays(const int* days, size_t count);
+	void encodeColumn(BitWriter& out, size_t asset, const int* days,
+		const Sample* samples, size_t count);
+	void decodeColumn(size_t asset, uint64_t* values) const;
+	void expand(void);
+	void clearColumns(void);
+	void release(void);
+
+public:
+	AssetRateStore(void);
+	AssetRateStore(const AssetRateStore& other);
+	AssetRateStore& operator=(const AssetRateStore& other);
+	~AssetRateStore(void);
+
+	void clear(void);
+	void swap(AssetRateStore& other);
+	size_t addAsset(const std::string& name);
+	bool findAsset(const std::string& name, size_t& asset) const;
+	size_t assetCount(void) const;
+	const std::string& assetName(size_t asset) const;
+	void append(size_t asset, int day, double rate);
+	void finalize(void);
+	bool find(size_t asset, int day, double& rate) const;
+	size_t rows(void) const;
+	size_t compressedBytes(void) const;
+};
+
+#endif
@@ -1,22 +1,39 @@
 #include "BitcoinExchange.hpp"
+#include "DecimalParser.hpp"
+#include "LineRing.hpp"
+#include "LineScanner.hpp"
+#include "LiveRateTable.hpp"
+#include "MappedFile.hpp"
+#include "OutputBuffer.hpp"
+#include "TaskFailure.hpp"
 
-#include <cctype>
-#include <cstdlib>
-#include <fstream>
-#include <iomanip>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <limits>
-#include <sstream>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-BitcoinExchange::BitcoinExchange(void) {
+BitcoinExchange::BitcoinExchange(void)
+	: _denseIndex(true), _rangeIndex(false), _threadCount(1), _statsEnabled(false) {
 }
 
-BitcoinExchange::BitcoinExchange(const BitcoinExchange& other) : _exchangeRates(other._exchangeRates) {
+BitcoinExchange::BitcoinExchange(const BitcoinExchange& other)
+	: _exchangeRates(other._exchangeRates), _denseIndex(other._denseIndex),
+	  _rangeIndex(other._rangeIndex), _threadCount(other._threadCount),
+	  _statsEnabled(other._statsEnabled), _stats(other._stats), _assets(other._assets) {
 }
 
 BitcoinExchange& BitcoinExchange::operator=(const BitcoinExchange& other) {
 	if (this != &other) {
 		_exchangeRates = other._exchangeRates;
+		_denseIndex = other._denseIndex;
+		_rangeIndex = other._rangeIndex;
+		_threadCount = other._threadCount;
+		_statsEnabled = other._statsEnabled;
+		_stats = other._stats;
+		_assets = other._assets;
 	}
 	return *this;
 }
@@ -54,204 +71,734 @@ const char* BitcoinExchange::InvalidValueException::what() const throw() {
 	return _message.c_str();
 }
 
-std::string BitcoinExchange::trim(const std::string& str) const {
-	size_t first = str.find_first_not_of(" \t\r\n");
-	if (first == std::string::npos) {
-		return "";
-	}
-	size_t last = str.find_last_not_of(" \t\r\n");
-	return str.substr(first, (last - first + 1));
+static bool isTrimmed(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
 }
 
-double BitcoinExchange::stringToDouble(const std::string& str) const {
-	std::istringstream iss(str);
-	double value;
-	iss >> value;
-	if (iss.fail() || !iss.eof() || value != value ||
-		value == std::numeric_limits<double>::infinity() ||
-		value == -std::numeric_limits<double>::infinity()) {
-		throw InvalidFormatException("Invalid number format");
+void BitcoinExchange::trimRange(const char*& begin, const char*& end) const {
+	while (begin < end && isTrimmed(*begin)) {
+		++begin;
+	}
+	while (end > begin && isTrimmed(end[-1])) {
+		--end;
 	}
-	return value;
 }
 
-bool BitcoinExchange::isLeapYear(int year) const {
-	return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+// Merges the CSV into the current rates and publishes the result as a new
+// version; a file that fails to parse leaves the published rates as they
+// were.
+void BitcoinExchange::loadDatabase(const std::string& filename) {
+	uint64_t start = PipelineStats::nanos();
+	MappedFile file;
+	if (!file.open(filename)) {
+		throw FileException("Could not open database file: " + filename);
+	}
+	
+	LiveRateTable::WriteGuard update(_exchangeRates);
+	parseDatabase(file.data(), file.data() + file.size(), update.draft());
+	finishDraft(update.draft());
+	if (_statsEnabled) {
+		_stats.recordLoad(PipelineStats::nanos() - start, update.draft().size());
+	}
+	update.commit();
 }
 
-bool BitcoinExchange::validateDateFormat(const std::string& date) const {
-	if (date.length() != 10) {
-		return false;
+// Called by writers before publishing: sorts the draft and gives it the
+// calendar and range indexes when enabled.
+void BitcoinExchange::finishDraft(RateTable& table) const {
+	table.finalize();
+	if (_rangeIndex) {
+		table.buildRangeIndex();
 	}
-	if (date[4] != '-' || date[7] != '-') {
-		return false;
-	}
-	
-	for (int i = 0; i < 10; i++) {
-		if (i == 4 || i == 7) continue;
-		if (!std::isdigit(static_cast<unsigned char>(date[i]))) {
-			return false;
-		}
+	if (_denseIndex) {
+		table.buildDenseIndex(MAX_DENSE_SLOTS_PER_ENTRY);
 	}
-	return true;
 }
 
-bool BitcoinExchange::isValidDate(const std::string& date) const {
-	if (!validateDateFormat(date)) {
-		return false;
+// Modification time in nanoseconds since the epoch.
+static uint64_t modificationNanos(const struct stat& info) {
+#if defined(__APPLE__)
+	uint64_t nanos = static_cast<uint64_t>(info.st_mtimespec.tv_nsec);
+#else
+	uint64_t nanos = static_cast<uint64_t>(info.st_mtim.tv_nsec);
+#endif
+	return static_cast<uint64_t>(info.st_mtime) * 1000000000u + nanos;
+}
+
+// Replaces the table with the CSV's contents, taken from the binary
+// snapshot when it was written for this CSV (same size, nanosecond mtime
+// and sampled content hash) and its payload still checksums. Otherwise the
+// CSV is parsed and the snapshot rewritten; failing to write it only costs
+// the next run a parse.
+void BitcoinExchange::loadDatabase(const std::string& filename, const std::string& snapshotPath) {
+	uint64_t start = PipelineStats::nanos();
+	struct stat info;
+	MappedFile file;
+	if (stat(filename.c_str(), &info) != 0 || !file.open(filename)) {
+		throw FileException("Could not open database file: " + filename);
 	}
+	uint64_t sourceSize = static_cast<uint64_t>(info.st_size);
+	uint64_t sourceMtime = modificationNanos(info);
+	uint64_t sourceSample = RateTable::sourceSample(file.data(), file.size());
 	
-	int year = std::atoi(date.substr(0, 4).c_str());
-	int month = std::atoi(date.substr(5, 2).c_str());
-	int day = std::atoi(date.substr(8, 2).c_str());
-	
-	if (year < 1) {
-		return false;
+	LiveRateTable::WriteGuard update(_exchangeRates);
+	RateTable& table = update.draft();
+	if (!table.loadSnapshot(snapshotPath, sourceSize, sourceMtime, sourceSample)) {
+		table.clear();
+		parseDatabase(file.data(), file.data() + file.size(), table);
+		table.finalize();
+		table.saveSnapshot(snapshotPath, sourceSize, sourceMtime, sourceSample);
 	}
-	if (month < 1 || month > 12) {
-		return false;
+	finishDraft(table);
+	if (_statsEnabled) {
+		_stats.recordLoad(PipelineStats::nanos() - start, table.size());
 	}
-	
-	int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-	if (isLeapYear(year)) {
-		daysInMonth[1] = 29;
+	update.commit();
+}
+
+// Adds or corrects the rate of one day. Readers keep using the version
+// they started with; lookups that start after the call see the new rate.
+void BitcoinExchange::updateRate(const std::string& date, double rate) {
+	int day;
+	if (!RateTable::decodeDate(date.data(), date.size(), day)) {
+		throw InvalidFormatException("Invalid date in database: " + date);
 	}
-	
-	if (day < 1 || day > daysInMonth[month - 1]) {
-		return false;
+	if (rate != rate || rate < 0 || rate == std::numeric_limits<double>::infinity()) {
+		throw InvalidValueException("Invalid exchange rate for date: " + date);
 	}
 	
-	return true;
+	LiveRateTable::WriteGuard update(_exchangeRates);
+	update.draft().append(day, rate);
+	finishDraft(update.draft());
+	update.commit();
 }
 
-void BitcoinExchange::loadDatabase(const std::string& filename) {
-	std::ifstream file(filename.c_str());
-	if (!file.is_open()) {
-		throw FileException("Could not open database file: " + filename);
+void BitcoinExchange::setDenseIndex(bool enabled) {
+	LiveRateTable::WriteGuard update(_exchangeRates);
+	_denseIndex = enabled;
+	if (!enabled) {
+		update.draft().dropDenseIndex();
+	} else if (update.draft().size() > 0) {
+		update.draft().buildDenseIndex(MAX_DENSE_SLOTS_PER_ENTRY);
 	}
-	
-	std::string line;
+	update.commit();
+}
+
+// Range queries scan the dates in range unless the index is on; it costs
+// a few words per rate and is rebuilt with every load and update, so the
+// pricing pipeline, which never asks for ranges, leaves it off.
+void BitcoinExchange::setRangeIndex(bool enabled) {
+	LiveRateTable::WriteGuard update(_exchangeRates);
+	_rangeIndex = enabled;
+	if (!enabled) {
+		update.draft().dropRangeIndex();
+	} else {
+		update.draft().buildRangeIndex();
+	}
+	update.commit();
+}
+
+void BitcoinExchange::parseDatabase(const char* cursor, const char* end, RateTable& table) const {
+	static const char header[] = "date,exchange_rate";
 	bool firstLine = true;
 	
-	while (std::getline(file, line)) {
-		if (!line.empty() && line[line.size() - 1] == '\r')
-			line.erase(line.size() - 1);
+	while (cursor < end) {
+		const char* lineBegin = cursor;
+		const char* lineEnd = static_cast<const char*>(
+			std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+		if (lineEnd == NULL) {
+			lineEnd = end;
+			cursor = end;
+		} else {
+			cursor = lineEnd + 1;
+		}
+		if (lineEnd != lineBegin && lineEnd[-1] == '\r')
+			--lineEnd;
+		size_t length = static_cast<size_t>(lineEnd - lineBegin);
 		if (firstLine) {
 			firstLine = false;
-			if (line == "date,exchange_rate") {
+			if (length == sizeof(header) - 1 &&
+				std::memcmp(lineBegin, header, length) == 0) {
 				continue;
 			}
 		}
 		
-		if (line.empty()) {
+		if (length == 0) {
 			continue;
 		}
 		
-		size_t commaPos = line.find(',');
-		if (commaPos == std::string::npos) {
-			throw InvalidFormatException("Invalid database format: " + line);
+		const char* comma = static_cast<const char*>(std::memchr(lineBegin, ',', length));
+		if (comma == NULL) {
+			throw InvalidFormatException("Invalid database format: " + std::string(lineBegin, length));
 		}
 		
-		std::string date = trim(line.substr(0, commaPos));
-		std::string rateStr = trim(line.substr(commaPos + 1));
+		const char* dateBegin = lineBegin;
+		const char* dateEnd = comma;
+		trimRange(dateBegin, dateEnd);
+		const char* rateBegin = comma + 1;
+		const char* rateEnd = lineEnd;
+		trimRange(rateBegin, rateEnd);
 		
-		if (!isValidDate(date)) {
-			throw InvalidFormatException("Invalid date in database: " + date);
+		int day;
+		if (!RateTable::decodeDate(dateBegin, static_cast<size_t>(dateEnd - dateBegin), day)) {
+			throw InvalidFormatException("Invalid date in database: " + std::string(dateBegin, dateEnd));
 		}
 		
-		try {
-			double rate = stringToDouble(rateStr);
+		double rate;
+		if (!DecimalParser::parse(rateBegin, static_cast<size_t>(rateEnd - rateBegin), rate)) {
+			throw InvalidFormatException("Invalid exchange rate format: " + std::string(rateBegin, rateEnd));
+		}
+		if (rate < 0) {
+			throw InvalidValueException("Negative exchange rate in database: " + std::string(rateBegin, rateEnd));
+		}
+		table.append(day, rate);
+	}
+}
+
+// Loads the rate histories of several assets from a wide CSV: a
+// "date,NAME,..." header, then one row per date with one rate per asset.
+// An empty cell means the asset has no rate that day. Replaces the
+// previous histories only when the whole file parses.
+void BitcoinExchange::loadAssetDatabase(const std::string& filename) {
+	MappedFile file;
+	if (!file.open(filename)) {
+		throw FileException("Could not open database file: " + filename);
+	}
+	
+	AssetRateStore store;
+	parseAssetDatabase(file.data(), file.data() + file.size(), store);
+	store.finalize();
+	_assets.swap(store);
+}
+
+void BitcoinExchange::parseAssetDatabase(const char* cursor, const char* end, AssetRateStore& store) const {
+	static const char dateColumn[] = "date";
+	bool headerRead = false;
+	
+	while (cursor < end) {
+		const char* lineBegin = cursor;
+		const char* lineEnd = static_cast<const char*>(
+			std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+		if (lineEnd == NULL) {
+			lineEnd = end;
+			cursor = end;
+		} else {
+			cursor = lineEnd + 1;
+		}
+		if (lineEnd != lineBegin && lineEnd[-1] == '\r')
+			--lineEnd;
+		if (lineEnd == lineBegin) {
+			continue;
+		}
+		
+		const char* cellEnd = static_cast<const char*>(
+			std::memchr(lineBegin, ',', static_cast<size_t>(lineEnd - lineBegin)));
+		if (cellEnd == NULL) {
+			throw InvalidFormatException("Invalid database format: " + std::string(lineBegin, lineEnd));
+		}
+		const char* dateBegin = lineBegin;
+		const char* dateEnd = cellEnd;
+		trimRange(dateBegin, dateEnd);
+		
+		if (!headerRead) {
+			headerRead = true;
+			if (static_cast<size_t>(dateEnd - dateBegin) != sizeof(dateColumn) - 1 ||
+				std::memcmp(dateBegin, dateColumn, sizeof(dateColumn) - 1) != 0) {
+				throw InvalidFormatException("Invalid database header: " + std::string(lineBegin, lineEnd));
+			}
+			while (cellEnd < lineEnd) {
+				const char* nameBegin = cellEnd + 1;
+				cellEnd = static_cast<const char*>(
+					std::memchr(nameBegin, ',', static_cast<size_t>(lineEnd - nameBegin)));
+				if (cellEnd == NULL) {
+					cellEnd = lineEnd;
+				}
+				const char* nameEnd = cellEnd;
+				trimRange(nameBegin, nameEnd);
+				size_t existing;
+				std::string name(nameBegin, nameEnd);
+				if (name.empty() || store.findAsset(name, existing)) {
+					throw InvalidFormatException("Invalid database header: " + std::string(lineBegin, lineEnd));
+				}
+				store.addAsset(name);
+			}
+			continue;
+		}
+		
+		int day;
+		if (!RateTable::decodeDate(dateBegin, static_cast<size_t>(dateEnd - dateBegin), day)) {
+			throw InvalidFormatException("Invalid date in database: " + std::string(dateBegin, dateEnd));
+		}
+		for (size_t asset = 0; cellEnd < lineEnd; asset++) {
+			const char* rateBegin = cellEnd + 1;
+			cellEnd = static_cast<const char*>(
+				std::memchr(rateBegin, ',', static_cast<size_t>(lineEnd - rateBegin)));
+			if (cellEnd == NULL) {
+				cellEnd = lineEnd;
+			}
+			if (asset >= store.assetCount()) {
+				throw InvalidFormatException("Invalid database format: " + std::string(lineBegin, lineEnd));
+			}
+			const char* rateEnd = cellEnd;
+			trimRange(rateBegin, rateEnd);
+			if (rateBegin == rateEnd) {
+				continue;
+			}
+			double rate;
+			if (!DecimalParser::parse(rateBegin, static_cast<size_t>(rateEnd - rateBegin), rate)) {
+				throw InvalidFormatException("Invalid exchange rate format: " + std::string(rateBegin, rateEnd));
+			}
 			if (rate < 0) {
-				throw InvalidValueException("Negative exchange rate in database: " + rateStr);
+				throw InvalidValueException("Negative exchange rate in database: " + std::string(rateBegin, rateEnd));
 			}
-			_exchangeRates[date] = rate;
-		} catch (const InvalidFormatException& e) {
-			throw InvalidFormatException("Invalid exchange rate format: " + rateStr);
+			store.append(asset, day, rate);
 		}
 	}
-	
-	file.close();
+	if (!headerRead) {
+		throw InvalidFormatException("Invalid database header: missing");
+	}
+}
+
+// The asset's rate on the closest date at or before `date`.
+double BitcoinExchange::getAssetRate(const std::string& asset, const std::string& date) const {
+	size_t id;
+	if (!_assets.findAsset(asset, id)) {
+		throw InvalidValueException("Unknown asset: " + asset);
+	}
+	int day;
+	double rate;
+	if (!RateTable::decodeDate(date.data(), date.size(), day) || !_assets.find(id, day, rate)) {
+		throw InvalidValueException("No " + asset + " rate available for date: " + date);
+	}
+	return rate;
 }
 
 double BitcoinExchange::getExchangeRate(const std::string& date) const {
-	std::map<std::string, double>::const_iterator it = _exchangeRates.find(date);
+	int day;
+	double rate;
+	LiveRateTable::ReadGuard rates(_exchangeRates);
+	if (!RateTable::decodeDate(date.data(), date.size(), day) || !rates.table().find(day, rate)) {
+		throw InvalidValueException("No exchange rate available for date: " + date);
+	}
+	return rate;
+}
+
+// The rate on `date` interpolated linearly between the stored dates
+// around it; a stored date or a date after the last gives that rate.
+double BitcoinExchange::getInterpolatedRate(const std::string& date) const {
+	int day;
+	double rate;
+	LiveRateTable::ReadGuard rates(_exchangeRates);
+	if (!RateTable::decodeDate(date.data(), date.size(), day) || !rates.table().interpolate(day, rate)) {
+		throw InvalidValueException("No exchange rate available for date: " + date);
+	}
+	return rate;
+}
+
+// Average, minimum and maximum of the rates stored for dates from `from`
+// to `to`, both included.
+double BitcoinExchange::getRangeRate(RangeAggregate aggregate,
+	const std::string& from, const std::string& to) const {
+	int first;
+	int last;
+	double rate = 0.0;
+	bool found = false;
+	LiveRateTable::ReadGuard rates(_exchangeRates);
+	if (RateTable::decodeDate(from.data(), from.size(), first)
+		&& RateTable::decodeDate(to.data(), to.size(), last)) {
+		if (aggregate == RANGE_AVERAGE)
+			found = rates.table().rangeAverage(first, last, rate);
+		else if (aggregate == RANGE_MINIMUM)
+			found = rates.table().rangeMinimum(first, last, rate);
+		else
+			found = rates.table().rangeMaximum(first, last, rate);
+	}
+	if (!found) {
+		throw InvalidValueException("No exchange rate available between " + from + " and " + to);
+	}
+	return rate;
+}
+
+double BitcoinExchange::getAverageRate(const std::string& from, const std::string& to) const {
+	return getRangeRate(RANGE_AVERAGE, from, to);
+}
+
+double BitcoinExchange::getMinimumRate(const std::string& from, const std::string& to) const {
+	return getRangeRate(RANGE_MINIMUM, from, to);
+}
+
+double BitcoinExchange::getMaximumRate(const std::string& from, const std::string& to) const {
+	return getRangeRate(RANGE_MAXIMUM, from, to);
+}
+
+// Batch form of getExchangeRate: writes the rate of dates[i] to rates[i]
+// for each of the `count` dates, and throws the same exception for the
+// first date that has none. Dates in (mostly) ascending order are answered
+// in a single walk of the table.
+void BitcoinExchange::getExchangeRates(const std::string* dates, size_t count,
+	double* rates) const {
+	int* days = new int[count == 0 ? 1 : count];
+	size_t valid = 0;
+	while (valid < count &&
+		RateTable::decodeDate(dates[valid].data(), dates[valid].size(), days[valid])) {
+		valid++;
+	}
+	size_t resolved = 0;
+	if (valid > 0) {
+		LiveRateTable::ReadGuard version(_exchangeRates);
+		resolved = version.table().findBatch(days, valid, rates);
+	}
+	delete[] days;
+	if (resolved < count) {
+		throw InvalidValueException("No exchange rate available for date: " + dates[resolved]);
+	}
+}
+
+// Prices one input line (already stripped of its line ending). Shared by
+// the serial and parallel paths so both print the same bytes.
+// Probe is PipelineStats::Timer under --stats and PipelineStats::Disabled
+// otherwise; each line is charged to the stages it reaches and counted
+// once by outcome.
+template <typename Probe>
+void BitcoinExchange::processLine(const LineScanner::Line& line,
+	const RateTable& rates, OutputBuffer& out, Probe& probe) const {
+	const char* begin = line.begin;
+	const char* end = line.end;
+	const char* pipe = line.separator;
+	if (pipe == NULL) {
+		probe.lap(PipelineStats::PARSE);
+		out << "Error: bad input => ";
+		out.write(begin, static_cast<size_t>(end - begin));
+		out << '\n';
+		probe.lap(PipelineStats::FORMAT);
+		probe.count(PipelineStats::BAD_INPUT);
+		return;
+	}
 	
-	if (it != _exchangeRates.end()) {
-		return it->second;
+	const char* dateBegin = begin;
+	const char* dateEnd = pipe;
+	trimRange(dateBegin, dateEnd);
+	const char* valueBegin = pipe + 3;
+	const char* valueEnd = end;
+	trimRange(valueBegin, valueEnd);
+	probe.lap(PipelineStats::PARSE);
+	
+	size_t dateLength = static_cast<size_t>(dateEnd - dateBegin);
+	int day;
+	bool validDate = RateTable::decodeDate(dateBegin, dateLength, day);
+	probe.lap(PipelineStats::VALIDATE);
+	if (!validDate) {
+		out << "Error: bad input => ";
+		out.write(dateBegin, dateLength);
+		out << '\n';
+		probe.lap(PipelineStats::FORMAT);
+		probe.count(PipelineStats::BAD_INPUT);
+		return;
 	}
 	
-	it = _exchangeRates.lower_bound(date);
-	if (it == _exchangeRates.begin()) {
-		throw InvalidValueException("No exchange rate available for date: " + date);
+	double value;
+	bool validValue = DecimalParser::parse(valueBegin, static_cast<size_t>(valueEnd - valueBegin), value);
+	probe.lap(PipelineStats::PARSE);
+	if (!validValue) {
+		out << "Error: bad input => ";
+		out.write(valueBegin, static_cast<size_t>(valueEnd - valueBegin));
+		out << '\n';
+		probe.lap(PipelineStats::FORMAT);
+		probe.count(PipelineStats::BAD_INPUT);
+		return;
 	}
 	
-	--it;
-	return it->second;
+	if (value < 0) {
+		out << "Error: not a positive number." << '\n';
+		probe.lap(PipelineStats::FORMAT);
+		probe.count(PipelineStats::NOT_POSITIVE);
+		return;
+	}
+	if (value > 1000) {
+		out << "Error: too large a number." << '\n';
+		probe.lap(PipelineStats::FORMAT);
+		probe.count(PipelineStats::TOO_LARGE);
+		return;
+	}
+	probe.lap(PipelineStats::VALIDATE);
+	
+	double rate;
+	bool found = rates.find(day, rate);
+	probe.lap(PipelineStats::LOOKUP);
+	if (!found) {
+		out << "Error: No exchange rate available for date: ";
+		out.write(dateBegin, dateLength);
+		out << '\n';
+		probe.lap(PipelineStats::FORMAT);
+		probe.count(PipelineStats::NO_RATE);
+		return;
+	}
+	double result = value * rate;
+	out.write(dateBegin, dateLength);
+	out << " => " << value << " = " << result << '\n';
+	probe.lap(PipelineStats::FORMAT);
+	probe.count(PipelineStats::PRICED);
+}
+
+template <typename Probe>
+void BitcoinExchange::processLines(const char* cursor, const char* end,
+	const RateTable& rates, OutputBuffer& out, Probe& probe) const {
+	LineScanner scanner(cursor, static_cast<size_t>(end - cursor));
+	LineScanner::Line lines[SCAN_BATCH_LINES];
+	size_t count;
+	while ((count = scanner.next(lines, SCAN_BATCH_LINES)) > 0) {
+		probe.lap(PipelineStats::PARSE);
+		for (size_t i = 0; i < count; i++) {
+			if (lines[i].begin != lines[i].end) {
+				processLine(lines[i], rates, out, probe);
+			}
+		}
+	}
 }
 
+struct BitcoinExchange::ChunkTask {
+	const BitcoinExchange* exchange;
+	const RateTable* rates;
+	const char* begin;
+	const char* end;
+	OutputBuffer output;
+	PipelineStats stats;
+	TaskFailure failure;
+};
+
+// An exception thrown by a worker is recorded in its task and thrown
+// again by processMappedInput once the batch has been joined.
+void* BitcoinExchange::runChunkTask(void* argument) {
+	ChunkTask* task = static_cast<ChunkTask*>(argument);
+	try {
+		if (task->exchange->_statsEnabled) {
+			PipelineStats::Timer probe(task->stats);
+			task->exchange->processLines(task->begin, task->end, *task->rates, task->output, probe);
+		} else {
+			PipelineStats::Disabled probe;
+			task->exchange->processLines(task->begin, task->end, *task->rates, task->output, probe);
+		}
+	} catch (const std::exception& error) {
+		task->failure.capture(error);
+	} catch (...) {
+		task->failure.captureUnknown();
+	}
+	return NULL;
+}
+
+void BitcoinExchange::setThreadCount(size_t threads) {
+	if (threads < 1) {
+		threads = 1;
+	}
+	if (threads > MAX_THREADS) {
+		threads = MAX_THREADS;
+	}
+	_threadCount = threads;
+}
+
+// Statistics cover everything loaded and priced while they are enabled;
+// turning them on starts from zero.
+void BitcoinExchange::setStatistics(bool enabled) {
+	if (enabled && !_statsEnabled) {
+		_stats.reset();
+	}
+	_statsEnabled = enabled;
+}
+
+bool BitcoinExchange::statisticsEnabled(void) const {
+	return _statsEnabled;
+}
+
+const PipelineStats& BitcoinExchange::statistics(void) const {
+	return _stats;
+}
+
+// "-" reads standard input. Pipes, FIFOs and terminals are streamed line
+// by line; regular files are mapped and can be split across threads.
 void BitcoinExchange::processInput(const std::string& filename) {
-	std::ifstream file(filename.c_str());
-	if (!file.is_open()) {
-		throw FileException("Could not open input file: " + filename);
+	if (filename == "-") {
+		processStream(STDIN_FILENO);
+		return;
 	}
-	
-	std::string line;
+	struct stat info;
+	if (stat(filename.c_str(), &info) == 0 && !S_ISREG(info.st_mode)) {
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw FileException("Could not open input file: " + filename);
+		}
+		try {
+			processStream(fd);
+		} catch (...) {
+			::close(fd);
+			throw;
+		}
+		::close(fd);
+		return;
+	}
+	processMappedInput(filename);
+}
+
+// Prices lines as they arrive, holding at most STREAM_BUFFER_BYTES of
+// input. Output is flushed whenever the stream has no complete line
+// buffered, so each result appears as soon as its line has been read.
+// Each line is priced against the rates current when it arrives. Returns
+// the number of bytes read; time spent waiting for them is not charged.
+template <typename Probe>
+uint64_t BitcoinExchange::streamLines(int fd, Probe& probe) const {
+	static const char header[] = "date | value";
+	LineRing ring(fd, STREAM_BUFFER_BYTES);
+	OutputBuffer out(std::cout);
+	out.setPrecision(std::numeric_limits<double>::digits10);
 	bool firstLine = true;
 	
-	while (std::getline(file, line)) {
-		if (!line.empty() && line[line.size() - 1] == '\r')
-			line.erase(line.size() - 1);
-		if (firstLine) {
-			firstLine = false;
-			if (line == "date | value") {
-				continue;
-			}
+	for (;;) {
+		const char* begin = NULL;
+		const char* end = NULL;
+		LineRing::Status status = ring.next(begin, end);
+		if (status == LineRing::END) {
+			break;
 		}
-		
-		if (line.empty()) {
+		if (status == LineRing::NEED_DATA) {
+			out.flush();
+			if (!ring.fill()) {
+				throw FileException("Could not read input stream");
+			}
+			probe.restart();
 			continue;
 		}
-		
-		size_t pipePos = line.find(" | ");
-		if (pipePos == std::string::npos) {
-			std::cout << "Error: bad input => " << line << std::endl;
+		bool isFirst = firstLine;
+		firstLine = false;
+		if (status == LineRing::LONG_LINE) {
+			out << "Error: line too long." << '\n';
+			probe.lap(PipelineStats::FORMAT);
+			probe.count(PipelineStats::LINE_TOO_LONG);
 			continue;
 		}
-		
-		std::string date = trim(line.substr(0, pipePos));
-		std::string valueStr = trim(line.substr(pipePos + 3));
-		
-		if (!isValidDate(date)) {
-			std::cout << "Error: bad input => " << date << std::endl;
+		if (isFirst && static_cast<size_t>(end - begin) == sizeof(header) - 1 &&
+			std::memcmp(begin, header, sizeof(header) - 1) == 0) {
 			continue;
 		}
-		
-		double value;
-		try {
-			value = stringToDouble(valueStr);
-		} catch (const InvalidFormatException& e) {
-			std::cout << "Error: bad input => " << valueStr << std::endl;
-			continue;
+		if (begin != end) {
+			LineScanner::Line line;
+			line.begin = begin;
+			line.end = end;
+			line.separator = LineScanner::findSeparator(begin, end);
+			LiveRateTable::ReadGuard rates(_exchangeRates);
+			processLine(line, rates.table(), out, probe);
 		}
-		
-		if (value < 0) {
-			std::cout << "Error: not a positive number." << std::endl;
-			continue;
+	}
+	out.flush();
+	return ring.bytesRead();
+}
+
+void BitcoinExchange::processStream(int fd) {
+	if (!_statsEnabled) {
+		PipelineStats::Disabled probe;
+		streamLines(fd, probe);
+		return;
+	}
+	_stats.startRun();
+	PipelineStats::Timer probe(_stats);
+	_stats.finishRun(streamLines(fd, probe));
+}
+
+// Splits the mapped input into newline-aligned chunks, one per thread,
+// prices each batch of chunks concurrently against the read-only table and
+// writes the per-chunk output in file order before starting the next batch.
+// With one thread the chunks are simply priced in turn.
+void BitcoinExchange::processMappedInput(const std::string& filename) {
+	if (_statsEnabled) {
+		_stats.startRun();
+	}
+	MappedFile file;
+	if (!file.open(filename)) {
+		throw FileException("Could not open input file: " + filename);
+	}
+	
+	static const char header[] = "date | value";
+	const char* cursor = file.data();
+	const char* const end = cursor + file.size();
+	const char* firstEnd = static_cast<const char*>(
+		std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+	const char* next = firstEnd == NULL ? end : firstEnd + 1;
+	if (firstEnd == NULL)
+		firstEnd = end;
+	if (firstEnd != cursor && firstEnd[-1] == '\r')
+		--firstEnd;
+	if (static_cast<size_t>(firstEnd - cursor) == sizeof(header) - 1 &&
+		std::memcmp(cursor, header, sizeof(header) - 1) == 0) {
+		cursor = next;
+	}
+	
+	LiveRateTable::ReadGuard rates(_exchangeRates);
+	OutputBuffer out(std::cout);
+	ChunkTask* tasks = new ChunkTask[_threadCount];
+	pthread_t* threads = NULL;
+	bool* started = NULL;
+	try {
+		threads = new pthread_t[_threadCount];
+		started = new bool[_threadCount];
+		for (size_t i = 0; i < _threadCount; i++) {
+			tasks[i].output.setPrecision(std::numeric_limits<double>::digits10);
+			tasks[i].stats.reset();
 		}
-		if (value > 1000) {
-			std::cout << "Error: too large a number." << std::endl;
-			continue;
+		while (cursor < end) {
+			size_t chunkBytes = static_cast<size_t>(end - cursor) / _threadCount;
+			if (chunkBytes < MIN_CHUNK_BYTES)
+				chunkBytes = MIN_CHUNK_BYTES;
+			if (chunkBytes > MAX_CHUNK_BYTES)
+				chunkBytes = MAX_CHUNK_BYTES;
+			
+			size_t taskCount = 0;
+			while (taskCount < _threadCount && cursor < end) {
+				const char* boundary = end;
+				if (static_cast<size_t>(end - cursor) > chunkBytes) {
+					boundary = static_cast<const char*>(std::memchr(cursor + chunkBytes, '\n',
+						static_cast<size_t>(end - cursor) - chunkBytes));
+					boundary = boundary == NULL ? end : boundary + 1;
+				}
+				ChunkTask& task = tasks[taskCount];
+				task.exchange = this;
+				task.rates = &rates.table();
+				task.begin = cursor;
+				task.end = boundary;
+				task.output.clear();
+				task.failure.clear();
+				cursor = boundary;
+				taskCount++;
+			}
+			
+			for (size_t i = 1; i < taskCount; i++) {
+				started[i] = pthread_create(&threads[i], NULL, runChunkTask, &tasks[i]) == 0;
+			}
+			runChunkTask(&tasks[0]);
+			for (size_t i = 1; i < taskCount; i++) {
+				if (started[i]) {
+					pthread_join(threads[i], NULL);
+				} else {
+					runChunkTask(&tasks[i]);
+				}
+			}
+			
+			for (size_t i = 0; i < taskCount; i++) {
+				tasks[i].failure.rethrow();
+				out.write(tasks[i].output.data(), tasks[i].output.size());
+			}
+			out.flush();
 		}
-		
-		try {
-			double rate = getExchangeRate(date);
-			double result = value * rate;
-			std::cout << std::setprecision(std::numeric_limits<double>::digits10)
-				<< date << " => " << value << " = " << result << std::endl;
-		} catch (const InvalidValueException& e) {
-			std::cout << "Error: " << e.what() << std::endl;
+	} catch (...) {
+		delete[] tasks;
+		delete[] threads;
+		delete[] started;
+		throw;
+	}
+	if (_statsEnabled) {
+		for (size_t i = 0; i < _threadCount; i++) {
+			_stats.merge(tasks[i].stats);
 		}
+		_stats.finishRun(file.size());
 	}
-	
-	file.close();
+	delete[] tasks;
+	delete[] threads;
+	delete[] started;
 }
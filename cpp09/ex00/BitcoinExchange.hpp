@@ -1,19 +1,61 @@
 #ifndef BITCOINEXCHANGE_HPP
 #define BITCOINEXCHANGE_HPP
 
+#include "AssetRateStore.hpp"
+#include "LineScanner.hpp"
+#include "LiveRateTable.hpp"
+#include "PipelineStats.hpp"
+#include "RateTable.hpp"
+
+#include <cstddef>
 #include <exception>
-#include <map>
 #include <string>
 
+class OutputBuffer;
+
 class BitcoinExchange {
 private:
-	std::map<std::string, double> _exchangeRates;
+	// A calendar index costs one double per day; past this many days per
+	// stored rate the binary search is the better trade.
+	static const size_t MAX_DENSE_SLOTS_PER_ENTRY = 16;
+	static const size_t MAX_THREADS = 256;
+	static const size_t MIN_CHUNK_BYTES = 64 * 1024;
+	static const size_t MAX_CHUNK_BYTES = 4 * 1024 * 1024;
+	static const size_t STREAM_BUFFER_BYTES = 64 * 1024;
+	static const size_t SCAN_BATCH_LINES = 256;
+
+	enum RangeAggregate {
+		RANGE_AVERAGE,
+		RANGE_MINIMUM,
+		RANGE_MAXIMUM
+	};
+
+	struct ChunkTask;
+
+	LiveRateTable _exchangeRates;
+	bool _denseIndex;
+	bool _rangeIndex;
+	size_t _threadCount;
+	bool _statsEnabled;
+	PipelineStats _stats;
+	AssetRateStore _assets;
 	
-	bool isValidDate(const std::string& date) const;
-	std::string trim(const std::string& str) const;
-	double stringToDouble(const std::string& str) const;
-	bool isLeapYear(int year) const;
-	bool validateDateFormat(const std::string& date) const;
+	void trimRange(const char*& begin, const char*& end) const;
+	void parseDatabase(const char* cursor, const char* end, RateTable& table) const;
+	void parseAssetDatabase(const char* cursor, const char* end, AssetRateStore& store) const;
+	void finishDraft(RateTable& table) const;
+	template <typename Probe>
+	void processLine(const LineScanner::Line& line,
+		const RateTable& rates, OutputBuffer& out, Probe& probe) const;
+	template <typename Probe>
+	void processLines(const char* cursor, const char* end,
+		const RateTable& rates, OutputBuffer& out, Probe& probe) const;
+	template <typename Probe>
+	uint64_t streamLines(int fd, Probe& probe) const;
+	void processMappedInput(const std::string& filename);
+	double getRangeRate(RangeAggregate aggregate, const std::string& from,
+		const std::string& to) const;
+	static void* runChunkTask(void* argument);
 
 public:
 	BitcoinExchange(void);
@@ -21,9 +63,25 @@ public:
 	BitcoinExchange& operator=(const BitcoinExchange& other);
 	~BitcoinExchange(void);
 	
+	void setDenseIndex(bool enabled);
+	void setRangeIndex(bool enabled);
+	void setThreadCount(size_t threads);
+	void setStatistics(bool enabled);
+	bool statisticsEnabled(void) const;
+	const PipelineStats& statistics(void) const;
 	void loadDatabase(const std::string& filename);
+	void loadDatabase(const std::string& filename, const std::string& snapshotPath);
+	void loadAssetDatabase(const std::string& filename);
+	void updateRate(const std::string& date, double rate);
 	void processInput(const std::string& filename);
+	void processStream(int fd);
 	double getExchangeRate(const std::string& date) const;
+	double getInterpolatedRate(const std::string& date) const;
+	double getAverageRate(const std::string& from, const std::string& to) const;
+	double getMinimumRate(const std::string& from, const std::string& to) const;
+	double getMaximumRate(const std::string& from, const std::string& to) const;
+	double getAssetRate(const std::string& asset, const std::string& date) const;
+	void getExchangeRates(const std::string* dates, size_t count, double* rates) const;
 	
 	class FileException : public std::exception {
 	private:
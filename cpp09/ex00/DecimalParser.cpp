@@ -0,0 +1,365 @@
+#include "DecimalParser.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+
+// Powers of ten up to 10^22 are exact doubles.
+static const int MAX_EXACT_POWER = 22;
+static const double POWERS_OF_TEN[MAX_EXACT_POWER + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Exact double arithmetic rounds once; x87 code that keeps intermediates
+// in wider registers rounds twice, so it always takes the exact path.
+#if defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ != 0
+static const bool SINGLE_ROUNDING = false;
+#else
+static const bool SINGLE_ROUNDING = true;
+#endif
+
+static const int MANTISSA_BITS = 53;
+static const uint64_t MAX_EXACT_INTEGER = static_cast<uint64_t>(1) << MANTISSA_BITS;
+static const uint64_t MIN_NORMAL_MANTISSA = static_cast<uint64_t>(1) << (MANTISSA_BITS - 1);
+// Binary exponents of the last mantissa bit: subnormals and DBL_MAX.
+static const int MIN_BINARY_EXPONENT = -1074;
+static const int MAX_BINARY_EXPONENT = 971;
+// With the value written 0.d1d2... x 10^exponent, exponents below this
+// round to zero and exponents above MAX_DECIMAL_EXPONENT overflow.
+static const long MIN_DECIMAL_EXPONENT = -323;
+static const long MAX_DECIMAL_EXPONENT = 309;
+static const long MAX_EXPONENT_DIGITS_VALUE = 100000000;
+
+// The slow path compares integers of up to about 2600 bits: 768 digits
+// against a 55-bit midpoint times 5^1091.
+static const size_t BIG_LIMBS = 120;
+// Midpoints need 55 bits; with a narrower long double the estimate is
+// only a starting point.
+static const bool WIDE_ESTIMATE = std::numeric_limits<long double>::digits >= 64;
+static const uint32_t POW5_13 = 1220703125u;
+
+struct Decimal {
+	unsigned char digits[DecimalParser::MAX_DIGITS];
+	size_t count;
+	long exponent;
+	bool truncated;
+	bool negative;
+};
+
+struct BigNumber {
+	uint32_t limbs[BIG_LIMBS];
+	size_t size;
+};
+
+DecimalParser::DecimalParser(void) {
+}
+
+DecimalParser::DecimalParser(const DecimalParser& other) {
+	(void)other;
+}
+
+DecimalParser& DecimalParser::operator=(const DecimalParser& other) {
+	(void)other;
+	return *this;
+}
+
+DecimalParser::~DecimalParser(void) {
+}
+
+// The "C" locale's isspace and isdigit, independent of the global locale.
+static bool isSpace(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static void addDigit(Decimal& decimal, size_t& seen, char c) {
+	if (seen < DecimalParser::MAX_DIGITS)
+		decimal.digits[seen] = static_cast<unsigned char>(c - '0');
+	else if (c != '0')
+		decimal.truncated = true;
+	seen++;
+}
+
+// Splits the text into significant digits (leading and trailing zeros
+// dropped) and a decimal exponent, checking the grammar on the way.
+static bool scanDecimal(const char* text, size_t length, Decimal& decimal) {
+	size_t i = 0;
+	while (i < length && isSpace(text[i]))
+		i++;
+	decimal.negative = false;
+	if (i < length && (text[i] == '+' || text[i] == '-')) {
+		decimal.negative = text[i] == '-';
+		i++;
+	}
+	decimal.exponent = 0;
+	decimal.truncated = false;
+	size_t seen = 0;
+	size_t mantissaDigits = 0;
+	for (; i < length && isDigit(text[i]); i++, mantissaDigits++) {
+		if (seen == 0 && text[i] == '0')
+			continue;
+		addDigit(decimal, seen, text[i]);
+		decimal.exponent++;
+	}
+	if (i < length && text[i] == '.') {
+		for (i++; i < length && isDigit(text[i]); i++, mantissaDigits++) {
+			if (seen == 0 && text[i] == '0')
+				decimal.exponent--;
+			else
+				addDigit(decimal, seen, text[i]);
+		}
+	}
+	if (mantissaDigits == 0)
+		return false;
+	if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+		i++;
+		bool negativeExponent = false;
+		if (i < length && (text[i] == '+' || text[i] == '-')) {
+			negativeExponent = text[i] == '-';
+			i++;
+		}
+		size_t exponentDigits = 0;
+		long value = 0;
+		for (; i < length && isDigit(text[i]); i++, exponentDigits++) {
+			if (value < MAX_EXPONENT_DIGITS_VALUE)
+				value = value * 10 + (text[i] - '0');
+		}
+		if (exponentDigits == 0)
+			return false;
+		decimal.exponent += negativeExponent ? -value : value;
+	}
+	if (i != length)
+		return false;
+
+	decimal.count = seen < DecimalParser::MAX_DIGITS ? seen : DecimalParser::MAX_DIGITS;
+	while (decimal.count > 0 && decimal.digits[decimal.count - 1] == 0)
+		decimal.count--;
+	return true;
+}
+
+// Clinger's fast path: at most 2^53 times an exact power of ten is one
+// correctly rounded operation.
+static bool convertExact(const Decimal& decimal, double& magnitude) {
+	if (!SINGLE_ROUNDING || decimal.truncated || decimal.count > 19)
+		return false;
+	uint64_t mantissa = 0;
+	for (size_t i = 0; i < decimal.count; i++)
+		mantissa = mantissa * 10 + decimal.digits[i];
+	long power = decimal.exponent - static_cast<long>(decimal.count);
+	if (mantissa > MAX_EXACT_INTEGER || power < -MAX_EXACT_POWER)
+		return false;
+	while (power > MAX_EXACT_POWER && mantissa <= MAX_EXACT_INTEGER / 10) {
+		mantissa *= 10;
+		power--;
+	}
+	if (power > MAX_EXACT_POWER)
+		return false;
+	double value = static_cast<double>(mantissa);
+	magnitude = power < 0 ? value / POWERS_OF_TEN[-power] : value * POWERS_OF_TEN[power];
+	return true;
+}
+
+static void multiplySmall(BigNumber& number, uint32_t factor, uint32_t addend) {
+	uint64_t carry = addend;
+	for (size_t i = 0; i < number.size; i++) {
+		uint64_t product = static_cast<uint64_t>(number.limbs[i]) * factor + carry;
+		number.limbs[i] = static_cast<uint32_t>(product);
+		carry = product >> 32;
+	}
+	if (carry != 0)
+		number.limbs[number.size++] = static_cast<uint32_t>(carry);
+}
+
+static void multiplyPow5(BigNumber& number, long power) {
+	for (; power >= 13; power -= 13)
+		multiplySmall(number, POW5_13, 0);
+	uint32_t factor = 1;
+	for (; power > 0; power--)
+		factor *= 5;
+	if (factor != 1)
+		multiplySmall(number, factor, 0);
+}
+
+static void shiftLeft(BigNumber& number, long bits) {
+	if (number.size == 0)
+		return;
+	size_t limbs = static_cast<size_t>(bits / 32);
+	unsigned int shift = static_cast<unsigned int>(bits % 32);
+	if (shift != 0) {
+		uint32_t carry = 0;
+		for (size_t i = 0; i < number.size; i++) {
+			uint32_t limb = number.limbs[i];
+			number.limbs[i] = limb << shift | carry;
+			carry = limb >> (32 - shift);
+		}
+		if (carry != 0)
+			number.limbs[number.size++] = carry;
+	}
+	if (limbs != 0) {
+		for (size_t i = number.size; i-- > 0;)
+			number.limbs[i + limbs] = number.limbs[i];
+		for (size_t i = 0; i < limbs; i++)
+			number.limbs[i] = 0;
+		number.size += limbs;
+	}
+}
+
+static int compare(const BigNumber& left, const BigNumber& right) {
+	if (left.size != right.size)
+		return left.size < right.size ? -1 : 1;
+	for (size_t i = left.size; i-- > 0;) {
+		if (left.limbs[i] != right.limbs[i])
+			return left.limbs[i] < right.limbs[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+static void setDigits(BigNumber& number, const Decimal& decimal) {
+	static const uint32_t CHUNK_POWERS[10] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+	};
+	number.size = 0;
+	for (size_t i = 0; i < decimal.count; i += 9) {
+		size_t end = i + 9 < decimal.count ? i + 9 : decimal.count;
+		uint32_t chunk = 0;
+		for (size_t j = i; j < end; j++)
+			chunk = chunk * 10 + decimal.digits[j];
+		if (number.size == 0 && chunk != 0) {
+			number.limbs[0] = chunk;
+			number.size = 1;
+		} else if (number.size != 0) {
+			multiplySmall(number, CHUNK_POWERS[end - i], chunk);
+		}
+	}
+}
+
+static void setInteger(BigNumber& number, uint64_t value) {
+	number.size = 0;
+	while (value != 0) {
+		number.limbs[number.size++] = static_cast<uint32_t>(value);
+		value >>= 32;
+	}
+}
+
+// Compares digits x 10^power (digits already scaled by 5^power when power
+// is positive) with midpoint x 2^binary. Dropped nonzero digits make the
+// decimal value larger than any midpoint it would otherwise equal.
+static int compareMidpoint(const BigNumber& scaledDigits, long power, bool truncated,
+	uint64_t midpoint, int binary) {
+	BigNumber left = scaledDigits;
+	BigNumber right;
+	setInteger(right, midpoint);
+	if (power < 0)
+		multiplyPow5(right, -power);
+	long shift = power - binary;
+	if (shift > 0)
+		shiftLeft(left, shift);
+	else if (shift < 0)
+		shiftLeft(right, -shift);
+	int order = compare(left, right);
+	return order == 0 && truncated ? 1 : order;
+}
+
+// Estimates the value in long double from its first 19 digits. When the
+// estimate's error bound keeps it clear of the midpoints around its
+// nearest double, that double is the answer. Otherwise the double is moved
+// one step at a time until the decimal value lies between the midpoints
+// to its neighbours, deciding each comparison on exact integers.
+static bool convertSlow(const Decimal& decimal, double& magnitude) {
+	size_t leading = decimal.count < 19 ? decimal.count : 19;
+	uint64_t head = 0;
+	for (size_t i = 0; i < leading; i++)
+		head = head * 10 + decimal.digits[i];
+	long double estimate = static_cast<long double>(head);
+	long scale = decimal.exponent - static_cast<long>(leading);
+	int roundings = 1;
+	for (; scale > MAX_EXACT_POWER; scale -= MAX_EXACT_POWER, roundings++)
+		estimate *= POWERS_OF_TEN[MAX_EXACT_POWER];
+	for (; scale < -MAX_EXACT_POWER; scale += MAX_EXACT_POWER, roundings++)
+		estimate /= POWERS_OF_TEN[MAX_EXACT_POWER];
+	estimate = scale < 0 ? estimate / POWERS_OF_TEN[-scale] : estimate * POWERS_OF_TEN[scale];
+	bool clamped = estimate > std::numeric_limits<double>::max();
+	double nearest = clamped ? std::numeric_limits<double>::max() : static_cast<double>(estimate);
+
+	uint64_t mantissa = 0;
+	int binary = MIN_BINARY_EXPONENT;
+	if (nearest > 0.0) {
+		int exponent;
+		std::frexp(nearest, &exponent);
+		binary = exponent - MANTISSA_BITS;
+		if (binary < MIN_BINARY_EXPONENT)
+			binary = MIN_BINARY_EXPONENT;
+		mantissa = static_cast<uint64_t>(std::ldexp(nearest, -binary));
+	}
+
+	if (WIDE_ESTIMATE && !clamped && mantissa != 0) {
+		long double error = estimate * std::ldexp(static_cast<long double>(roundings + 1),
+			-std::numeric_limits<long double>::digits);
+		if (decimal.count > leading)
+			error += estimate * std::ldexp(1.0L, -59);
+		long double above = std::ldexp(static_cast<long double>(2 * mantissa + 1), binary - 1);
+		long double below = mantissa == MIN_NORMAL_MANTISSA && binary > MIN_BINARY_EXPONENT
+			? std::ldexp(static_cast<long double>(4 * mantissa - 1), binary - 2)
+			: std::ldexp(static_cast<long double>(2 * mantissa - 1), binary - 1);
+		if (above - estimate > error && estimate - below > error) {
+			magnitude = nearest;
+			return true;
+		}
+	}
+
+	long power = decimal.exponent - static_cast<long>(decimal.count);
+	BigNumber scaledDigits;
+	setDigits(scaledDigits, decimal);
+	if (power > 0)
+		multiplyPow5(scaledDigits, power);
+
+	for (;;) {
+		int above = compareMidpoint(scaledDigits, power, decimal.truncated,
+			2 * mantissa + 1, binary - 1);
+		if (above > 0 || (above == 0 && (mantissa & 1) != 0)) {
+			if (++mantissa == MAX_EXACT_INTEGER) {
+				mantissa = MIN_NORMAL_MANTISSA;
+				if (++binary > MAX_BINARY_EXPONENT)
+					return false;
+			}
+			continue;
+		}
+		if (mantissa == 0)
+			break;
+		bool binadeStart = mantissa == MIN_NORMAL_MANTISSA && binary > MIN_BINARY_EXPONENT;
+		int below = binadeStart
+			? compareMidpoint(scaledDigits, power, decimal.truncated, 4 * mantissa - 1, binary - 2)
+			: compareMidpoint(scaledDigits, power, decimal.truncated, 2 * mantissa - 1, binary - 1);
+		if (below < 0 || (below == 0 && (mantissa & 1) != 0)) {
+			if (binadeStart) {
+				mantissa = MAX_EXACT_INTEGER - 1;
+				binary--;
+			} else {
+				mantissa--;
+			}
+			continue;
+		}
+		break;
+	}
+	magnitude = std::ldexp(static_cast<double>(mantissa), binary);
+	return true;
+}
+
+bool DecimalParser::parse(const char* text, size_t length, double& value) {
+	Decimal decimal;
+	if (!scanDecimal(text, length, decimal))
+		return false;
+	double magnitude = 0.0;
+	if (decimal.count != 0 && decimal.exponent >= MIN_DECIMAL_EXPONENT) {
+		if (decimal.exponent > MAX_DECIMAL_EXPONENT)
+			return false;
+		if (!convertExact(decimal, magnitude) && !convertSlow(decimal, magnitude))
+			return false;
+	}
+	value = decimal.negative ? -magnitude : magnitude;
+	return true;
+}
@@ -0,0 +1,28 @@
+#ifndef DECIMALPARSER_HPP
+#define DECIMALPARSER_HPP
+
+#include <cstddef>
+
+// Decimal text to the nearest double (ties to even): the value strtod
+// returns in the "C" locale, whatever the global locale is, read straight
+// from a pointer and length without copying or allocating. The accepted
+// form is [space] [+-] digits [. digits] [e [+-] digits] with at least
+// one mantissa digit and nothing after it; values that round to infinity
+// are rejected.
+class DecimalParser {
+public:
+	// Digits past this many only matter through whether any is nonzero:
+	// no halfway point between two doubles has more significant digits.
+	static const size_t MAX_DIGITS = 768;
+
+private:
+	DecimalParser(void);
+	DecimalParser(const DecimalParser& other);
+	DecimalParser& operator=(const DecimalParser& other);
+	~DecimalParser(void);
+
+public:
+	static bool parse(const char* text, size_t length, double& value);
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "LineRing.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+LineRing::LineRing(int fd, size_t capacity)
+	: _fd(fd), _ring(NULL), _scratch(NULL), _capacity(capacity == 0 ? 1 : capacity),
+	  _head(0), _count(0), _scanned(0), _bytesRead(0), _eof(false), _discarding(false) {
+	_ring = new char[_capacity];
+	try {
+		_scratch = new char[_capacity];
+	} catch (...) {
+		delete[] _ring;
+		throw;
+	}
+}
+
+LineRing::~LineRing(void) {
+	delete[] _ring;
+	delete[] _scratch;
+}
+
+char LineRing::at(size_t offset) const {
+	size_t index = _head + offset;
+	return _ring[index < _capacity ? index : index - _capacity];
+}
+
+void LineRing::consume(size_t bytes) {
+	_head += bytes;
+	if (_head >= _capacity)
+		_head -= _capacity;
+	_count -= bytes;
+	_scanned = 0;
+	if (_count == 0)
+		_head = 0;
+}
+
+// Reads once into the free space after the buffered bytes. Returns false
+// on a read error; end of stream is recorded and later reported by next().
+bool LineRing::fill(void) {
+	if (_eof)
+		return true;
+	size_t tail = _head + _count;
+	if (tail >= _capacity)
+		tail -= _capacity;
+	size_t room = tail >= _head ? _capacity - tail : _head - tail;
+	if (_count == _capacity)
+		room = 0;
+	ssize_t bytes;
+	do {
+		bytes = read(_fd, _ring + tail, room);
+	} while (bytes < 0 && errno == EINTR);
+	if (bytes < 0)
+		return false;
+	if (bytes == 0 && room > 0)
+		_eof = true;
+	_count += static_cast<size_t>(bytes);
+	_bytesRead += static_cast<uint64_t>(bytes);
+	return true;
+}
+
+uint64_t LineRing::bytesRead(void) const {
+	return _bytesRead;
+}
+
+// Hands out the next complete line without its line ending; the range
+// stays valid until the next call to next() or fill(). NEED_DATA asks the
+// caller to fill(). A final line without a newline is returned once the
+// stream has ended.
+LineRing::Status LineRing::next(const char*& begin, const char*& end) {
+	for (;;) {
+		while (_scanned < _count && at(_scanned) != '\n')
+			_scanned++;
+
+		if (_scanned == _count) {
+			if (_discarding) {
+				consume(_count);
+				if (_eof)
+					return END;
+				return NEED_DATA;
+			}
+			if (_count == _capacity) {
+				consume(_count);
+				_discarding = true;
+				return LONG_LINE;
+			}
+			if (!_eof)
+				return NEED_DATA;
+			if (_count == 0)
+				return END;
+		}
+
+		size_t length = _scanned;
+		size_t taken = _scanned < _count ? length + 1 : length;
+		if (_discarding) {
+			_discarding = false;
+			consume(taken);
+			continue;
+		}
+		if (_head + length <= _capacity) {
+			begin = _ring + _head;
+		} else {
+			size_t first = _capacity - _head;
+			std::memcpy(_scratch, _ring + _head, first);
+			std::memcpy(_scratch + first, _ring, length - first);
+			begin = _scratch;
+		}
+		end = begin + length;
+		if (end != begin && end[-1] == '\r')
+			--end;
+		consume(taken);
+		return LINE;
+	}
+}
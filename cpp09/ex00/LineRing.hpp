@@ -0,0 +1,48 @@
+#ifndef LINERING_HPP
+#define LINERING_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+// Splits a byte stream (a pipe, FIFO or terminal) into lines through one
+// fixed-size ring buffer, so memory stays constant however long the
+// stream runs. Lines that wrap around the end of the ring are copied into
+// a scratch buffer of the same size; lines that do not fit at all are
+// reported once and skipped.
+class LineRing {
+public:
+	enum Status {
+		LINE,
+		LONG_LINE,
+		NEED_DATA,
+		END
+	};
+
+private:
+	int _fd;
+	char* _ring;
+	char* _scratch;
+	size_t _capacity;
+	size_t _head;
+	size_t _count;
+	size_t _scanned;
+	uint64_t _bytesRead;
+	bool _eof;
+	bool _discarding;
+
+	LineRing(const LineRing& other);
+	LineRing& operator=(const LineRing& other);
+
+	char at(size_t offset) const;
+	void consume(size_t bytes);
+
+public:
+	LineRing(int fd, size_t capacity);
+	~LineRing(void);
+
+	bool fill(void);
+	Status next(const char*& begin, const char*& end);
+	uint64_t bytesRead(void) const;
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "LineScanner.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define LINESCANNER_X86 1
+# include <immintrin.h>
+#endif
+
+static const size_t BLOCK_BYTES = 64;
+
+// Portable kernel: eight bytes per step, SWAR style. Matching bytes get
+// their high bit set exactly (no borrow between lanes), and the multiply
+// gathers the eight high bits into one byte.
+static const uint64_t BYTE_ONES = ~static_cast<uint64_t>(0) / 255;
+static const uint64_t BYTE_LOW7 = BYTE_ONES * 0x7F;
+static const uint64_t GATHER_HIGH_BITS = (static_cast<uint64_t>(0x01020408) << 32) | 0x10204080;
+
+static uint64_t matchWord(uint64_t word, uint64_t pattern) {
+	uint64_t diff = word ^ pattern;
+	uint64_t zero = ~(((diff & BYTE_LOW7) + BYTE_LOW7) | diff | BYTE_LOW7);
+	return ((zero >> 7) * GATHER_HIGH_BITS) >> 56;
+}
+
+static void maskScalar(const char* block, uint64_t& newlines, uint64_t& pipes, uint64_t& spaces) {
+	uint64_t newlineBits = 0;
+	uint64_t pipeBits = 0;
+	uint64_t spaceBits = 0;
+	for (size_t i = 0; i < BLOCK_BYTES; i += 8) {
+		uint64_t word = 0;
+		for (size_t j = 8; j-- > 0; )
+			word = (word << 8) | static_cast<unsigned char>(block[i + j]);
+		newlineBits |= matchWord(word, BYTE_ONES * '\n') << i;
+		pipeBits |= matchWord(word, BYTE_ONES * '|') << i;
+		spaceBits |= matchWord(word, BYTE_ONES * ' ') << i;
+	}
+	newlines = newlineBits;
+	pipes = pipeBits;
+	spaces = spaceBits;
+}
+
+#ifdef LINESCANNER_X86
+__attribute__((target("sse2")))
+static uint64_t matchSse2(const __m128i* bytes, char character) {
+	const __m128i pattern = _mm_set1_epi8(character);
+	uint64_t bits = 0;
+	for (int i = 0; i < 4; i++) {
+		bits |= static_cast<uint64_t>(static_cast<uint32_t>(
+			_mm_movemask_epi8(_mm_cmpeq_epi8(bytes[i], pattern)))) << (16 * i);
+	}
+	return bits;
+}
+
+__attribute__((target("sse2")))
+static void maskSse2(const char* block, uint64_t& newlines, uint64_t& pipes, uint64_t& spaces) {
+	__m128i bytes[4];
+	for (int i = 0; i < 4; i++)
+		bytes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+	newlines = matchSse2(bytes, '\n');
+	pipes = matchSse2(bytes, '|');
+	spaces = matchSse2(bytes, ' ');
+}
+
+__attribute__((target("avx2")))
+static uint64_t matchAvx2(__m256i low, __m256i high, char character) {
+	const __m256i pattern = _mm256_set1_epi8(character);
+	return static_cast<uint64_t>(static_cast<uint32_t>(
+			_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, pattern))))
+		| static_cast<uint64_t>(static_cast<uint32_t>(
+			_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, pattern)))) << 32;
+}
+
+__attribute__((target("avx2")))
+static void maskAvx2(const char* block, uint64_t& newlines, uint64_t& pipes, uint64_t& spaces) {
+	__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+	__m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+	newlines = matchAvx2(low, high, '\n');
+	pipes = matchAvx2(low, high, '|');
+	spaces = matchAvx2(low, high, ' ');
+	// Unoptimized builds do not emit vzeroupper themselves; a dirty upper
+	// half slows down every SSE instruction that runs afterwards.
+	_mm256_zeroupper();
+}
+#endif
+
+static unsigned int lowestBit(uint64_t bits) {
+#ifdef __GNUC__
+	return static_cast<unsigned int>(__builtin_ctzll(bits));
+#else
+	unsigned int index = 0;
+	while ((bits & 1) == 0) {
+		bits >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+static LineScanner::Kernel bestKernel(void) {
+	if (LineScanner::supports(LineScanner::AVX2))
+		return LineScanner::AVX2;
+	if (LineScanner::supports(LineScanner::SSE2))
+		return LineScanner::SSE2;
+	return LineScanner::SCALAR;
+}
+
+// Chosen during static initialization, before any worker thread exists.
+static const LineScanner::Kernel BEST_KERNEL = bestKernel();
+
+LineScanner::LineScanner(const char* data, size_t length, Kernel kernel)
+	: _cursor(data), _block(data), _end(data + length), _lineBegin(data),
+	  _separator(NULL), _newlines(0), _separators(0), _previousSpace(false),
+	  _mask(maskScalar) {
+	if (kernel == AUTO || !supports(kernel))
+		kernel = kernel == AUTO ? BEST_KERNEL : SCALAR;
+#ifdef LINESCANNER_X86
+	if (kernel == AVX2)
+		_mask = maskAvx2;
+	else if (kernel == SSE2)
+		_mask = maskSse2;
+#endif
+}
+
+LineScanner::~LineScanner(void) {
+}
+
+bool LineScanner::supports(Kernel kernel) {
+	if (kernel == AUTO || kernel == SCALAR)
+		return true;
+#ifdef LINESCANNER_X86
+	__builtin_cpu_init();
+	if (kernel == SSE2)
+		return __builtin_cpu_supports("sse2");
+	if (kernel == AVX2)
+		return __builtin_cpu_supports("avx2");
+#endif
+	return false;
+}
+
+// Classifies the next 64 bytes; a short tail is copied into a zero-padded
+// block first so every kernel reads whole blocks. A separator is a '|'
+// with a space on each side, so the space mask is compared shifted both
+// ways, carrying one byte over from the neighbouring blocks.
+bool LineScanner::loadBlock(void) {
+	if (_cursor >= _end)
+		return false;
+	size_t remaining = static_cast<size_t>(_end - _cursor);
+	uint64_t pipes;
+	uint64_t spaces;
+	bool nextSpace = false;
+	_block = _cursor;
+	if (remaining >= BLOCK_BYTES) {
+		_mask(_cursor, _newlines, pipes, spaces);
+		_cursor += BLOCK_BYTES;
+		nextSpace = _cursor < _end && *_cursor == ' ';
+	} else {
+		char padded[BLOCK_BYTES];
+		std::memset(padded, 0, sizeof(padded));
+		std::memcpy(padded, _cursor, remaining);
+		_mask(padded, _newlines, pipes, spaces);
+		_cursor = _end;
+	}
+	uint64_t spaceBefore = (spaces << 1) | (_previousSpace ? 1 : 0);
+	uint64_t spaceAfter = (spaces >> 1) | (static_cast<uint64_t>(nextSpace) << 63);
+	_separators = pipes & spaceBefore & spaceAfter;
+	_previousSpace = (spaces >> 63) != 0;
+	return true;
+}
+
+// Fills up to `capacity` lines and returns how many; 0 once the input is
+// exhausted. A last line without a newline is included. The scan state
+// lives in locals here since stores into `lines` could alias the members.
+size_t LineScanner::next(Line* lines, size_t capacity) {
+	const char* block = _block;
+	const char* lineBegin = _lineBegin;
+	const char* separator = _separator;
+	uint64_t newlines = _newlines;
+	uint64_t separators = _separators;
+	size_t count = 0;
+	while (count < capacity) {
+		const char* lineEnd;
+		const char* nextLine;
+		if (newlines != 0) {
+			uint64_t before = (newlines & (~newlines + 1)) - 1;
+			uint64_t inLine = separators & before;
+			if (separator == NULL && inLine != 0)
+				separator = block + lowestBit(inLine) - 1;
+			separators &= ~before;
+			lineEnd = block + lowestBit(newlines);
+			nextLine = lineEnd + 1;
+			newlines &= newlines - 1;
+		} else {
+			if (separator == NULL && separators != 0)
+				separator = block + lowestBit(separators) - 1;
+			if (loadBlock()) {
+				block = _block;
+				newlines = _newlines;
+				separators = _separators;
+				continue;
+			}
+			separators = 0;
+			if (lineBegin >= _end)
+				break;
+			lineEnd = _end;
+			nextLine = _end;
+		}
+		if (lineEnd != lineBegin && lineEnd[-1] == '\r')
+			--lineEnd;
+		lines[count].begin = lineBegin;
+		lines[count].end = lineEnd;
+		lines[count].separator = separator;
+		count++;
+		lineBegin = nextLine;
+		separator = NULL;
+	}
+	_block = block;
+	_lineBegin = lineBegin;
+	_separator = separator;
+	_newlines = newlines;
+	_separators = separators;
+	return count;
+}
+
+// The same search for a single line, for input that is not scanned in
+// blocks.
+const char* LineScanner::findSeparator(const char* begin, const char* end) {
+	for (const char* bar = static_cast<const char*>(std::memchr(begin, '|', static_cast<size_t>(end - begin)));
+		bar != NULL;
+		bar = static_cast<const char*>(std::memchr(bar + 1, '|', static_cast<size_t>(end - bar - 1)))) {
+		if (bar > begin && bar[-1] == ' ' && bar + 1 < end && bar[1] == ' ') {
+			return bar - 1;
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,58 @@
+#ifndef LINESCANNER_HPP
+#define LINESCANNER_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+// Splits an in-memory input file into lines and locates each line's
+// " | " separator. Bytes are classified 64 at a time into newline, '|' and
+// space bitmasks (AVX2 or SSE2 when the CPU has them, plain C++
+// otherwise); shifting and masking those gives every " | " in the block,
+// and each line then costs a few bit operations.
+class LineScanner {
+public:
+	enum Kernel {
+		AUTO,
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	// One line without its "\n" or "\r\n". `separator` points at the space
+	// before the first '|' that has a space on both sides, or is NULL.
+	struct Line {
+		const char* begin;
+		const char* end;
+		const char* separator;
+	};
+
+	typedef void (*MaskFunction)(const char* block, uint64_t& newlines,
+		uint64_t& pipes, uint64_t& spaces);
+
+private:
+	const char* _cursor;
+	const char* _block;
+	const char* _end;
+	const char* _lineBegin;
+	const char* _separator;
+	uint64_t _newlines;
+	uint64_t _separators;
+	bool _previousSpace;
+	MaskFunction _mask;
+
+	LineScanner(const LineScanner& other);
+	LineScanner& operator=(const LineScanner& other);
+
+	bool loadBlock(void);
+
+public:
+	LineScanner(const char* data, size_t length, Kernel kernel = AUTO);
+	~LineScanner(void);
+
+	size_t next(Line* lines, size_t capacity);
+
+	static bool supports(Kernel kernel);
+	static const char* findSeparator(const char* begin, const char* end);
+};
+
+#endif
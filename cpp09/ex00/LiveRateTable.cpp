@@ -0,0 +1,163 @@
+#include "LiveRateTable.hpp"
+
+// Shared fields are only touched through __sync builtins, which are full
+// barriers (a fetch-and-add of 0 is an atomic load): a reader's counter
+// increment is visible before it loads _current, and a published table is
+// complete before the pointer to it is.
+
+LiveRateTable::LiveRateTable(void)
+	: _current(new RateTable()), _epoch(0), _retired(NULL), _retiredCount(0),
+	  _retiredCapacity(0), _draining(NULL), _drainingCount(0),
+	  _drainingCapacity(0), _drainPhase(0) {
+	_readers[0] = 0;
+	_readers[1] = 0;
+	pthread_mutex_init(&_writeLock, NULL);
+}
+
+LiveRateTable::LiveRateTable(const LiveRateTable& other)
+	: _current(NULL), _epoch(0), _retired(NULL), _retiredCount(0),
+	  _retiredCapacity(0), _draining(NULL), _drainingCount(0),
+	  _drainingCapacity(0), _drainPhase(0) {
+	_readers[0] = 0;
+	_readers[1] = 0;
+	ReadGuard guard(other);
+	_current = new RateTable(guard.table());
+	pthread_mutex_init(&_writeLock, NULL);
+}
+
+LiveRateTable& LiveRateTable::operator=(const LiveRateTable& other) {
+	if (this != &other) {
+		RateTable* copy;
+		{
+			ReadGuard guard(other);
+			copy = new RateTable(guard.table());
+		}
+		pthread_mutex_lock(&_writeLock);
+		publish(copy);
+		pthread_mutex_unlock(&_writeLock);
+	}
+	return *this;
+}
+
+// No reader can outlive the table itself, so every version goes at once.
+LiveRateTable::~LiveRateTable(void) {
+	delete _current;
+	for (size_t i = 0; i < _retiredCount; i++)
+		delete _retired[i];
+	for (size_t i = 0; i < _drainingCount; i++)
+		delete _draining[i];
+	delete[] _retired;
+	delete[] _draining;
+	pthread_mutex_destroy(&_writeLock);
+}
+
+// Queues a replaced version for reclaim(), doubling the array when full.
+void LiveRateTable::retire(RateTable* table) {
+	if (_retiredCount == _retiredCapacity) {
+		size_t capacity = _retiredCapacity < 4 ? 4 : _retiredCapacity * 2;
+		RateTable** retired = new RateTable*[capacity];
+		for (size_t i = 0; i < _retiredCount; i++)
+			retired[i] = _retired[i];
+		delete[] _retired;
+		_retired = retired;
+		_retiredCapacity = capacity;
+	}
+	_retired[_retiredCount++] = table;
+}
+
+// Called with _writeLock held. Takes ownership of `table`.
+void LiveRateTable::publish(RateTable* table) {
+	RateTable* previous = __sync_fetch_and_add(&_current, 0);
+	try {
+		retire(previous);
+	} catch (...) {
+		delete table;
+		throw;
+	}
+	__sync_bool_compare_and_swap(&_current, previous, table);
+	reclaim();
+}
+
+// Advances the grace period as far as it can without waiting. A batch of
+// retired versions starts draining with an epoch flip: new readers count
+// in the other counter, so the old one only falls. Once it reaches zero
+// the epoch flips back and the second counter drains the same way; a
+// reader that read the epoch just before a flip but counted itself after
+// it is then covered too, and the batch is freed.
+void LiveRateTable::reclaim(void) {
+	for (;;) {
+		if (_drainPhase == 0) {
+			if (_retiredCount == 0)
+				return;
+			RateTable** batch = _draining;
+			size_t batchCapacity = _drainingCapacity;
+			_draining = _retired;
+			_drainingCount = _retiredCount;
+			_drainingCapacity = _retiredCapacity;
+			_retired = batch;
+			_retiredCount = 0;
+			_retiredCapacity = batchCapacity;
+			__sync_fetch_and_add(&_epoch, 1);
+			_drainPhase = 1;
+			continue;
+		}
+		unsigned int slot = (__sync_fetch_and_add(&_epoch, 0) - 1) & 1;
+		if (__sync_fetch_and_add(&_readers[slot], 0) != 0)
+			return;
+		if (_drainPhase == 1) {
+			__sync_fetch_and_add(&_epoch, 1);
+			_drainPhase = 2;
+			continue;
+		}
+		for (size_t i = 0; i < _drainingCount; i++)
+			delete _draining[i];
+		_drainingCount = 0;
+		_drainPhase = 0;
+	}
+}
+
+LiveRateTable::ReadGuard::ReadGuard(const LiveRateTable& owner)
+	: _owner(owner), _slot(__sync_fetch_and_add(&owner._epoch, 0) & 1), _table(NULL) {
+	__sync_fetch_and_add(&owner._readers[_slot], 1);
+	_table = __sync_fetch_and_add(&owner._current, 0);
+}
+
+LiveRateTable::ReadGuard::~ReadGuard(void) {
+	__sync_fetch_and_sub(&_owner._readers[_slot], 1);
+}
+
+const RateTable& LiveRateTable::ReadGuard::table(void) const {
+	return *_table;
+}
+
+LiveRateTable::WriteGuard::WriteGuard(LiveRateTable& owner)
+	: _owner(owner), _draft(NULL) {
+	pthread_mutex_lock(&owner._writeLock);
+	try {
+		_draft = new RateTable(*__sync_fetch_and_add(&owner._current, 0));
+	} catch (...) {
+		pthread_mutex_unlock(&owner._writeLock);
+		throw;
+	}
+}
+
+// An uncommitted draft is simply dropped; the published version is
+// untouched.
+LiveRateTable::WriteGuard::~WriteGuard(void) {
+	delete _draft;
+	pthread_mutex_unlock(&_owner._writeLock);
+}
+
+RateTable& LiveRateTable::WriteGuard::draft(void) {
+	return *_draft;
+}
+
+// Publishes the draft. The guard keeps the write lock until it goes out
+// of scope but has no draft left to edit.
+void LiveRateTable::WriteGuard::commit(void) {
+	if (_draft == NULL)
+		return;
+	RateTable* table = _draft;
+	_draft = NULL;
+	_owner.publish(table);
+}
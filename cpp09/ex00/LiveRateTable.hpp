@@ -0,0 +1,74 @@
+#ifndef LIVERATETABLE_HPP
+#define LIVERATETABLE_HPP
+
+#include "RateTable.hpp"
+
+#include <cstddef>
+#include <pthread.h>
+
+// A RateTable that can be replaced while other threads read it. Readers
+// pin the current immutable version with a ReadGuard: two atomic counter
+// updates, never a lock. Writers serialize on a mutex, edit a private copy
+// in a WriteGuard and publish it with one pointer store. A replaced
+// version is freed only after every reader that could still see it has
+// left, tracked by two reader counters and an epoch that flips between
+// them; writers check that without waiting, so nothing ever blocks on a
+// reader.
+class LiveRateTable {
+private:
+	mutable RateTable* volatile _current;
+	mutable volatile long _readers[2];
+	mutable volatile unsigned int _epoch;
+	pthread_mutex_t _writeLock;
+	RateTable** _retired;
+	size_t _retiredCount;
+	size_t _retiredCapacity;
+	RateTable** _draining;
+	size_t _drainingCount;
+	size_t _drainingCapacity;
+	int _drainPhase;
+
+	void retire(RateTable* table);
+	void publish(RateTable* table);
+	void reclaim(void);
+
+public:
+	class ReadGuard {
+	private:
+		const LiveRateTable& _owner;
+		unsigned int _slot;
+		const RateTable* _table;
+
+		ReadGuard(const ReadGuard& other);
+		ReadGuard& operator=(const ReadGuard& other);
+
+	public:
+		explicit ReadGuard(const LiveRateTable& owner);
+		~ReadGuard(void);
+
+		const RateTable& table(void) const;
+	};
+
+	class WriteGuard {
+	private:
+		LiveRateTable& _owner;
+		RateTable* _draft;
+
+		WriteGuard(const WriteGuard& other);
+		WriteGuard& operator=(const WriteGuard& other);
+
+	public:
+		explicit WriteGuard(LiveRateTable& owner);
+		~WriteGuard(void);
+
+		RateTable& draft(void);
+		void commit(void);
+	};
+
+	LiveRateTable(void);
+	LiveRateTable(const LiveRateTable& other);
+	LiveRateTable& operator=(const LiveRateTable& other);
+	~LiveRateTable(void);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "MappedFile.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(void) : _data(NULL), _size(0), _mapped(false) {
+}
+
+MappedFile::~MappedFile(void) {
+	close();
+}
+
+void MappedFile::readAll(int fd) {
+	char chunk[65536];
+	while (true) {
+		ssize_t count = ::read(fd, chunk, sizeof(chunk));
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			break;
+		_buffer.append(chunk, static_cast<size_t>(count));
+	}
+	_data = _buffer.data();
+	_size = _buffer.size();
+}
+
+bool MappedFile::open(const std::string& filename) {
+	close();
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+		size_t length = static_cast<size_t>(info.st_size);
+		void* address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address != MAP_FAILED) {
+			madvise(address, length, MADV_SEQUENTIAL);
+			_data = static_cast<const char*>(address);
+			_size = length;
+			_mapped = true;
+			::close(fd);
+			return true;
+		}
+	}
+	readAll(fd);
+	::close(fd);
+	return true;
+}
+
+void MappedFile::close(void) {
+	if (_mapped)
+		munmap(const_cast<char*>(_data), _size);
+	_buffer.clear();
+	_data = NULL;
+	_size = 0;
+	_mapped = false;
+}
+
+const char* MappedFile::data(void) const {
+	return _data;
+}
+
+size_t MappedFile::size(void) const {
+	return _size;
+}
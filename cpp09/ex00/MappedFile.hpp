@@ -0,0 +1,31 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file. Regular files are mmapped; pipes and
+// other non-seekable inputs are read into an owned buffer instead.
+class MappedFile {
+private:
+	const char* _data;
+	size_t _size;
+	bool _mapped;
+	std::string _buffer;
+
+	MappedFile(const MappedFile& other);
+	MappedFile& operator=(const MappedFile& other);
+
+	void readAll(int fd);
+
+public:
+	MappedFile(void);
+	~MappedFile(void);
+
+	bool open(const std::string& filename);
+	void close(void);
+	const char* data(void) const;
+	size_t size(void) const;
+};
+
+#endif
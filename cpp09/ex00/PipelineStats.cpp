@@ -0,0 +1,190 @@
+#include "PipelineStats.hpp"
+
+#include <iomanip>
+#include <time.h>
+
+static const char* const STAGE_NAMES[PipelineStats::STAGE_COUNT] = {
+	"parse", "validate", "lookup", "format"
+};
+
+static const char* const OUTCOME_NAMES[PipelineStats::OUTCOME_COUNT] = {
+	"priced", "bad input", "not a positive number", "too large a number",
+	"no rate for date", "line too long"
+};
+
+PipelineStats::PipelineStats(void) {
+	reset();
+}
+
+PipelineStats::PipelineStats(const PipelineStats& other) {
+	*this = other;
+}
+
+PipelineStats& PipelineStats::operator=(const PipelineStats& other) {
+	if (this != &other) {
+		for (int i = 0; i < STAGE_COUNT; i++)
+			_stageTicks[i] = other._stageTicks[i];
+		for (int i = 0; i < OUTCOME_COUNT; i++)
+			_outcomes[i] = other._outcomes[i];
+		_loadNanos = other._loadNanos;
+		_rates = other._rates;
+		_bytes = other._bytes;
+		_runTicks = other._runTicks;
+		_runNanos = other._runNanos;
+		_runStartTicks = other._runStartTicks;
+		_runStartNanos = other._runStartNanos;
+	}
+	return *this;
+}
+
+PipelineStats::~PipelineStats(void) {
+}
+
+void PipelineStats::reset(void) {
+	for (int i = 0; i < STAGE_COUNT; i++)
+		_stageTicks[i] = 0;
+	for (int i = 0; i < OUTCOME_COUNT; i++)
+		_outcomes[i] = 0;
+	_loadNanos = 0;
+	_rates = 0;
+	_bytes = 0;
+	_runTicks = 0;
+	_runNanos = 0;
+	_runStartTicks = 0;
+	_runStartNanos = 0;
+}
+
+// The time stamp counter where there is one (a few cycles to read), the
+// monotonic clock otherwise. finishRun() relates ticks to nanoseconds.
+uint64_t PipelineStats::ticks(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_ia32_rdtsc();
+#else
+	return nanos();
+#endif
+}
+
+uint64_t PipelineStats::nanos(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<uint64_t>(now.tv_sec) * 1000000000u + static_cast<uint64_t>(now.tv_nsec);
+}
+
+void PipelineStats::recordLoad(uint64_t nanos, size_t rates) {
+	_loadNanos += nanos;
+	_rates = rates;
+}
+
+void PipelineStats::startRun(void) {
+	_runStartNanos = nanos();
+	_runStartTicks = ticks();
+}
+
+void PipelineStats::finishRun(uint64_t bytes) {
+	_runTicks += ticks() - _runStartTicks;
+	_runNanos += nanos() - _runStartNanos;
+	_bytes += bytes;
+}
+
+// Adds a worker's stage times and outcome counts; run times stay the
+// caller's, so stage totals over several threads can exceed the wall time.
+void PipelineStats::merge(const PipelineStats& other) {
+	for (int i = 0; i < STAGE_COUNT; i++)
+		_stageTicks[i] += other._stageTicks[i];
+	for (int i = 0; i < OUTCOME_COUNT; i++)
+		_outcomes[i] += other._outcomes[i];
+}
+
+uint64_t PipelineStats::lines(void) const {
+	uint64_t total = 0;
+	for (int i = 0; i < OUTCOME_COUNT; i++)
+		total += _outcomes[i];
+	return total;
+}
+
+uint64_t PipelineStats::outcomes(Outcome outcome) const {
+	return _outcomes[outcome];
+}
+
+void PipelineStats::print(std::ostream& out) const {
+	double seconds = static_cast<double>(_runNanos) / 1e9;
+	double lineCount = static_cast<double>(lines());
+	double ticksPerNano = _runNanos == 0 ? 1.0
+		: static_cast<double>(_runTicks) / static_cast<double>(_runNanos);
+	uint64_t stageTotal = 0;
+	for (int i = 0; i < STAGE_COUNT; i++)
+		stageTotal += _stageTicks[i];
+
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(3);
+	out << "stats: load " << static_cast<double>(_loadNanos) / 1e6 << " ms, "
+		<< _rates << " rates\n";
+	out << "stats: input " << lines() << " lines, " << _bytes << " bytes in "
+		<< seconds << " s\n";
+	out << std::setprecision(0) << "stats: throughput "
+		<< (seconds > 0 ? lineCount / seconds : 0.0) << " lines/s, "
+		<< (seconds > 0 ? static_cast<double>(_bytes) / seconds : 0.0) << " bytes/s\n";
+	out << std::setprecision(1) << "stats: stages";
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		double nanosPerLine = lineCount > 0
+			? static_cast<double>(_stageTicks[i]) / ticksPerNano / lineCount : 0.0;
+		double share = stageTotal > 0
+			? 100.0 * static_cast<double>(_stageTicks[i]) / static_cast<double>(stageTotal) : 0.0;
+		out << (i == 0 ? " " : ", ") << STAGE_NAMES[i] << ' ' << nanosPerLine
+			<< " ns/line (" << share << "%)";
+	}
+	out << "\nstats: lines";
+	for (int i = 0; i < OUTCOME_COUNT; i++)
+		out << (i == 0 ? " " : ", ") << OUTCOME_NAMES[i] << ' ' << _outcomes[i];
+	out << std::endl;
+	out.flags(flags);
+	out.precision(precision);
+}
+
+PipelineStats::Timer::Timer(PipelineStats& stats)
+	: _stats(stats), _mark(PipelineStats::ticks()) {
+}
+
+PipelineStats::Timer::~Timer(void) {
+}
+
+void PipelineStats::Timer::lap(Stage stage) {
+	uint64_t now = PipelineStats::ticks();
+	_stats._stageTicks[stage] += now - _mark;
+	_mark = now;
+}
+
+void PipelineStats::Timer::count(Outcome outcome) {
+	_stats._outcomes[outcome]++;
+}
+
+void PipelineStats::Timer::restart(void) {
+	_mark = PipelineStats::ticks();
+}
+
+PipelineStats::Disabled::Disabled(void) {
+}
+
+PipelineStats::Disabled::Disabled(const Disabled& other) {
+	(void)other;
+}
+
+PipelineStats::Disabled& PipelineStats::Disabled::operator=(const Disabled& other) {
+	(void)other;
+	return *this;
+}
+
+PipelineStats::Disabled::~Disabled(void) {
+}
+
+void PipelineStats::Disabled::lap(Stage stage) {
+	(void)stage;
+}
+
+void PipelineStats::Disabled::count(Outcome outcome) {
+	(void)outcome;
+}
+
+void PipelineStats::Disabled::restart(void) {
+}
@@ -0,0 +1,93 @@
+#ifndef PIPELINESTATS_HPP
+#define PIPELINESTATS_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+
+// Counters and per-stage timers for `btc --stats`. The pricing code is
+// written against a probe type: Timer charges the ticks since its last
+// lap to a stage and counts outcomes, Disabled ignores both.
+class PipelineStats {
+public:
+	enum Stage {
+		PARSE,
+		VALIDATE,
+		LOOKUP,
+		FORMAT,
+		STAGE_COUNT
+	};
+
+	enum Outcome {
+		PRICED,
+		BAD_INPUT,
+		NOT_POSITIVE,
+		TOO_LARGE,
+		NO_RATE,
+		LINE_TOO_LONG,
+		OUTCOME_COUNT
+	};
+
+	// Bound to one PipelineStats for its whole life, so it cannot be
+	// copied or assigned.
+	class Timer {
+	private:
+		PipelineStats& _stats;
+		uint64_t _mark;
+
+		Timer(const Timer& other);
+		Timer& operator=(const Timer& other);
+
+	public:
+		explicit Timer(PipelineStats& stats);
+		~Timer(void);
+
+		void lap(Stage stage);
+		void count(Outcome outcome);
+		// Drops the time since the last lap, e.g. time spent waiting for input.
+		void restart(void);
+	};
+
+	class Disabled {
+	public:
+		Disabled(void);
+		Disabled(const Disabled& other);
+		Disabled& operator=(const Disabled& other);
+		~Disabled(void);
+
+		void lap(Stage stage);
+		void count(Outcome outcome);
+		void restart(void);
+	};
+
+private:
+	uint64_t _stageTicks[STAGE_COUNT];
+	uint64_t _outcomes[OUTCOME_COUNT];
+	uint64_t _loadNanos;
+	uint64_t _rates;
+	uint64_t _bytes;
+	uint64_t _runTicks;
+	uint64_t _runNanos;
+	uint64_t _runStartTicks;
+	uint64_t _runStartNanos;
+
+public:
+	PipelineStats(void);
+	PipelineStats(const PipelineStats& other);
+	PipelineStats& operator=(const PipelineStats& other);
+	~PipelineStats(void);
+
+	void reset(void);
+	void recordLoad(uint64_t nanos, size_t rates);
+	void startRun(void);
+	void finishRun(uint64_t bytes);
+	void merge(const PipelineStats& other);
+	uint64_t lines(void) const;
+	uint64_t outcomes(Outcome outcome) const;
+	void print(std::ostream& out) const;
+
+	static uint64_t ticks(void);
+	static uint64_t nanos(void);
+};
+
+#endif
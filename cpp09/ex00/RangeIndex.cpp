@@ -0,0 +1,410 @@
+#include "RangeIndex.hpp"
+
+#include <cmath>
+#include <cstring>
+
+// Limbs of the widest fixed-point sum: doubles span 2^-1074 to 2^1023,
+// plus the bits of a size_t count and a sign bit.
+static const size_t MAX_EXACT_LIMBS = (2098 + 64 + 1 + 31) / 32;
+// Limbs roundedQuotient() may add when it widens a sum before dividing.
+static const size_t WIDENING_LIMBS = (55 + 64) / 32 + 1;
+
+static int bitLength(uint64_t value) {
+	int length = 0;
+	for (; value != 0; value >>= 1)
+		length++;
+	return length;
+}
+
+static int trailingZeros(uint64_t value) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	int count = 0;
+	for (; (value & 1) == 0; value >>= 1)
+		count++;
+	return count;
+#endif
+}
+
+// A finite double is mantissa * 2^exponent, here with an odd mantissa
+// below 2^53 (or zero).
+struct Decomposed {
+	uint64_t mantissa;
+	int exponent;
+	bool negative;
+};
+
+static Decomposed decompose(double value) {
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	Decomposed parts;
+	int biased = static_cast<int>(bits >> 52 & 0x7ff);
+	parts.mantissa = bits & ((static_cast<uint64_t>(1) << 52) - 1);
+	parts.exponent = -1074;
+	if (biased != 0) {
+		parts.mantissa |= static_cast<uint64_t>(1) << 52;
+		parts.exponent = biased - 1075;
+	}
+	if (parts.mantissa != 0) {
+		int zeros = trailingZeros(parts.mantissa);
+		parts.mantissa >>= zeros;
+		parts.exponent += zeros;
+	}
+	parts.negative = (bits >> 63) != 0;
+	return parts;
+}
+
+static bool isFinite(double value) {
+	return value - value == 0.0;
+}
+
+// The IEEE sum of rates that include an infinity or a NaN.
+static bool nonFiniteSum(const double* rates, size_t count, double& sum) {
+	bool found = false;
+	sum = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		if (!isFinite(rates[i])) {
+			sum += rates[i];
+			found = true;
+		}
+	}
+	return found;
+}
+
+// Chooses the scale 2^shift that makes every rate an integer and the
+// number of limbs that holds the sum of `count` of them with a sign bit.
+static void fixedLayout(const double* rates, size_t count, int& shift, size_t& limbs) {
+	int lowest = 0;
+	int highest = 0;
+	bool any = false;
+	for (size_t i = 0; i < count; i++) {
+		Decomposed parts = decompose(rates[i]);
+		if (parts.mantissa == 0)
+			continue;
+		int low = parts.exponent;
+		int high = parts.exponent + bitLength(parts.mantissa) - 1;
+		if (!any || low < lowest)
+			lowest = low;
+		if (!any || high > highest)
+			highest = high;
+		any = true;
+	}
+	shift = any ? -lowest : 0;
+	int bits = (any ? highest - lowest + 1 : 1) + bitLength(count) + 1;
+	limbs = static_cast<size_t>(bits + 31) / 32;
+}
+
+// Adds (or subtracts) value * 2^shift, an integer, to the two's
+// complement number in limbs[0, count).
+static void accumulate(uint32_t* limbs, size_t count, double value, int shift) {
+	Decomposed parts = decompose(value);
+	if (parts.mantissa == 0)
+		return;
+	size_t position = static_cast<size_t>(parts.exponent + shift);
+	size_t limb = position / 32;
+	unsigned offset = static_cast<unsigned>(position % 32);
+	uint64_t rest = offset == 0 ? parts.mantissa >> 32 : parts.mantissa >> (32 - offset);
+	uint32_t pieces[3] = {
+		static_cast<uint32_t>(parts.mantissa << offset),
+		static_cast<uint32_t>(rest),
+		static_cast<uint32_t>(rest >> 32)
+	};
+	uint64_t carry = parts.negative ? 1 : 0;
+	for (size_t i = limb; i < count; i++) {
+		uint32_t piece = i - limb < 3 ? pieces[i - limb] : 0;
+		if (parts.negative) {
+			// a - b = a + ~b + 1
+			uint64_t total = static_cast<uint64_t>(limbs[i]) + static_cast<uint32_t>(~piece) + carry;
+			limbs[i] = static_cast<uint32_t>(total);
+			carry = total >> 32;
+		} else {
+			if (i - limb >= 3 && carry == 0)
+				break;
+			uint64_t total = static_cast<uint64_t>(limbs[i]) + piece + carry;
+			limbs[i] = static_cast<uint32_t>(total);
+			carry = total >> 32;
+		}
+	}
+}
+
+// Rounds sum * 2^-shift / count to the nearest double, ties to even. The
+// sum arrives in two's complement in sum[0, size) and is consumed; the
+// buffer has WIDENING_LIMBS more limbs of room. A table holds at most
+// one rate per int day, so count fits in 32 bits.
+static double roundedQuotient(uint32_t* sum, size_t size, int shift, size_t count) {
+	bool negative = size != 0 && (sum[size - 1] >> 31) != 0;
+	if (negative) {
+		uint64_t carry = 1;
+		for (size_t i = 0; i < size; i++) {
+			uint64_t total = static_cast<uint64_t>(static_cast<uint32_t>(~sum[i])) + carry;
+			sum[i] = static_cast<uint32_t>(total);
+			carry = total >> 32;
+		}
+	}
+	while (size != 0 && sum[size - 1] == 0)
+		size--;
+	if (size == 0)
+		return 0.0;
+
+	// Enough quotient bits for the mantissa, a rounding bit and one more.
+	int length = static_cast<int>(size - 1) * 32 + bitLength(sum[size - 1]);
+	int divisorLength = bitLength(count);
+	int extra = 55 + divisorLength - length;
+	if (extra > 0) {
+		size_t words = static_cast<size_t>(extra) / 32;
+		unsigned offset = static_cast<unsigned>(extra % 32);
+		sum[size + words] = offset == 0 ? 0 : sum[size - 1] >> (32 - offset);
+		for (size_t i = size; i-- > 0;) {
+			uint32_t carry = offset == 0 || i == 0 ? 0 : sum[i - 1] >> (32 - offset);
+			sum[i + words] = sum[i] << offset | carry;
+		}
+		for (size_t i = 0; i < words; i++)
+			sum[i] = 0;
+		size += words + 1;
+	} else {
+		extra = 0;
+	}
+
+	uint64_t divisor = static_cast<uint64_t>(count);
+	uint64_t remainder = 0;
+	for (size_t i = size; i-- > 0;) {
+		uint64_t current = remainder << 32 | sum[i];
+		sum[i] = static_cast<uint32_t>(current / divisor);
+		remainder = current % divisor;
+	}
+	while (size != 0 && sum[size - 1] == 0)
+		size--;
+
+	int quotientLength = static_cast<int>(size - 1) * 32 + bitLength(sum[size - 1]);
+	int scale = -shift - extra;
+	int lowestPlace = quotientLength - 1 + scale - 52;
+	if (lowestPlace < -1074)
+		lowestPlace = -1074;
+	int dropped = lowestPlace - scale;
+
+	uint64_t mantissa = 0;
+	for (int bit = quotientLength - 1; bit >= dropped; bit--)
+		mantissa = mantissa << 1 | (sum[static_cast<size_t>(bit) / 32] >> (bit % 32) & 1);
+	bool half = dropped >= 1 && dropped - 1 < quotientLength
+		&& (sum[static_cast<size_t>(dropped - 1) / 32] >> ((dropped - 1) % 32) & 1) != 0;
+	bool below = remainder != 0;
+	for (int bit = 0; bit < dropped - 1 && bit < quotientLength && !below; bit++)
+		below = (sum[static_cast<size_t>(bit) / 32] >> (bit % 32) & 1) != 0;
+	if (half && (below || (mantissa & 1) != 0))
+		mantissa++;
+	double result = std::ldexp(static_cast<double>(mantissa), lowestPlace);
+	return negative ? -result : result;
+}
+
+RangeIndex::RangeIndex(void)
+	: _shift(0), _limbs(0), _sums(NULL), _sumLimbs(0), _blocks(0), _levelEntries(0),
+	  _minimums(NULL), _maximums(NULL) {
+}
+
+RangeIndex::RangeIndex(const RangeIndex& other)
+	: _shift(0), _limbs(0), _sums(NULL), _sumLimbs(0), _blocks(0), _levelEntries(0),
+	  _minimums(NULL), _maximums(NULL) {
+	*this = other;
+}
+
+RangeIndex& RangeIndex::operator=(const RangeIndex& other) {
+	if (this != &other) {
+		uint32_t* sums = NULL;
+		double* minimums = NULL;
+		double* maximums = NULL;
+		try {
+			if (other._sumLimbs != 0) {
+				sums = new uint32_t[other._sumLimbs];
+				std::memcpy(sums, other._sums, other._sumLimbs * sizeof(uint32_t));
+			}
+			if (other._levelEntries != 0) {
+				minimums = new double[other._levelEntries];
+				maximums = new double[other._levelEntries];
+				std::memcpy(minimums, other._minimums, other._levelEntries * sizeof(double));
+				std::memcpy(maximums, other._maximums, other._levelEntries * sizeof(double));
+			}
+		} catch (...) {
+			delete[] sums;
+			delete[] minimums;
+			delete[] maximums;
+			throw;
+		}
+		release();
+		_shift = other._shift;
+		_limbs = other._limbs;
+		_sums = sums;
+		_sumLimbs = other._sumLimbs;
+		_blocks = other._blocks;
+		_levelEntries = other._levelEntries;
+		_minimums = minimums;
+		_maximums = maximums;
+	}
+	return *this;
+}
+
+RangeIndex::~RangeIndex(void) {
+	release();
+}
+
+void RangeIndex::release(void) {
+	delete[] _sums;
+	delete[] _minimums;
+	delete[] _maximums;
+	_sums = NULL;
+	_minimums = NULL;
+	_maximums = NULL;
+	_limbs = 0;
+	_sumLimbs = 0;
+	_blocks = 0;
+	_levelEntries = 0;
+}
+
+void RangeIndex::build(const double* rates, size_t count) {
+	double unused;
+	size_t limbs;
+	release();
+	fixedLayout(rates, count, _shift, limbs);
+	if (limbs <= MAX_SUM_LIMBS && !nonFiniteSum(rates, count, unused)) {
+		_sums = new uint32_t[(count + 1) * limbs]();
+		_sumLimbs = (count + 1) * limbs;
+		_limbs = limbs;
+		for (size_t i = 0; i < count; i++) {
+			uint32_t* next = _sums + (i + 1) * _limbs;
+			std::memcpy(next, next - _limbs, _limbs * sizeof(uint32_t));
+			accumulate(next, _limbs, rates[i], _shift);
+		}
+	}
+
+	// Level 0 holds each block's extreme; level k combines 2^k blocks.
+	size_t blocks = (count + BLOCK_ENTRIES - 1) / BLOCK_ENTRIES;
+	size_t levels = 1;
+	for (size_t width = 1; width * 2 <= blocks; width *= 2)
+		levels++;
+	if (blocks == 0)
+		return;
+	_minimums = new double[blocks * levels];
+	_maximums = new double[blocks * levels];
+	_blocks = blocks;
+	_levelEntries = blocks * levels;
+	for (size_t block = 0; block < _blocks; block++) {
+		size_t first = block * BLOCK_ENTRIES;
+		size_t length = count - first < BLOCK_ENTRIES ? count - first : BLOCK_ENTRIES;
+		_minimums[block] = scanMinimum(rates + first, length);
+		_maximums[block] = scanMaximum(rates + first, length);
+	}
+	for (size_t width = 1, level = 0; width * 2 <= _blocks; width *= 2, level++) {
+		size_t previous = level * _blocks;
+		size_t current = previous + _blocks;
+		for (size_t block = 0; block < _blocks; block++) {
+			if (block + width * 2 > _blocks) {
+				_minimums[current + block] = 0.0;
+				_maximums[current + block] = 0.0;
+				continue;
+			}
+			double lowLeft = _minimums[previous + block];
+			double lowRight = _minimums[previous + block + width];
+			double highLeft = _maximums[previous + block];
+			double highRight = _maximums[previous + block + width];
+			_minimums[current + block] = lowRight < lowLeft ? lowRight : lowLeft;
+			_maximums[current + block] = highRight > highLeft ? highRight : highLeft;
+		}
+	}
+}
+
+bool RangeIndex::hasExactSums(void) const {
+	return _limbs != 0;
+}
+
+// The mean of rates[first, first + count), count > 0.
+double RangeIndex::average(const double* rates, size_t first, size_t count) const {
+	if (_limbs == 0)
+		return exactAverage(rates + first, count);
+	uint32_t sum[MAX_SUM_LIMBS + WIDENING_LIMBS];
+	const uint32_t* high = _sums + (first + count) * _limbs;
+	const uint32_t* low = _sums + first * _limbs;
+	uint64_t carry = 1;
+	for (size_t i = 0; i < _limbs; i++) {
+		uint64_t total = static_cast<uint64_t>(high[i]) + static_cast<uint32_t>(~low[i]) + carry;
+		sum[i] = static_cast<uint32_t>(total);
+		carry = total >> 32;
+	}
+	return roundedQuotient(sum, _limbs, _shift, count);
+}
+
+// Extreme over whole blocks [first, last] from the two overlapping
+// power-of-two spans that cover them; the left one wins ties.
+double RangeIndex::blockExtreme(const double* levels, size_t first, size_t last,
+	bool maximum) const {
+	size_t level = 0;
+	while (static_cast<size_t>(2) << level <= last - first + 1)
+		level++;
+	double left = levels[level * _blocks + first];
+	double right = levels[level * _blocks + last + 1 - (static_cast<size_t>(1) << level)];
+	if (maximum)
+		return right > left ? right : left;
+	return right < left ? right : left;
+}
+
+// The first of the smallest rates in rates[first, first + count), count > 0.
+double RangeIndex::minimum(const double* rates, size_t first, size_t count) const {
+	size_t last = first + count - 1;
+	size_t firstBlock = first / BLOCK_ENTRIES;
+	size_t lastBlock = last / BLOCK_ENTRIES;
+	if (lastBlock - firstBlock < 2)
+		return scanMinimum(rates + first, count);
+	size_t headEnd = (firstBlock + 1) * BLOCK_ENTRIES;
+	size_t tailBegin = lastBlock * BLOCK_ENTRIES;
+	double result = scanMinimum(rates + first, headEnd - first);
+	double middle = blockExtreme(_minimums, firstBlock + 1, lastBlock - 1, false);
+	double tail = scanMinimum(rates + tailBegin, last + 1 - tailBegin);
+	result = middle < result ? middle : result;
+	return tail < result ? tail : result;
+}
+
+double RangeIndex::maximum(const double* rates, size_t first, size_t count) const {
+	size_t last = first + count - 1;
+	size_t firstBlock = first / BLOCK_ENTRIES;
+	size_t lastBlock = last / BLOCK_ENTRIES;
+	if (lastBlock - firstBlock < 2)
+		return scanMaximum(rates + first, count);
+	size_t headEnd = (firstBlock + 1) * BLOCK_ENTRIES;
+	size_t tailBegin = lastBlock * BLOCK_ENTRIES;
+	double result = scanMaximum(rates + first, headEnd - first);
+	double middle = blockExtreme(_maximums, firstBlock + 1, lastBlock - 1, true);
+	double tail = scanMaximum(rates + tailBegin, last + 1 - tailBegin);
+	result = middle > result ? middle : result;
+	return tail > result ? tail : result;
+}
+
+// The same rounded mean as average(), summed on the spot.
+double RangeIndex::exactAverage(const double* rates, size_t count) {
+	double special;
+	if (nonFiniteSum(rates, count, special))
+		return special;
+	int shift;
+	size_t limbs;
+	fixedLayout(rates, count, shift, limbs);
+	uint32_t sum[MAX_EXACT_LIMBS + WIDENING_LIMBS] = { 0 };
+	for (size_t i = 0; i < count; i++)
+		accumulate(sum, limbs, rates[i], shift);
+	return roundedQuotient(sum, limbs, shift, count);
+}
+
+double RangeIndex::scanMinimum(const double* rates, size_t count) {
+	double result = rates[0];
+	for (size_t i = 1; i < count; i++) {
+		if (rates[i] < result)
+			result = rates[i];
+	}
+	return result;
+}
+
+double RangeIndex::scanMaximum(const double* rates, size_t count) {
+	double result = rates[0];
+	for (size_t i = 1; i < count; i++) {
+		if (rates[i] > result)
+			result = rates[i];
+	}
+	return result;
+}
@@ -0,0 +1,51 @@
+#ifndef RANGEINDEX_HPP
+#define RANGEINDEX_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+// Range aggregates over a RateTable's rates, built once per table
+// version. Sums are exact: every rate is a multiple of 2^-shift, so the
+// prefix sums are kept as fixed-point integers (two's complement, in
+// 32-bit limbs) and a range sum is the difference of two of them. The
+// average is that sum divided by the count and rounded once. Rates too
+// far apart in magnitude to fit MAX_SUM_LIMBS are summed per query, just
+// as exactly. Minimum and maximum come from a sparse table over blocks of
+// BLOCK_ENTRIES rates plus a scan of the two partial blocks at the ends.
+class RangeIndex {
+public:
+	static const size_t BLOCK_ENTRIES = 16;
+	static const size_t MAX_SUM_LIMBS = 8;
+
+private:
+	int _shift;
+	size_t _limbs;
+	uint32_t* _sums;
+	size_t _sumLimbs;
+	size_t _blocks;
+	size_t _levelEntries;
+	double* _minimums;
+	double* _maximums;
+
+	void release(void);
+	double blockExtreme(const double* levels, size_t first, size_t last,
+		bool maximum) const;
+
+public:
+	RangeIndex(void);
+	RangeIndex(const RangeIndex& other);
+	RangeIndex& operator=(const RangeIndex& other);
+	~RangeIndex(void);
+
+	void build(const double* rates, size_t count);
+	bool hasExactSums(void) const;
+	double average(const double* rates, size_t first, size_t count) const;
+	double minimum(const double* rates, size_t first, size_t count) const;
+	double maximum(const double* rates, size_t first, size_t count) const;
+
+	static double exactAverage(const double* rates, size_t count);
+	static double scanMinimum(const double* rates, size_t count);
+	static double scanMaximum(const double* rates, size_t count);
+};
+
+#endif
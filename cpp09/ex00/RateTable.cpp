@@ -0,0 +1,529 @@
+#include "RateTable.hpp"
+#include "MappedFile.hpp"
+#include "RangeIndex.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+// Snapshot layout: this header, `count` int32 day numbers padded to a
+// multiple of 8 bytes, then `count` doubles. Sums run over the payload as
+// 32-bit words (Fletcher style, mod 2^64). Native byte order; the marker
+// rejects a snapshot written on a machine of the other endianness.
+static const char SNAPSHOT_MAGIC[8] = { 'B', 'T', 'C', 'S', 'N', 'A', 'P', '\0' };
+static const uint32_t SNAPSHOT_VERSION = 3;
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t count;
+	uint64_t sourceSize;
+	uint64_t sourceMtime;
+	uint64_t sourceSample;
+	uint64_t sumLow;
+	uint64_t sumHigh;
+	uint32_t byteOrder;
+	uint32_t reserved;
+};
+
+static size_t paddedDayBytes(size_t count) {
+	return (count * sizeof(int) + 7) / 8 * 8;
+}
+
+static void addToChecksum(const char* bytes, size_t length, uint64_t& low, uint64_t& high) {
+	for (size_t offset = 0; offset + 4 <= length; offset += 4) {
+		uint32_t word;
+		std::memcpy(&word, bytes + offset, sizeof(word));
+		low += word;
+		high += low;
+	}
+}
+
+RateTable::RateTable(void)
+	: _days(NULL), _rates(NULL), _size(0), _capacity(0), _sorted(true),
+	  _dense(NULL), _denseSize(0), _snapshot(NULL), _range(NULL) {
+}
+
+RateTable::RateTable(const RateTable& other)
+	: _days(NULL), _rates(NULL), _size(0), _capacity(0), _sorted(true),
+	  _dense(NULL), _denseSize(0), _snapshot(NULL), _range(NULL) {
+	*this = other;
+}
+
+RateTable& RateTable::operator=(const RateTable& other) {
+	if (this != &other) {
+		int* days = NULL;
+		double* rates = NULL;
+		double* dense = NULL;
+		RangeIndex* range = NULL;
+		try {
+			if (other._size > 0) {
+				days = new int[other._size];
+				rates = new double[other._size];
+			}
+			if (other._denseSize > 0)
+				dense = new double[other._denseSize];
+			if (other._range != NULL)
+				range = new RangeIndex(*other._range);
+		} catch (...) {
+			delete[] days;
+			delete[] rates;
+			delete[] dense;
+			throw;
+		}
+		for (size_t i = 0; i < other._size; i++) {
+			days[i] = other._days[i];
+			rates[i] = other._rates[i];
+		}
+		for (size_t i = 0; i < other._denseSize; i++)
+			dense[i] = other._dense[i];
+		releaseStorage();
+		delete[] _dense;
+		delete _range;
+		_days = days;
+		_rates = rates;
+		_dense = dense;
+		_range = range;
+		_size = other._size;
+		_capacity = other._size;
+		_sorted = other._sorted;
+		_denseSize = other._denseSize;
+	}
+	return *this;
+}
+
+RateTable::~RateTable(void) {
+	releaseStorage();
+	delete[] _dense;
+	delete _range;
+}
+
+// Frees the day/rate arrays, or unmaps them when they live in a snapshot.
+void RateTable::releaseStorage(void) {
+	if (_snapshot != NULL) {
+		delete _snapshot;
+		_snapshot = NULL;
+	} else {
+		delete[] _days;
+		delete[] _rates;
+	}
+	_days = NULL;
+	_rates = NULL;
+}
+
+void RateTable::reserve(size_t capacity) {
+	if (capacity <= _capacity)
+		return;
+	int* days = new int[capacity];
+	double* rates;
+	try {
+		rates = new double[capacity];
+	} catch (...) {
+		delete[] days;
+		throw;
+	}
+	for (size_t i = 0; i < _size; i++) {
+		days[i] = _days[i];
+		rates[i] = _rates[i];
+	}
+	releaseStorage();
+	_days = days;
+	_rates = rates;
+	_capacity = capacity;
+}
+
+void RateTable::clear(void) {
+	dropDenseIndex();
+	dropRangeIndex();
+	if (_snapshot != NULL) {
+		releaseStorage();
+		_capacity = 0;
+	}
+	_size = 0;
+	_sorted = true;
+}
+
+// Rows arrive in file order. An equal day directly after itself overwrites
+// in place; anything out of order is left for finalize() to resolve.
+void RateTable::append(int day, double rate) {
+	dropDenseIndex();
+	dropRangeIndex();
+	if (_snapshot != NULL)
+		reserve(_size < 512 ? 1024 : _size * 2);
+	if (_size > 0 && day <= _days[_size - 1]) {
+		if (day == _days[_size - 1]) {
+			_rates[_size - 1] = rate;
+			return;
+		}
+		_sorted = false;
+	}
+	if (_size == _capacity)
+		reserve(_capacity < 1024 ? 1024 : _capacity * 2);
+	_days[_size] = day;
+	_rates[_size] = rate;
+	_size++;
+}
+
+// Unordered input is sorted through a map so that, as before, the last
+// row for a date wins.
+void RateTable::finalize(void) {
+	if (_sorted)
+		return;
+	std::map<int, double> ordered;
+	for (size_t i = 0; i < _size; i++)
+		ordered[_days[i]] = _rates[i];
+	_size = 0;
+	for (std::map<int, double>::const_iterator it = ordered.begin();
+		it != ordered.end(); ++it) {
+		_days[_size] = it->first;
+		_rates[_size] = it->second;
+		_size++;
+	}
+	_sorted = true;
+}
+
+// Expands the history into one slot per day from the first to the last
+// entry, each holding the rate in effect on that day. Skipped when the
+// range needs more than `maxSlotsPerEntry` slots per stored entry.
+bool RateTable::buildDenseIndex(size_t maxSlotsPerEntry) {
+	dropDenseIndex();
+	if (_size == 0)
+		return false;
+	size_t span = static_cast<size_t>(_days[_size - 1] - _days[0]) + 1;
+	if (span / _size > maxSlotsPerEntry)
+		return false;
+	_dense = new double[span];
+	_denseSize = span;
+	size_t entry = 0;
+	for (size_t slot = 0; slot < span; slot++) {
+		if (entry + 1 < _size
+			&& static_cast<size_t>(_days[entry + 1] - _days[0]) == slot)
+			entry++;
+		_dense[slot] = _rates[entry];
+	}
+	return true;
+}
+
+void RateTable::dropDenseIndex(void) {
+	delete[] _dense;
+	_dense = NULL;
+	_denseSize = 0;
+}
+
+bool RateTable::hasDenseIndex(void) const {
+	return _dense != NULL;
+}
+
+// Prefix sums and block extremes over the current (finalized) rates.
+void RateTable::buildRangeIndex(void) {
+	RangeIndex* range = new RangeIndex;
+	try {
+		range->build(_rates, _size);
+	} catch (...) {
+		delete range;
+		throw;
+	}
+	delete _range;
+	_range = range;
+}
+
+void RateTable::dropRangeIndex(void) {
+	delete _range;
+	_range = NULL;
+}
+
+bool RateTable::hasRangeIndex(void) const {
+	return _range != NULL;
+}
+
+// Finds the last entry whose day is not after `day`. The loop keeps
+// `base[0] <= day` and halves the window with a select instead of a branch.
+bool RateTable::find(int day, double& rate) const {
+	if (_size == 0 || day < _days[0])
+		return false;
+	if (_dense != NULL) {
+		size_t slot = static_cast<size_t>(day - _days[0]);
+		rate = slot < _denseSize ? _dense[slot] : _dense[_denseSize - 1];
+		return true;
+	}
+	rate = _rates[lastAtOrBefore(0, _size, day)];
+	return true;
+}
+
+// Index of the last entry <= day among [first, first + count), given that
+// _days[first] <= day. Branchless so the loop has no mispredictions.
+size_t RateTable::lastAtOrBefore(size_t first, size_t count, int day) const {
+	const int* base = _days + first;
+	while (count > 1) {
+		size_t half = count / 2;
+		base = (base[half] <= day) ? base + half : base;
+		count -= half;
+	}
+	return static_cast<size_t>(base - _days);
+}
+
+// Looks up rates[i] for every days[i] and returns how many leading queries
+// were answered; it stops at the first day before the table starts. In an
+// ordered batch each query gallops forward from the previous answer, so a
+// sorted batch costs O(n + m) at worst and O(n log(m / n)) when sparse;
+// a step backwards is searched below the previous answer. Shuffled batches
+// and tables with a calendar index use find() per query.
+size_t RateTable::findBatch(const int* days, size_t count, double* rates) const {
+	size_t descents = 0;
+	for (size_t i = 1; i < count; i++)
+		descents += days[i] < days[i - 1];
+	if (_dense != NULL || descents * UNSORTED_BATCH_RATIO > count) {
+		for (size_t i = 0; i < count; i++) {
+			if (!find(days[i], rates[i]))
+				return i;
+		}
+		return count;
+	}
+
+	size_t position = 0;
+	for (size_t i = 0; i < count; i++) {
+		int day = days[i];
+		if (_size == 0 || day < _days[0])
+			return i;
+		if (day < _days[position]) {
+			position = lastAtOrBefore(0, position, day);
+		} else {
+			size_t step = 1;
+			while (position + step < _size && _days[position + step] <= day) {
+				position += step;
+				step *= 2;
+			}
+			size_t span = _size - position < step ? _size - position : step;
+			position = lastAtOrBefore(position, span, day);
+		}
+		rates[i] = _rates[position];
+	}
+	return count;
+}
+
+// The rate on `day` read off the straight line between the entries
+// around it. Exact entry days and days after the last entry give the
+// entry's rate, as find() does; days before the first have none.
+bool RateTable::interpolate(int day, double& rate) const {
+	if (_size == 0 || day < _days[0])
+		return false;
+	size_t before = lastAtOrBefore(0, _size, day);
+	if (_days[before] == day || before + 1 == _size) {
+		rate = _rates[before];
+		return true;
+	}
+	double offset = static_cast<double>(day - _days[before]);
+	double span = static_cast<double>(_days[before + 1] - _days[before]);
+	rate = _rates[before] + (_rates[before + 1] - _rates[before]) * offset / span;
+	return true;
+}
+
+// The entries whose day lies in [from, to]; false when there are none.
+bool RateTable::rangeEntries(int from, int to, size_t& first, size_t& count) const {
+	if (_size == 0 || from > to || to < _days[0] || from > _days[_size - 1])
+		return false;
+	first = from <= _days[0] ? 0 : lastAtOrBefore(0, _size, from - 1) + 1;
+	size_t last = lastAtOrBefore(0, _size, to);
+	if (first > last)
+		return false;
+	count = last - first + 1;
+	return true;
+}
+
+// Mean of the rates stored for days in [from, to], rounded once from the
+// exact sum.
+bool RateTable::rangeAverage(int from, int to, double& average) const {
+	size_t first;
+	size_t count;
+	if (!rangeEntries(from, to, first, count))
+		return false;
+	average = _range != NULL ? _range->average(_rates, first, count)
+		: RangeIndex::exactAverage(_rates + first, count);
+	return true;
+}
+
+bool RateTable::rangeMinimum(int from, int to, double& minimum) const {
+	size_t first;
+	size_t count;
+	if (!rangeEntries(from, to, first, count))
+		return false;
+	minimum = _range != NULL ? _range->minimum(_rates, first, count)
+		: RangeIndex::scanMinimum(_rates + first, count);
+	return true;
+}
+
+bool RateTable::rangeMaximum(int from, int to, double& maximum) const {
+	size_t first;
+	size_t count;
+	if (!rangeEntries(from, to, first, count))
+		return false;
+	maximum = _range != NULL ? _range->maximum(_rates, first, count)
+		: RangeIndex::scanMaximum(_rates + first, count);
+	return true;
+}
+
+size_t RateTable::size(void) const {
+	return _size;
+}
+
+int RateTable::dayAt(size_t index) const {
+	return _days[index];
+}
+
+double RateTable::rateAt(size_t index) const {
+	return _rates[index];
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar.
+int RateTable::dayNumber(int year, int month, int day) {
+	if (month <= 2)
+		year--;
+	int era = (year >= 0 ? year : year - 399) / 400;
+	int yearOfEra = year - era * 400;
+	int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + dayOfEra - 719468;
+}
+
+// Validates a `YYYY-MM-DD` Gregorian date (year 0001 and later) and
+// converts it to its day number in one pass, without building strings.
+bool RateTable::decodeDate(const char* text, size_t length, int& day) {
+	static const unsigned char DAYS_IN_MONTH[13] = {
+		0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+	};
+	if (length != 10 || text[4] != '-' || text[7] != '-')
+		return false;
+	unsigned int digits[10];
+	unsigned int invalid = 0;
+	for (int i = 0; i < 10; i++) {
+		digits[i] = static_cast<unsigned int>(static_cast<unsigned char>(text[i]) - '0');
+		invalid |= (i == 4 || i == 7) ? 0 : (digits[i] > 9);
+	}
+	if (invalid)
+		return false;
+	int year = static_cast<int>(digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3]);
+	unsigned int month = digits[5] * 10 + digits[6];
+	unsigned int dayOfMonth = digits[8] * 10 + digits[9];
+	if (year < 1 || month - 1 > 11 || dayOfMonth - 1 >= DAYS_IN_MONTH[month])
+		return false;
+	if (month == 2 && dayOfMonth == 29
+		&& !((year % 4 == 0 && year % 100 != 0) || year % 400 == 0))
+		return false;
+	day = dayNumber(year, static_cast<int>(month), static_cast<int>(dayOfMonth));
+	return true;
+}
+
+// Bytes hashed from each of the start, middle and end of the source.
+static const size_t SAMPLE_WINDOW = 4096;
+
+static uint64_t hashBytes(uint64_t hash, const char* data, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 1099511628211u;
+	}
+	return hash;
+}
+
+// 64-bit FNV-1a over the first, middle and last SAMPLE_WINDOW bytes of the
+// source, or all of it when shorter. Size and nanosecond mtime decide
+// whether a snapshot is reused; the sample also catches a same-size edit
+// of the header, the newest rows or the middle without reading the whole
+// CSV on every warm start.
+uint64_t RateTable::sourceSample(const char* data, size_t length) {
+	uint64_t hash = 14695981039346656037u;
+	if (length <= 3 * SAMPLE_WINDOW)
+		return hashBytes(hash, data, length);
+	hash = hashBytes(hash, data, SAMPLE_WINDOW);
+	hash = hashBytes(hash, data + (length - SAMPLE_WINDOW) / 2, SAMPLE_WINDOW);
+	return hashBytes(hash, data + length - SAMPLE_WINDOW, SAMPLE_WINDOW);
+}
+
+bool RateTable::saveSnapshot(const std::string& path, uint64_t sourceSize,
+	uint64_t sourceMtime, uint64_t sourceSample) const {
+	SnapshotHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = SNAPSHOT_VERSION;
+	header.count = static_cast<uint32_t>(_size);
+	header.sourceSize = sourceSize;
+	header.sourceMtime = sourceMtime;
+	header.sourceSample = sourceSample;
+	header.byteOrder = SNAPSHOT_BYTE_ORDER;
+	if (static_cast<size_t>(header.count) != _size)
+		return false;
+
+	const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	size_t dayBytes = _size * sizeof(int);
+	size_t padBytes = paddedDayBytes(_size) - dayBytes;
+	const char* days = reinterpret_cast<const char*>(_days);
+	const char* rates = reinterpret_cast<const char*>(_rates);
+	addToChecksum(days, dayBytes, header.sumLow, header.sumHigh);
+	addToChecksum(padding, padBytes, header.sumLow, header.sumHigh);
+	addToChecksum(rates, _size * sizeof(double), header.sumLow, header.sumHigh);
+
+	// Written beside the target and renamed, so readers never see half a file.
+	std::string temporary = path + ".tmp";
+	std::ofstream out(temporary.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+		return false;
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (_size > 0) {
+		out.write(days, static_cast<std::streamsize>(dayBytes));
+		out.write(padding, static_cast<std::streamsize>(padBytes));
+		out.write(rates, static_cast<std::streamsize>(_size * sizeof(double)));
+	}
+	out.close();
+	if (out.fail() || std::rename(temporary.c_str(), path.c_str()) != 0) {
+		std::remove(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Adopts a snapshot written for the same source size, mtime and sample.
+// Anything unexpected (missing file, other version, wrong length, bad
+// checksum) returns false and leaves the table untouched.
+bool RateTable::loadSnapshot(const std::string& path, uint64_t sourceSize,
+	uint64_t sourceMtime, uint64_t sourceSample) {
+	MappedFile* mapping = new MappedFile;
+	SnapshotHeader header;
+	if (!mapping->open(path) || mapping->size() < sizeof(header)) {
+		delete mapping;
+		return false;
+	}
+	std::memcpy(&header, mapping->data(), sizeof(header));
+	size_t count = header.count;
+	size_t dayBytes = paddedDayBytes(count);
+	if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+		|| header.version != SNAPSHOT_VERSION
+		|| header.byteOrder != SNAPSHOT_BYTE_ORDER
+		|| header.sourceSize != sourceSize
+		|| header.sourceMtime != sourceMtime
+		|| header.sourceSample != sourceSample
+		|| mapping->size() != sizeof(header) + dayBytes + count * sizeof(double)) {
+		delete mapping;
+		return false;
+	}
+	const char* payload = mapping->data() + sizeof(header);
+	uint64_t low = 0;
+	uint64_t high = 0;
+	addToChecksum(payload, dayBytes + count * sizeof(double), low, high);
+	if (low != header.sumLow || high != header.sumHigh) {
+		delete mapping;
+		return false;
+	}
+
+	dropDenseIndex();
+	dropRangeIndex();
+	releaseStorage();
+	_snapshot = mapping;
+	// The mapping is read-only; append() copies it out before any write.
+	_days = reinterpret_cast<int*>(const_cast<char*>(payload));
+	_rates = reinterpret_cast<double*>(const_cast<char*>(payload + dayBytes));
+	_size = count;
+	_capacity = count;
+	_sorted = true;
+	return true;
+}
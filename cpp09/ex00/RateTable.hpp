@@ -0,0 +1,75 @@
+#ifndef RATETABLE_HPP
+#define RATETABLE_HPP
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+class MappedFile;
+class RangeIndex;
+
+// Read-optimized rate history: ascending day numbers and their rates in
+// two parallel contiguous arrays. For dense histories an optional
+// calendar index holds the effective rate of every day in range. A table
+// loaded from a snapshot reads the two arrays straight from the mapping
+// and copies them out only when it is modified. A RangeIndex, when
+// built, answers range aggregates without walking the range.
+class RateTable {
+private:
+	int* _days;
+	double* _rates;
+	size_t _size;
+	size_t _capacity;
+	bool _sorted;
+	double* _dense;
+	size_t _denseSize;
+	MappedFile* _snapshot;
+	RangeIndex* _range;
+
+	// A batch with more than one descent per this many queries is treated
+	// as unsorted and searched query by query.
+	static const size_t UNSORTED_BATCH_RATIO = 8;
+
+	void reserve(size_t capacity);
+	void releaseStorage(void);
+	size_t lastAtOrBefore(size_t first, size_t count, int day) const;
+	bool rangeEntries(int from, int to, size_t& first, size_t& count) const;
+
+public:
+	RateTable(void);
+	RateTable(const RateTable& other);
+	RateTable& operator=(const RateTable& other);
+	~RateTable(void);
+
+	void clear(void);
+	void append(int day, double rate);
+	void finalize(void);
+	bool buildDenseIndex(size_t maxSlotsPerEntry);
+	void dropDenseIndex(void);
+	bool hasDenseIndex(void) const;
+	void buildRangeIndex(void);
+	void dropRangeIndex(void);
+	bool hasRangeIndex(void) const;
+	bool find(int day, double& rate) const;
+	size_t findBatch(const int* days, size_t count, double* rates) const;
+	bool interpolate(int day, double& rate) const;
+	bool rangeAverage(int from, int to, double& average) const;
+	bool rangeMinimum(int from, int to, double& minimum) const;
+	bool rangeMaximum(int from, int to, double& maximum) const;
+	size_t size(void) const;
+	int dayAt(size_t index) const;
+	double rateAt(size_t index) const;
+
+	// sourceMtime is in nanoseconds; sourceSample comes from sourceSample().
+	bool saveSnapshot(const std::string& path, uint64_t sourceSize,
+		uint64_t sourceMtime, uint64_t sourceSample) const;
+	bool loadSnapshot(const std::string& path, uint64_t sourceSize,
+		uint64_t sourceMtime, uint64_t sourceSample);
+
+	static uint64_t sourceSample(const char* data, size_t length);
+
+	static int dayNumber(int year, int month, int day);
+	static bool decodeDate(const char* text, size_t length, int& day);
+};
+
+#endif
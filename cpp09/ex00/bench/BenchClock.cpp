@@ -0,0 +1,21 @@
+#include "BenchClock.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sys/time.h>
+
+double nowUs(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+void report(const std::string& label, double elapsedUs, size_t count,
+	const char* unit, double checksum)
+{
+	std::cout << "  " << std::left << std::setw(28) << label << std::right
+		<< std::fixed << std::setprecision(1) << std::setw(9)
+		<< elapsedUs * 1000.0 / static_cast<double>(count) << " ns/" << unit
+		<< "  (checksum " << std::setprecision(3) << checksum << ")" << std::endl;
+}
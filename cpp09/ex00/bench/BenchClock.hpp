@@ -0,0 +1,16 @@
+#ifndef BENCHCLOCK_HPP
+#define BENCHCLOCK_HPP
+
+#include <cstddef>
+#include <string>
+
+// Wall-clock time in microseconds, shared by the ex00 benchmarks.
+double nowUs(void);
+
+// Prints one result row: the label, the mean time per item in
+// nanoseconds and a checksum of the timed work, which keeps the compiler
+// from dropping it.
+void report(const std::string& label, double elapsedUs, size_t count,
+	const char* unit, double checksum);
+
+#endif
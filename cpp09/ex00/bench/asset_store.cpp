@@ -0,0 +1,101 @@
+#include "AssetRateStore.hpp"
+#include "BenchClock.hpp"
+#include "RateTable.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Memory and lookup cost of the compressed multi-asset store against one
+// RateTable per asset, on random-walk histories at several densities.
+
+// The report label with the structure's size in KiB appended.
+static std::string withSize(const char* label, size_t bytes)
+{
+	std::ostringstream row;
+	row << std::left << std::setw(24) << label << std::right
+		<< std::setw(10) << bytes / 1024 << " KiB";
+	return row.str();
+}
+
+// Each asset has a sample on a day with probability `density` percent;
+// prices move in cents and sometimes stay put, like quoted rates.
+static void runCase(size_t assets, int days, int density, size_t queries)
+{
+	std::srand(42);
+	AssetRateStore store;
+	RateTable* tables = new RateTable[assets];
+	size_t samples = 0;
+	for (size_t asset = 0; asset < assets; asset++) {
+		store.addAsset(std::string(1, static_cast<char>('A' + asset % 26)) +
+			static_cast<char>('a' + asset / 26));
+		double rate = 10.0 + static_cast<double>(std::rand() % 100000);
+		for (int day = 0; day < days; day++) {
+			if (std::rand() % 100 >= density)
+				continue;
+			if (std::rand() % 4 != 0)
+				rate += static_cast<double>(std::rand() % 2001 - 1000) / 100.0;
+			if (rate < 0.01)
+				rate = 0.01;
+			store.append(asset, day, rate);
+			tables[asset].append(day, rate);
+			samples++;
+		}
+	}
+	store.finalize();
+	size_t tableBytes = 0;
+	for (size_t asset = 0; asset < assets; asset++) {
+		tables[asset].finalize();
+		tableBytes += tables[asset].size() * (sizeof(int) + sizeof(double));
+	}
+
+	size_t* queryAssets = new size_t[queries];
+	int* queryDays = new int[queries];
+	for (size_t i = 0; i < queries; i++) {
+		queryAssets[i] = static_cast<size_t>(std::rand()) % assets;
+		queryDays[i] = std::rand() % (days + 30);
+	}
+
+	std::cout << assets << " assets x " << days << " days, " << density
+		<< "% density (" << samples << " samples, " << store.rows() << " rows, "
+		<< queries << " queries)" << std::endl;
+
+	double sum = 0.0;
+	double start = nowUs();
+	for (size_t i = 0; i < queries; i++) {
+		double rate;
+		if (tables[queryAssets[i]].find(queryDays[i], rate))
+			sum += rate;
+	}
+	report(withSize("RateTable per asset", tableBytes), nowUs() - start, queries, "query", sum);
+
+	sum = 0.0;
+	start = nowUs();
+	for (size_t i = 0; i < queries; i++) {
+		double rate;
+		if (store.find(queryAssets[i], queryDays[i], rate))
+			sum += rate;
+	}
+	report(withSize("AssetRateStore", store.compressedBytes()), nowUs() - start, queries,
+		"query", sum);
+	delete[] tables;
+	delete[] queryAssets;
+	delete[] queryDays;
+}
+
+int main(int argc, char** argv)
+{
+	size_t queries = 1000000;
+	if (argc > 1)
+		queries = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (queries == 0)
+		queries = 1;
+
+	runCase(40, 5000, 100, queries);
+	runCase(40, 5000, 70, queries);
+	runCase(40, 5000, 20, queries);
+	runCase(200, 20000, 100, queries);
+	return 0;
+}
@@ -0,0 +1,69 @@
+#include "BenchClock.hpp"
+#include "RateTable.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// Per-query find() against findBatch() on sorted, nearly sorted and
+// shuffled batches, for batches denser and sparser than the table.
+
+static void runOrder(const char* order, const RateTable& table, const int* days, size_t count)
+{
+	double* rates = new double[count];
+	double sum = 0.0;
+	double start = nowUs();
+	for (size_t i = 0; i < count; i++) {
+		double rate;
+		if (table.find(days[i], rate))
+			sum += rate;
+	}
+	double elapsed = nowUs() - start;
+	std::cout << " " << order << std::endl;
+	report("find() per query", elapsed, count, "query", sum);
+
+	sum = 0.0;
+	start = nowUs();
+	size_t resolved = table.findBatch(days, count, rates);
+	for (size_t i = 0; i < resolved; i++)
+		sum += rates[i];
+	report("findBatch()", nowUs() - start, count, "query", sum);
+	delete[] rates;
+}
+
+static void runCase(const RateTable& table, size_t queries)
+{
+	int first = table.dayAt(0);
+	int span = table.dayAt(table.size() - 1) + 365 - first;
+	int* days = new int[queries];
+	std::srand(42);
+	for (size_t i = 0; i < queries; i++)
+		days[i] = first + static_cast<int>(std::rand() % span);
+	std::cout << table.size() << " rows, " << queries << " queries" << std::endl;
+
+	std::sort(days, days + queries);
+	runOrder("sorted", table, days, queries);
+	for (size_t i = 0; i + 1 < queries; i += 50)
+		std::swap(days[i], days[i + 1]);
+	runOrder("nearly sorted (1 swap per 50)", table, days, queries);
+	std::random_shuffle(days, days + queries);
+	runOrder("shuffled", table, days, queries);
+	delete[] days;
+}
+
+int main(int argc, char** argv)
+{
+	size_t rows = 4000000;
+	if (argc > 1)
+		rows = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (rows == 0)
+		rows = 1;
+
+	RateTable table;
+	for (size_t i = 0; i < rows; i++)
+		table.append(static_cast<int>(2 * i), 1.0 + static_cast<double>(i % 9973) * 0.25);
+	runCase(table, rows);
+	runCase(table, rows / 64 + 1);
+	return 0;
+}
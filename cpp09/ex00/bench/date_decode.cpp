@@ -0,0 +1,108 @@
+#include "BenchClock.hpp"
+#include "RateTable.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Per-line cost of the former validateDateFormat + isValidDate + dateToDay
+// sequence (three substr/atoi passes, run twice) against the single-pass
+// RateTable::decodeDate, on valid and invalid dates.
+
+static bool legacyValidate(const std::string& date)
+{
+	if (date.length() != 10 || date[4] != '-' || date[7] != '-')
+		return false;
+	for (int i = 0; i < 10; i++) {
+		if (i == 4 || i == 7)
+			continue;
+		if (!std::isdigit(static_cast<unsigned char>(date[i])))
+			return false;
+	}
+	int year = std::atoi(date.substr(0, 4).c_str());
+	int month = std::atoi(date.substr(5, 2).c_str());
+	int day = std::atoi(date.substr(8, 2).c_str());
+	if (year < 1 || month < 1 || month > 12)
+		return false;
+	int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	if ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)
+		daysInMonth[1] = 29;
+	return day >= 1 && day <= daysInMonth[month - 1];
+}
+
+static bool legacyDecode(const char* text, size_t length, int& day)
+{
+	std::string date(text, length);
+	if (!legacyValidate(date))
+		return false;
+	day = RateTable::dayNumber(std::atoi(date.substr(0, 4).c_str()),
+		std::atoi(date.substr(5, 2).c_str()), std::atoi(date.substr(8, 2).c_str()));
+	return true;
+}
+
+static void runCase(const char* title, const char* text, size_t lines)
+{
+	std::cout << title << " (" << lines << " lines)" << std::endl;
+
+	long sum = 0;
+	double start = nowUs();
+	for (size_t i = 0; i < lines; i++) {
+		int day;
+		if (legacyDecode(text + i * 10, 10, day))
+			sum += day;
+		else
+			sum--;
+	}
+	report("substr + atoi", nowUs() - start, lines, "line", sum);
+
+	sum = 0;
+	start = nowUs();
+	for (size_t i = 0; i < lines; i++) {
+		int day;
+		if (RateTable::decodeDate(text + i * 10, 10, day))
+			sum += day;
+		else
+			sum--;
+	}
+	report("RateTable::decodeDate", nowUs() - start, lines, "line", sum);
+}
+
+int main(int argc, char** argv)
+{
+	size_t lines = 2000000;
+	if (argc > 1)
+		lines = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (lines == 0)
+		lines = 1;
+
+	char* valid = new char[lines * 10];
+	char* mixed = new char[lines * 10];
+	std::srand(42);
+	for (size_t i = 0; i < lines; i++) {
+		int year = 2009 + std::rand() % 15;
+		int month = 1 + std::rand() % 12;
+		int day = 1 + std::rand() % 28;
+		char* line = valid + i * 10;
+		line[0] = static_cast<char>('0' + year / 1000);
+		line[1] = static_cast<char>('0' + year / 100 % 10);
+		line[2] = static_cast<char>('0' + year / 10 % 10);
+		line[3] = static_cast<char>('0' + year % 10);
+		line[4] = '-';
+		line[5] = static_cast<char>('0' + month / 10);
+		line[6] = static_cast<char>('0' + month % 10);
+		line[7] = '-';
+		line[8] = static_cast<char>('0' + day / 10);
+		line[9] = static_cast<char>('0' + day % 10);
+		std::copy(line, line + 10, mixed + i * 10);
+		if (std::rand() % 4 == 0)
+			mixed[i * 10 + std::rand() % 10] = (std::rand() % 2) ? 'x' : '9';
+	}
+	runCase("valid dates", valid, lines);
+	runCase("25% corrupted dates", mixed, lines);
+	delete[] valid;
+	delete[] mixed;
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "BenchClock.hpp"
+#include "DecimalParser.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Per-number cost of the original istringstream conversion, the strtod
+// call on a NUL-terminated copy that replaced it, and DecimalParser, on
+// values shaped like database rates and input amounts and on inputs that
+// need the exact comparison path.
+
+static bool streamParse(const std::string& text, double& value)
+{
+	std::istringstream stream(text);
+	stream >> value;
+	return !stream.fail() && stream.eof() && value - value == 0.0;
+}
+
+static bool copyParse(const std::string& text, double& value)
+{
+	char local[64];
+	std::string spill;
+	const char* copy = local;
+	if (text.size() < sizeof(local)) {
+		std::memcpy(local, text.data(), text.size());
+		local[text.size()] = '\0';
+	} else {
+		spill = text;
+		copy = spill.c_str();
+	}
+	char* end = NULL;
+	value = std::strtod(copy, &end);
+	return end == copy + text.size() && value - value == 0.0;
+}
+
+static void runCase(const char* title, const std::string* numbers, size_t count)
+{
+	std::cout << title << " (" << count << " numbers)" << std::endl;
+	double sum = 0.0;
+	double start = nowUs();
+	for (size_t i = 0; i < count; i++) {
+		double value;
+		if (streamParse(numbers[i], value))
+			sum += value;
+	}
+	report("istringstream >> double", nowUs() - start, count, "number", sum);
+
+	sum = 0.0;
+	start = nowUs();
+	for (size_t i = 0; i < count; i++) {
+		double value;
+		if (copyParse(numbers[i], value))
+			sum += value;
+	}
+	report("copy + strtod", nowUs() - start, count, "number", sum);
+
+	sum = 0.0;
+	start = nowUs();
+	for (size_t i = 0; i < count; i++) {
+		double value;
+		if (DecimalParser::parse(numbers[i].data(), numbers[i].size(), value))
+			sum += value;
+	}
+	report("DecimalParser::parse", nowUs() - start, count, "number", sum);
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = 1000000;
+	if (argc > 1)
+		count = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (count == 0)
+		count = 1;
+
+	std::srand(42);
+	std::string* rates = new std::string[count];
+	std::string* amounts = new std::string[count];
+	std::string* exact = new std::string[count];
+	for (size_t i = 0; i < count; i++) {
+		std::ostringstream rate;
+		rate << std::rand() % 70000 << '.' << std::setw(2) << std::setfill('0')
+			<< std::rand() % 100;
+		rates[i] = rate.str();
+		std::ostringstream amount;
+		amount << std::rand() % 1000;
+		if (i % 3 != 0)
+			amount << '.' << std::rand() % 1000;
+		amounts[i] = amount.str();
+		std::ostringstream digits;
+		digits << std::setprecision(17) << std::rand() / static_cast<double>(RAND_MAX) * 1e-300;
+		exact[i] = digits.str();
+	}
+	runCase("rates like data.csv", rates, count);
+	runCase("input amounts", amounts, count);
+	runCase("17 digits near 1e-300", exact, count);
+	delete[] rates;
+	delete[] amounts;
+	delete[] exact;
+	return 0;
+}
@@ -0,0 +1,234 @@
+#include "RateTable.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+
+// Writes synthetic inputs for btc. Output depends only on the arguments,
+// so benchmark runs on different machines price the same lines.
+//
+//   gen_data rates OUT [--rows=N] [--density=D] [--seed=S]
+//     N rates starting 2009-01-03; each calendar day has a rate with
+//     probability D (1 = daily).
+//   gen_data queries OUT --db=CSV [--lines=N] [--errors=E] [--order=O] [--seed=S]
+//     N query lines dated from 30 days before the first rate to a year
+//     after the last. A fraction E are errors, spread evenly over bad
+//     dates, missing separators, negative, too large and non-numeric
+//     values and dates before the first rate. O is random, sorted or
+//     reverse.
+
+static uint64_t g_state = 1;
+
+static uint32_t nextRandom(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return static_cast<uint32_t>(g_state >> 32);
+}
+
+static void seedRandom(unsigned long seed)
+{
+	g_state = (static_cast<uint64_t>(seed) << 1 | 1) * 2654435761u;
+	for (int i = 0; i < 8; i++)
+		nextRandom();
+}
+
+static double nextUnit(void)
+{
+	return nextRandom() / 4294967296.0;
+}
+
+static void formatDate(int days, char* text)
+{
+	days += 719468;
+	int era = (days >= 0 ? days : days - 146096) / 146097;
+	int dayOfEra = days - era * 146097;
+	int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524
+		- dayOfEra / 146096) / 365;
+	int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	int mp = (5 * dayOfYear + 2) / 153;
+	int day = dayOfYear - (153 * mp + 2) / 5 + 1;
+	int month = mp < 10 ? mp + 3 : mp - 9;
+	int year = yearOfEra + era * 400 + (month <= 2);
+	text[0] = static_cast<char>('0' + year / 1000 % 10);
+	text[1] = static_cast<char>('0' + year / 100 % 10);
+	text[2] = static_cast<char>('0' + year / 10 % 10);
+	text[3] = static_cast<char>('0' + year % 10);
+	text[4] = '-';
+	text[5] = static_cast<char>('0' + month / 10);
+	text[6] = static_cast<char>('0' + month % 10);
+	text[7] = '-';
+	text[8] = static_cast<char>('0' + day / 10);
+	text[9] = static_cast<char>('0' + day % 10);
+	text[10] = '\0';
+}
+
+static bool readOption(const char* argument, const char* name, std::string& value)
+{
+	size_t length = std::strlen(name);
+	if (std::strncmp(argument, name, length) != 0 || argument[length] != '=')
+		return false;
+	value = argument + length + 1;
+	return true;
+}
+
+static int writeRates(const char* path, unsigned long rows, double density)
+{
+	std::ofstream out(path, std::ios::out | std::ios::binary);
+	if (!out)
+		return 1;
+	out << "date,exchange_rate\n" << std::fixed << std::setprecision(2);
+	int day = RateTable::dayNumber(2009, 1, 3);
+	double rate = 0.3;
+	char date[11];
+	for (unsigned long written = 0; written < rows; day++) {
+		if (density < 1.0 && nextUnit() >= density)
+			continue;
+		rate *= 0.98 + 0.0405 * nextUnit();
+		if (rate < 0.01)
+			rate = 0.01;
+		if (rate > 100000.0)
+			rate = 100000.0;
+		formatDate(day, date);
+		out << date << ',' << rate << '\n';
+		written++;
+	}
+	return out ? 0 : 1;
+}
+
+static bool readRange(const char* path, int& first, int& last)
+{
+	std::ifstream in(path);
+	std::string line;
+	bool found = false;
+	while (std::getline(in, line)) {
+		int day;
+		if (line.size() < 10 || !RateTable::decodeDate(line.data(), 10, day))
+			continue;
+		if (!found || day < first)
+			first = day;
+		if (!found || day > last)
+			last = day;
+		found = true;
+	}
+	return found;
+}
+
+static void writeValue(std::ostream& out, int kind)
+{
+	switch (kind) {
+	case 2:
+		out << '-' << 1 + nextRandom() % 100;
+		break;
+	case 3:
+		out << 1001 + nextRandom() % 100000;
+		break;
+	case 4:
+		out << "12x";
+		break;
+	default:
+		if (nextRandom() % 4 == 0)
+			out << nextRandom() % 1001;
+		else
+			out << nextRandom() % 1000 << '.' << nextRandom() % 100;
+		break;
+	}
+}
+
+static int writeQueries(const char* path, const std::string& dbPath,
+	unsigned long lines, double errors, const std::string& order)
+{
+	int first = 0;
+	int last = 0;
+	if (!readRange(dbPath.c_str(), first, last)) {
+		std::cerr << "gen_data: no rates in " << dbPath << std::endl;
+		return 1;
+	}
+	first -= 30;
+	unsigned int span = static_cast<unsigned int>(last + 365 - first);
+	if (order != "sorted" && order != "reverse" && order != "random")
+		return 2;
+	int* days = new int[lines == 0 ? 1 : lines];
+	for (unsigned long i = 0; i < lines; i++)
+		days[i] = first + static_cast<int>(nextRandom() % span);
+	if (order != "random")
+		std::sort(days, days + lines);
+	if (order == "reverse")
+		std::reverse(days, days + lines);
+
+	std::ofstream out(path, std::ios::out | std::ios::binary);
+	if (!out) {
+		delete[] days;
+		return 1;
+	}
+	out << "date | value\n";
+	char date[11];
+	for (unsigned long i = 0; i < lines; i++) {
+		int kind = nextUnit() < errors ? 1 + static_cast<int>(nextRandom() % 6) : 0;
+		formatDate(kind == 6 ? first - 1 - static_cast<int>(nextRandom() % 1000) : days[i], date);
+		if (kind == 1) {
+			date[5] = '1';
+			date[6] = '3';
+		}
+		out << date << (kind == 5 ? " " : " | ");
+		writeValue(out, kind == 5 ? 0 : kind);
+		out << '\n';
+	}
+	delete[] days;
+	return out ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage: gen_data rates|queries OUT [options]" << std::endl;
+		return 2;
+	}
+	std::string mode = argv[1];
+	unsigned long count = mode == "rates" ? 5000 : 1000000;
+	double density = 1.0;
+	double errors = 0.1;
+	unsigned long seed = 1;
+	std::string order = "random";
+	std::string dbPath;
+	for (int i = 3; i < argc; i++) {
+		std::string value;
+		if (readOption(argv[i], "--rows", value) || readOption(argv[i], "--lines", value))
+			count = std::strtoul(value.c_str(), NULL, 10);
+		else if (readOption(argv[i], "--density", value))
+			density = std::strtod(value.c_str(), NULL);
+		else if (readOption(argv[i], "--errors", value))
+			errors = std::strtod(value.c_str(), NULL);
+		else if (readOption(argv[i], "--seed", value))
+			seed = std::strtoul(value.c_str(), NULL, 10);
+		else if (readOption(argv[i], "--order", value))
+			order = value;
+		else if (readOption(argv[i], "--db", value))
+			dbPath = value;
+		else {
+			std::cerr << "gen_data: unknown option " << argv[i] << std::endl;
+			return 2;
+		}
+	}
+	if (density <= 0.0 || density > 1.0 || errors < 0.0 || errors > 1.0) {
+		std::cerr << "gen_data: density must be in (0, 1], errors in [0, 1]" << std::endl;
+		return 2;
+	}
+	seedRandom(seed);
+	if (mode == "rates")
+		return writeRates(argv[2], count, density);
+	if (mode == "queries" && !dbPath.empty()) {
+		int status = writeQueries(argv[2], dbPath, count, errors, order);
+		if (status == 2)
+			std::cerr << "gen_data: order must be random, sorted or reverse" << std::endl;
+		return status;
+	}
+	std::cerr << "usage: gen_data rates|queries OUT [options]" << std::endl;
+	return 2;
+}
@@ -0,0 +1,155 @@
+#include "BenchClock.hpp"
+#include "LineScanner.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Splitting a generated input file into lines and " | " fields: the
+// original getline + std::string::find + trim loop, the memchr-per-line
+// path LineScanner replaced, and LineScanner with each kernel.
+
+// The report label with the scan throughput in MB/s appended.
+static std::string withThroughput(const char* label, double elapsedUs, size_t bytes)
+{
+	std::ostringstream row;
+	row << std::left << std::setw(28) << label << std::right << std::fixed
+		<< std::setprecision(0) << std::setw(6)
+		<< static_cast<double>(bytes) / elapsedUs << " MB/s";
+	return row.str();
+}
+
+static unsigned long splitGetline(const std::string& input)
+{
+	std::istringstream stream(input);
+	std::string line;
+	unsigned long sum = 0;
+	while (std::getline(stream, line)) {
+		size_t pipe = line.find(" | ");
+		if (pipe == std::string::npos)
+			continue;
+		std::string date = line.substr(0, pipe);
+		std::string value = line.substr(pipe + 3);
+		size_t first = value.find_first_not_of(" \t");
+		size_t last = value.find_last_not_of(" \t");
+		if (first != std::string::npos)
+			sum += date.size() + last - first + 1;
+		sum += pipe;
+	}
+	return sum;
+}
+
+static unsigned long splitMemchr(const std::string& input)
+{
+	const char* cursor = input.data();
+	const char* end = cursor + input.size();
+	unsigned long sum = 0;
+	while (cursor < end) {
+		const char* lineBegin = cursor;
+		const char* lineEnd = static_cast<const char*>(
+			std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+		if (lineEnd == NULL) {
+			lineEnd = end;
+			cursor = end;
+		} else {
+			cursor = lineEnd + 1;
+		}
+		if (lineEnd != lineBegin && lineEnd[-1] == '\r')
+			--lineEnd;
+		const char* separator = LineScanner::findSeparator(lineBegin, lineEnd);
+		if (separator != NULL)
+			sum += static_cast<unsigned long>(separator - lineBegin);
+		sum += static_cast<unsigned long>(lineEnd - lineBegin);
+	}
+	return sum;
+}
+
+static unsigned long splitScanner(const std::string& input, LineScanner::Kernel kernel)
+{
+	LineScanner scanner(input.data(), input.size(), kernel);
+	LineScanner::Line lines[256];
+	unsigned long sum = 0;
+	size_t count;
+	while ((count = scanner.next(lines, 256)) > 0) {
+		for (size_t i = 0; i < count; i++) {
+			if (lines[i].separator != NULL)
+				sum += static_cast<unsigned long>(lines[i].separator - lines[i].begin);
+			sum += static_cast<unsigned long>(lines[i].end - lines[i].begin);
+		}
+	}
+	return sum;
+}
+
+int main(int argc, char** argv)
+{
+	size_t lines = 2000000;
+	if (argc > 1)
+		lines = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (lines == 0)
+		lines = 1;
+
+	std::string input;
+	std::srand(42);
+	for (size_t i = 0; i < lines; i++) {
+		char line[64];
+		int length = 0;
+		int year = 2009 + std::rand() % 14;
+		int month = 1 + std::rand() % 12;
+		int day = 1 + std::rand() % 28;
+		int kind = std::rand() % 10;
+		line[length++] = static_cast<char>('0' + year / 1000);
+		line[length++] = static_cast<char>('0' + year / 100 % 10);
+		line[length++] = static_cast<char>('0' + year / 10 % 10);
+		line[length++] = static_cast<char>('0' + year % 10);
+		line[length++] = '-';
+		line[length++] = static_cast<char>('0' + month / 10);
+		line[length++] = static_cast<char>('0' + month % 10);
+		line[length++] = '-';
+		line[length++] = static_cast<char>('0' + day / 10);
+		line[length++] = static_cast<char>('0' + day % 10);
+		if (kind != 0) {
+			std::memcpy(line + length, " | ", 3);
+			length += 3;
+		}
+		int value = std::rand() % 1200;
+		if (value >= 100)
+			line[length++] = static_cast<char>('0' + value / 100);
+		if (value >= 10)
+			line[length++] = static_cast<char>('0' + value / 10 % 10);
+		line[length++] = static_cast<char>('0' + value % 10);
+		if (kind == 1) {
+			std::memcpy(line + length, ".25", 3);
+			length += 3;
+		}
+		line[length++] = '\n';
+		input.append(line, static_cast<size_t>(length));
+	}
+	std::cout << "input: " << lines << " lines, " << input.size() << " bytes" << std::endl;
+
+	double start = nowUs();
+	unsigned long sum = splitGetline(input);
+	double elapsed = nowUs() - start;
+	report(withThroughput("getline + string::find", elapsed, input.size()), elapsed, lines,
+		"line", sum);
+
+	start = nowUs();
+	sum = splitMemchr(input);
+	elapsed = nowUs() - start;
+	report(withThroughput("memchr per line", elapsed, input.size()), elapsed, lines, "line", sum);
+
+	const LineScanner::Kernel kernels[] = { LineScanner::SCALAR, LineScanner::SSE2, LineScanner::AVX2 };
+	const char* const names[] = { "LineScanner scalar", "LineScanner SSE2", "LineScanner AVX2" };
+	for (size_t k = 0; k < 3; k++) {
+		if (!LineScanner::supports(kernels[k]))
+			continue;
+		start = nowUs();
+		sum = splitScanner(input, kernels[k]);
+		elapsed = nowUs() - start;
+		report(withThroughput(names[k], elapsed, input.size()), elapsed, lines,
+			"line", sum);
+	}
+	return 0;
+}
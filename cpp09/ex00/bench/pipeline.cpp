@@ -0,0 +1,246 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// End-to-end runs of ./btc on inputs written by bench/gen_data, timed by
+// btc's own --stats report. Each scenario runs RUNS times; the best load
+// time and throughput are shown with the largest peak RSS. Generated
+// files are kept in bench/data and reused, so repeated runs price exactly
+// the same lines.
+
+static const int RUNS = 3;
+static const char* const DATA_DIR = "bench/data";
+static const size_t MAX_ARGUMENTS = 10;
+
+struct Scenario {
+	const char* name;
+	unsigned long rows;
+	const char* density;
+	const char* errors;
+	const char* order;
+	const char* threads;
+};
+
+// rows == 0 prices against the shipped data.csv.
+static const Scenario SCENARIOS[] = {
+	{ "data.csv, random", 0, "1", "0.1", "random", "1" },
+	{ "daily 5k, sorted", 5000, "1", "0.1", "sorted", "1" },
+	{ "daily 5k, reverse", 5000, "1", "0.1", "reverse", "1" },
+	{ "sparse 200k, half errors", 200000, "0.2", "0.5", "random", "1" },
+	{ "daily 1M, random", 1000000, "1", "0.1", "random", "1" },
+	{ "daily 5k, 4 threads", 5000, "1", "0.1", "random", "4" }
+};
+
+// A child's argv; no command here needs more than MAX_ARGUMENTS words.
+struct Command {
+	std::string words[MAX_ARGUMENTS];
+	size_t count;
+
+	Command(void) : count(0) {
+	}
+
+	void add(const std::string& word) {
+		words[count++] = word;
+	}
+};
+
+struct Result {
+	double loadMs;
+	double seconds;
+	unsigned long lines;
+	unsigned long bytes;
+	long peakKb;
+};
+
+static bool fileExists(const std::string& path)
+{
+	struct stat info;
+	return stat(path.c_str(), &info) == 0;
+}
+
+// Runs argv[0] with stdout discarded and stderr collected into `errors`.
+static bool runCommand(const Command& command, std::string& errors, long& peakKb)
+{
+	char* argv[MAX_ARGUMENTS + 1];
+	for (size_t i = 0; i < command.count; i++)
+		argv[i] = const_cast<char*>(command.words[i].c_str());
+	argv[command.count] = NULL;
+
+	int pipeFds[2];
+	if (pipe(pipeFds) != 0)
+		return false;
+	pid_t child = fork();
+	if (child < 0) {
+		close(pipeFds[0]);
+		close(pipeFds[1]);
+		return false;
+	}
+	if (child == 0) {
+		int null = open("/dev/null", O_WRONLY);
+		dup2(null, STDOUT_FILENO);
+		dup2(pipeFds[1], STDERR_FILENO);
+		close(pipeFds[0]);
+		execv(argv[0], argv);
+		_exit(127);
+	}
+	close(pipeFds[1]);
+	char buffer[4096];
+	ssize_t count;
+	errors.clear();
+	while ((count = read(pipeFds[0], buffer, sizeof(buffer))) != 0) {
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count < 0)
+			break;
+		errors.append(buffer, static_cast<size_t>(count));
+	}
+	close(pipeFds[0]);
+	int status;
+	struct rusage usage;
+	while (wait4(child, &status, 0, &usage) < 0 && errno == EINTR) {
+	}
+	peakKb = usage.ru_maxrss;
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static bool parseStats(const std::string& report, Result& result)
+{
+	std::istringstream lines(report);
+	std::string line;
+	bool load = false;
+	bool input = false;
+	while (std::getline(lines, line)) {
+		if (std::sscanf(line.c_str(), "stats: load %lf ms", &result.loadMs) == 1)
+			load = true;
+		if (std::sscanf(line.c_str(), "stats: input %lu lines, %lu bytes in %lf s",
+				&result.lines, &result.bytes, &result.seconds) == 3)
+			input = true;
+	}
+	return load && input;
+}
+
+static bool generate(const std::string& path, const Command& command)
+{
+	if (fileExists(path))
+		return true;
+	std::string errors;
+	long peakKb;
+	if (runCommand(command, errors, peakKb))
+		return true;
+	std::cerr << errors;
+	std::remove(path.c_str());
+	return false;
+}
+
+static bool prepare(const Scenario& scenario, unsigned long lines,
+	std::string& dbPath, std::string& inputPath)
+{
+	std::ostringstream name;
+	dbPath = "data.csv";
+	if (scenario.rows != 0) {
+		name << DATA_DIR << "/rates_" << scenario.rows << '_' << scenario.density << ".csv";
+		dbPath = name.str();
+		Command command;
+		command.add("bench/gen_data");
+		command.add("rates");
+		command.add(dbPath);
+		std::ostringstream rows;
+		rows << "--rows=" << scenario.rows;
+		command.add(rows.str());
+		command.add(std::string("--density=") + scenario.density);
+		if (!generate(dbPath, command))
+			return false;
+	}
+	std::ostringstream input;
+	input << DATA_DIR << "/queries_" << scenario.rows << '_' << scenario.density << '_'
+		<< lines << '_' << scenario.errors << '_' << scenario.order << ".txt";
+	inputPath = input.str();
+	std::ostringstream count;
+	count << "--lines=" << lines;
+	Command command;
+	command.add("bench/gen_data");
+	command.add("queries");
+	command.add(inputPath);
+	command.add("--db=" + dbPath);
+	command.add(count.str());
+	command.add(std::string("--errors=") + scenario.errors);
+	command.add(std::string("--order=") + scenario.order);
+	command.add("--seed=2");
+	return generate(inputPath, command);
+}
+
+static bool runScenario(const Scenario& scenario, unsigned long lines)
+{
+	std::string dbPath;
+	std::string inputPath;
+	if (!prepare(scenario, lines, dbPath, inputPath)) {
+		std::cerr << "pipeline: could not generate data for " << scenario.name << std::endl;
+		return false;
+	}
+	Command command;
+	command.add("./btc");
+	command.add("--stats");
+	command.add(std::string("--threads=") + scenario.threads);
+	command.add("--db=" + dbPath);
+	command.add(inputPath);
+
+	Result best = Result();
+	for (int run = 0; run < RUNS; run++) {
+		std::string errors;
+		long peakKb;
+		Result result;
+		if (!runCommand(command, errors, peakKb) || !parseStats(errors, result)) {
+			std::cerr << "pipeline: ./btc failed for " << scenario.name << '\n' << errors;
+			return false;
+		}
+		if (run == 0 || result.loadMs < best.loadMs)
+			best.loadMs = result.loadMs;
+		if (run == 0 || result.seconds < best.seconds) {
+			best.seconds = result.seconds;
+			best.lines = result.lines;
+			best.bytes = result.bytes;
+		}
+		if (peakKb > best.peakKb)
+			best.peakKb = peakKb;
+	}
+	double seconds = best.seconds > 0 ? best.seconds : 1e-9;
+	std::cout << "  " << std::left << std::setw(28) << scenario.name << std::right
+		<< std::fixed << std::setprecision(2) << std::setw(9) << best.loadMs << " ms"
+		<< std::setprecision(0) << std::setw(11) << best.lines / seconds << " lines/s"
+		<< std::setprecision(1) << std::setw(7) << best.bytes / seconds / 1e6 << " MB/s"
+		<< std::setw(8) << best.peakKb << " KiB peak" << std::endl;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long lines = 1000000;
+	if (argc > 1)
+		lines = std::strtoul(argv[1], NULL, 10);
+	if (lines == 0)
+		lines = 1;
+	if (!fileExists("./btc") || !fileExists("bench/gen_data")) {
+		std::cerr << "pipeline: run from cpp09/ex00 after building btc and bench/gen_data"
+			<< std::endl;
+		return 1;
+	}
+	mkdir(DATA_DIR, 0755);
+
+	std::cout << "btc end to end (" << lines << " lines, best of " << RUNS << " runs)"
+		<< std::endl;
+	for (size_t i = 0; i < sizeof(SCENARIOS) / sizeof(SCENARIOS[0]); i++) {
+		if (!runScenario(SCENARIOS[i], lines))
+			return 1;
+	}
+	return 0;
+}
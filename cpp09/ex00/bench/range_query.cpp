@@ -0,0 +1,85 @@
+#include "BenchClock.hpp"
+#include "RateTable.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// Range average/min/max by looping over the table, as callers did before,
+// against the RateTable range queries with and without the range index.
+
+static void runCase(size_t rows, size_t queries)
+{
+	RateTable scanned;
+	double rate = 100.0;
+	std::srand(42);
+	for (size_t i = 0; i < rows; i++) {
+		rate += static_cast<double>(std::rand() % 2001 - 1000) / 100.0;
+		if (rate < 1.0)
+			rate = 1.0;
+		scanned.append(static_cast<int>(i), rate);
+	}
+	scanned.finalize();
+	RateTable indexed(scanned);
+	double start = nowUs();
+	indexed.buildRangeIndex();
+	double buildUs = nowUs() - start;
+
+	int* from = new int[queries];
+	int* to = new int[queries];
+	for (size_t i = 0; i < queries; i++) {
+		from[i] = std::rand() % static_cast<int>(rows);
+		to[i] = from[i] + std::rand() % static_cast<int>(rows - static_cast<size_t>(from[i]));
+	}
+	std::cout << rows << " rows, ranges of " << rows / 3 << " rows on average ("
+		<< queries << " queries, index built in " << std::setprecision(1) << std::fixed
+		<< buildUs / 1000.0 << " ms)" << std::endl;
+
+	double sum = 0.0;
+	start = nowUs();
+	for (size_t i = 0; i < queries; i++) {
+		double total = 0.0;
+		double low = scanned.rateAt(static_cast<size_t>(from[i]));
+		double high = low;
+		for (int day = from[i]; day <= to[i]; day++) {
+			double value = scanned.rateAt(static_cast<size_t>(day));
+			total += value;
+			low = value < low ? value : low;
+			high = value > high ? value : high;
+		}
+		sum += total / (to[i] - from[i] + 1) + low + high;
+	}
+	report("loop with double sum", nowUs() - start, queries, "query", sum);
+
+	const RateTable* tables[2] = { &scanned, &indexed };
+	const char* labels[2] = { "exact scan (no index)", "range index" };
+	for (int t = 0; t < 2; t++) {
+		sum = 0.0;
+		start = nowUs();
+		for (size_t i = 0; i < queries; i++) {
+			double average;
+			double low;
+			double high;
+			tables[t]->rangeAverage(from[i], to[i], average);
+			tables[t]->rangeMinimum(from[i], to[i], low);
+			tables[t]->rangeMaximum(from[i], to[i], high);
+			sum += average + low + high;
+		}
+		report(labels[t], nowUs() - start, queries, "query", sum);
+	}
+	delete[] from;
+	delete[] to;
+}
+
+int main(int argc, char** argv)
+{
+	size_t queries = 2000;
+	if (argc > 1)
+		queries = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (queries == 0)
+		queries = 1;
+
+	runCase(1600, queries * 10);
+	runCase(1000000, queries);
+	return 0;
+}
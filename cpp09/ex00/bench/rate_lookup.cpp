@@ -0,0 +1,155 @@
+#include "BenchClock.hpp"
+#include "BitcoinExchange.hpp"
+#include "RateTable.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Compares the former std::map<std::string, double> lookup with the flat
+// RateTable, with and without its calendar index, on the same random dates.
+
+static std::string dayToDate(int days)
+{
+	days += 719468;
+	int era = (days >= 0 ? days : days - 146096) / 146097;
+	int dayOfEra = days - era * 146097;
+	int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524
+		- dayOfEra / 146096) / 365;
+	int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	int mp = (5 * dayOfYear + 2) / 153;
+	int day = dayOfYear - (153 * mp + 2) / 5 + 1;
+	int month = mp < 10 ? mp + 3 : mp - 9;
+	int year = yearOfEra + era * 400 + (month <= 2);
+	char text[11];
+	text[0] = static_cast<char>('0' + year / 1000 % 10);
+	text[1] = static_cast<char>('0' + year / 100 % 10);
+	text[2] = static_cast<char>('0' + year / 10 % 10);
+	text[3] = static_cast<char>('0' + year % 10);
+	text[4] = '-';
+	text[5] = static_cast<char>('0' + month / 10);
+	text[6] = static_cast<char>('0' + month % 10);
+	text[7] = '-';
+	text[8] = static_cast<char>('0' + day / 10);
+	text[9] = static_cast<char>('0' + day % 10);
+	text[10] = '\0';
+	return std::string(text);
+}
+
+static bool mapLookup(const std::map<std::string, double>& rates,
+	const std::string& date, double& rate)
+{
+	std::map<std::string, double>::const_iterator it = rates.find(date);
+	if (it != rates.end()) {
+		rate = it->second;
+		return true;
+	}
+	it = rates.lower_bound(date);
+	if (it == rates.begin())
+		return false;
+	--it;
+	rate = it->second;
+	return true;
+}
+
+static void runCase(const char* title, const std::map<std::string, double>& map,
+	const RateTable& table, const BitcoinExchange* exchange, size_t queries)
+{
+	int first = table.dayAt(0) - 30;
+	int span = table.dayAt(table.size() - 1) + 365 - first;
+	std::string* dates = new std::string[queries];
+	int* days = new int[queries];
+	std::srand(42);
+	for (size_t i = 0; i < queries; i++) {
+		days[i] = first + static_cast<int>(std::rand() % span);
+		dates[i] = dayToDate(days[i]);
+	}
+
+	std::cout << title << " (" << table.size() << " rows, "
+		<< queries << " queries)" << std::endl;
+
+	double sum = 0.0;
+	double start = nowUs();
+	for (size_t i = 0; i < queries; i++) {
+		double rate;
+		if (mapLookup(map, dates[i], rate))
+			sum += rate;
+	}
+	report("std::map<string> find+lb", nowUs() - start, queries, "query", sum);
+
+	if (exchange != NULL) {
+		sum = 0.0;
+		start = nowUs();
+		for (size_t i = 0; i < queries; i++) {
+			try {
+				sum += exchange->getExchangeRate(dates[i]);
+			} catch (const BitcoinExchange::InvalidValueException&) {
+			}
+		}
+		report("getExchangeRate(string)", nowUs() - start, queries, "query", sum);
+	}
+
+	sum = 0.0;
+	start = nowUs();
+	for (size_t i = 0; i < queries; i++) {
+		double rate;
+		if (table.find(days[i], rate))
+			sum += rate;
+	}
+	report("RateTable::find(day)", nowUs() - start, queries, "query", sum);
+
+	RateTable dense(table);
+	if (dense.buildDenseIndex(16)) {
+		sum = 0.0;
+		start = nowUs();
+		for (size_t i = 0; i < queries; i++) {
+			double rate;
+			if (dense.find(days[i], rate))
+				sum += rate;
+		}
+		report("RateTable dense index", nowUs() - start, queries, "query", sum);
+	}
+
+	delete[] dates;
+	delete[] days;
+}
+
+int main(int argc, char** argv)
+{
+	size_t queries = 2000000;
+	if (argc > 1)
+		queries = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (queries == 0)
+		queries = 1;
+
+	BitcoinExchange exchange;
+	exchange.loadDatabase("data.csv");
+	std::map<std::string, double> csvMap;
+	RateTable csvTable;
+	std::ifstream csv("data.csv");
+	std::string line;
+	std::getline(csv, line);
+	while (std::getline(csv, line)) {
+		std::string date = line.substr(0, 10);
+		double rate = std::strtod(line.c_str() + 11, NULL);
+		csvMap[date] = rate;
+		csvTable.append(RateTable::dayNumber(std::atoi(date.substr(0, 4).c_str()),
+			std::atoi(date.substr(5, 2).c_str()), std::atoi(date.substr(8, 2).c_str())), rate);
+	}
+	csvTable.finalize();
+	runCase("data.csv", csvMap, csvTable, &exchange, queries);
+
+	std::map<std::string, double> bigMap;
+	RateTable bigTable;
+	int base = RateTable::dayNumber(1000, 1, 1);
+	for (int i = 0; i < 1000000; i++) {
+		double rate = 1.0 + (i % 9973) * 0.25;
+		bigMap.insert(bigMap.end(), std::make_pair(dayToDate(base + 2 * i), rate));
+		bigTable.append(base + 2 * i, rate);
+	}
+	runCase("synthetic", bigMap, bigTable, NULL, queries);
+	return 0;
+}
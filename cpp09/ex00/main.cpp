@@ -1,18 +1,79 @@
 #include "BitcoinExchange.hpp"
 
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <string>
+
+// Options start with "--" and come before the input file: --threads=N,
+// --no-dense-index, --snapshot=PATH, --db=PATH, --stats. An input of "-"
+// reads standard input. --stats reports timings and line counts on
+// standard error.
+static bool applyOption(BitcoinExchange& exchange, const std::string& option,
+	std::string& databasePath, std::string& snapshotPath) {
+	if (option.compare(0, 10, "--threads=") == 0) {
+		const char* digits = option.c_str() + 10;
+		// strtoul takes a sign and would wrap "-1" to ULONG_MAX.
+		if (*digits < '0' || *digits > '9')
+			return false;
+		char* end = NULL;
+		unsigned long threads = std::strtoul(digits, &end, 10);
+		if (*end != '\0' || threads == 0)
+			return false;
+		exchange.setThreadCount(threads);
+		return true;
+	}
+	if (option == "--no-dense-index") {
+		exchange.setDenseIndex(false);
+		return true;
+	}
+	if (option.compare(0, 11, "--snapshot=") == 0 && option.size() > 11) {
+		snapshotPath = option.substr(11);
+		return true;
+	}
+	if (option.compare(0, 5, "--db=") == 0 && option.size() > 5) {
+		databasePath = option.substr(5);
+		return true;
+	}
+	if (option == "--stats") {
+		exchange.setStatistics(true);
+		return true;
+	}
+	return false;
+}
+
+static bool isOption(const char* argument) {
+	return argument[0] == '-' && argument[1] == '-';
+}
 
 int main(int argc, char** argv) {
-	if (argc != 2) {
+	int input = 1;
+	while (input < argc - 1 && isOption(argv[input]))
+		input++;
+	if (input != argc - 1) {
 		std::cerr << "Error: could not open file." << std::endl;
 		return 1;
 	}
 	
 	try {
 		BitcoinExchange exchange;
-		exchange.loadDatabase("data.csv");
-		exchange.processInput(argv[1]);
+		std::string databasePath = "data.csv";
+		std::string snapshotPath;
+		for (int i = 1; i < input; i++) {
+			if (!applyOption(exchange, argv[i], databasePath, snapshotPath)) {
+				std::cerr << "Error: invalid option: " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		if (snapshotPath.empty()) {
+			exchange.loadDatabase(databasePath);
+		} else {
+			exchange.loadDatabase(databasePath, snapshotPath);
+		}
+		exchange.processInput(argv[argc - 1]);
+		if (exchange.statisticsEnabled()) {
+			exchange.statistics().print(std::cerr);
+		}
 	} catch (const BitcoinExchange::FileException&) {
 		std::cerr << "Error: could not open file." << std::endl;
 		return 1;
@@ -23,6 +84,3 @@ int main(int argc, char** argv) {
 	
 	return 0;
 }
-
-
-
@@ -0,0 +1,453 @@
+#include "BigInt.hpp"
+
+#include <algorithm>
+
+static const uint64_t LIMB_BASE = static_cast<uint64_t>(1) << 32;
+static const uint32_t DECIMAL_CHUNK = 1000000000;
+static const int DECIMAL_CHUNK_DIGITS = 9;
+
+static size_t trimmedSize(const uint32_t* limbs, size_t size) {
+	while (size > 0 && limbs[size - 1] == 0)
+		size--;
+	return size;
+}
+
+static int compareMagnitudes(const uint32_t* left, size_t leftSize,
+	const uint32_t* right, size_t rightSize) {
+	if (leftSize != rightSize)
+		return leftSize < rightSize ? -1 : 1;
+	for (size_t i = leftSize; i-- > 0;) {
+		if (left[i] != right[i])
+			return left[i] < right[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+// The helpers below write magnitudes into caller-sized buffers and
+// return the trimmed size, so that small operands stay in BigInt's
+// inline storage. Only Karatsuba and long division need scratch space.
+
+// sum needs max(leftSize, rightSize) + 1 limbs.
+static size_t addMagnitudes(const uint32_t* left, size_t leftSize,
+	const uint32_t* right, size_t rightSize, uint32_t* sum) {
+	if (leftSize < rightSize) {
+		std::swap(left, right);
+		std::swap(leftSize, rightSize);
+	}
+	uint64_t carry = 0;
+	for (size_t i = 0; i < leftSize; i++) {
+		uint64_t total = static_cast<uint64_t>(left[i]) + (i < rightSize ? right[i] : 0) + carry;
+		sum[i] = static_cast<uint32_t>(total);
+		carry = total >> 32;
+	}
+	sum[leftSize] = static_cast<uint32_t>(carry);
+	return trimmedSize(sum, leftSize + 1);
+}
+
+// left - right for left >= right; difference needs leftSize limbs.
+static size_t subtractMagnitudes(const uint32_t* left, size_t leftSize,
+	const uint32_t* right, size_t rightSize, uint32_t* difference) {
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < leftSize; i++) {
+		uint64_t subtrahend = static_cast<uint64_t>(i < rightSize ? right[i] : 0) + borrow;
+		uint64_t minuend = left[i];
+		borrow = minuend < subtrahend ? 1 : 0;
+		difference[i] = static_cast<uint32_t>(minuend + (borrow << 32) - subtrahend);
+	}
+	return trimmedSize(difference, leftSize);
+}
+
+// Adds part into target starting at limb `offset`; target is long enough.
+static void addInto(uint32_t* target, size_t offset, const uint32_t* part, size_t partSize) {
+	uint64_t carry = 0;
+	size_t i = 0;
+	for (; i < partSize; i++) {
+		uint64_t total = static_cast<uint64_t>(target[offset + i]) + part[i] + carry;
+		target[offset + i] = static_cast<uint32_t>(total);
+		carry = total >> 32;
+	}
+	for (; carry != 0; i++) {
+		uint64_t total = static_cast<uint64_t>(target[offset + i]) + carry;
+		target[offset + i] = static_cast<uint32_t>(total);
+		carry = total >> 32;
+	}
+}
+
+// target -= part, for target >= part.
+static void subtractFrom(uint32_t* target, size_t targetSize, const uint32_t* part, size_t partSize) {
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < targetSize && (i < partSize || borrow != 0); i++) {
+		uint64_t subtrahend = static_cast<uint64_t>(i < partSize ? part[i] : 0) + borrow;
+		uint64_t minuend = target[i];
+		borrow = minuend < subtrahend ? 1 : 0;
+		target[i] = static_cast<uint32_t>(minuend + (borrow << 32) - subtrahend);
+	}
+}
+
+// product needs leftSize + rightSize limbs.
+static size_t schoolbook(const uint32_t* left, size_t leftSize,
+	const uint32_t* right, size_t rightSize, uint32_t* product) {
+	if (leftSize == 0 || rightSize == 0)
+		return 0;
+	std::fill(product, product + leftSize + rightSize, 0);
+	for (size_t i = 0; i < leftSize; i++) {
+		uint64_t carry = 0;
+		uint64_t factor = left[i];
+		for (size_t j = 0; j < rightSize; j++) {
+			uint64_t total = factor * right[j] + product[i + j] + carry;
+			product[i + j] = static_cast<uint32_t>(total);
+			carry = total >> 32;
+		}
+		product[i + rightSize] = static_cast<uint32_t>(carry);
+	}
+	return trimmedSize(product, leftSize + rightSize);
+}
+
+// Karatsuba: with x = x1 B^m + x0 and y = y1 B^m + y0, x y is
+// z2 B^2m + z1 B^m + z0 where z0 = x0 y0, z2 = x1 y1 and
+// z1 = (x0 + x1)(y0 + y1) - z0 - z2: three half-size products instead of
+// four. Lopsided operands are multiplied a slice of the longer at a time.
+// product needs leftSize + rightSize limbs.
+static size_t multiplyMagnitudes(const uint32_t* left, size_t leftSize,
+	const uint32_t* right, size_t rightSize, uint32_t* product) {
+	if (leftSize < rightSize) {
+		std::swap(left, right);
+		std::swap(leftSize, rightSize);
+	}
+	if (rightSize < BigInt::KARATSUBA_LIMBS)
+		return schoolbook(left, leftSize, right, rightSize, product);
+
+	std::fill(product, product + leftSize + rightSize, 0);
+	if (rightSize * 2 <= leftSize) {
+		uint32_t* part = new uint32_t[rightSize * 2]();
+		try {
+			for (size_t offset = 0; offset < leftSize; offset += rightSize) {
+				size_t slice = std::min(rightSize, leftSize - offset);
+				size_t partSize = multiplyMagnitudes(left + offset,
+					trimmedSize(left + offset, slice), right, rightSize, part);
+				addInto(product, offset, part, partSize);
+			}
+		} catch (...) {
+			delete[] part;
+			throw;
+		}
+		delete[] part;
+		return trimmedSize(product, leftSize + rightSize);
+	}
+
+	size_t half = leftSize / 2;
+	size_t leftLow = trimmedSize(left, half);
+	size_t rightLow = trimmedSize(right, half);
+	size_t leftHigh = leftSize - half;
+	size_t rightHigh = rightSize - half;
+	// The two sums and their product share one scratch allocation.
+	size_t leftSumCapacity = std::max(half, leftHigh) + 1;
+	size_t rightSumCapacity = std::max(half, rightHigh) + 1;
+	uint32_t* leftSum = new uint32_t[(leftSumCapacity + rightSumCapacity) * 2 + 1]();
+	uint32_t* rightSum = leftSum + leftSumCapacity;
+	uint32_t* middle = rightSum + rightSumCapacity;
+	try {
+		size_t leftSumSize = addMagnitudes(left, leftLow, left + half, leftHigh, leftSum);
+		size_t rightSumSize = addMagnitudes(right, rightLow, right + half, rightHigh, rightSum);
+		size_t middleSize = multiplyMagnitudes(leftSum, leftSumSize,
+			rightSum, rightSumSize, middle);
+
+		// z0 and z2 go straight into their places in the product.
+		size_t lowSize = multiplyMagnitudes(left, leftLow, right, rightLow, product);
+		size_t highSize = multiplyMagnitudes(left + half, leftHigh, right + half, rightHigh,
+			product + half * 2);
+		subtractFrom(middle, middleSize, product, lowSize);
+		subtractFrom(middle, middleSize, product + half * 2, highSize);
+		addInto(product, half, middle, trimmedSize(middle, middleSize));
+	} catch (...) {
+		delete[] leftSum;
+		throw;
+	}
+	delete[] leftSum;
+	return trimmedSize(product, leftSize + rightSize);
+}
+
+static int leadingZeros(uint32_t value) {
+	int count = 0;
+	for (uint32_t bit = static_cast<uint32_t>(1) << 31; (value & bit) == 0; bit >>= 1)
+		count++;
+	return count;
+}
+
+// Divides in place and returns the remainder.
+static uint32_t divideBySmall(uint32_t* dividend, size_t& size, uint32_t divisor) {
+	uint64_t remainder = 0;
+	for (size_t i = size; i-- > 0;) {
+		uint64_t current = remainder << 32 | dividend[i];
+		dividend[i] = static_cast<uint32_t>(current / divisor);
+		remainder = current % divisor;
+	}
+	size = trimmedSize(dividend, size);
+	return static_cast<uint32_t>(remainder);
+}
+
+// Knuth's algorithm D. quotient needs dividendSize limbs; the divisor is
+// nonzero.
+static size_t divideMagnitudes(const uint32_t* dividend, size_t dividendSize,
+	const uint32_t* divisor, size_t divisorSize, uint32_t* quotient) {
+	if (compareMagnitudes(dividend, dividendSize, divisor, divisorSize) < 0)
+		return 0;
+	if (divisorSize == 1) {
+		std::copy(dividend, dividend + dividendSize, quotient);
+		divideBySmall(quotient, dividendSize, divisor[0]);
+		return dividendSize;
+	}
+
+	// Shift both so the divisor's top limb has its high bit set.
+	uint32_t smallScratch[4 * BigInt::INLINE_LIMBS + 1];
+	uint32_t* largeScratch = NULL;
+	uint32_t* v = smallScratch;
+	if (divisorSize + dividendSize + 1 > sizeof(smallScratch) / sizeof(smallScratch[0])) {
+		largeScratch = new uint32_t[divisorSize + dividendSize + 1]();
+		v = largeScratch;
+	}
+	uint32_t* u = v + divisorSize;
+	int shift = leadingZeros(divisor[divisorSize - 1]);
+	for (size_t i = divisorSize; i-- > 0;) {
+		uint64_t wide = static_cast<uint64_t>(divisor[i]) << shift;
+		if (i > 0)
+			wide |= static_cast<uint64_t>(divisor[i - 1]) << shift >> 32;
+		v[i] = static_cast<uint32_t>(wide);
+	}
+	u[dividendSize] = static_cast<uint32_t>(static_cast<uint64_t>(dividend[dividendSize - 1]) << shift >> 32);
+	for (size_t i = dividendSize; i-- > 0;) {
+		uint64_t wide = static_cast<uint64_t>(dividend[i]) << shift;
+		if (i > 0)
+			wide |= static_cast<uint64_t>(dividend[i - 1]) << shift >> 32;
+		u[i] = static_cast<uint32_t>(wide);
+	}
+
+	size_t quotientSize = dividendSize - divisorSize + 1;
+	uint64_t top = v[divisorSize - 1];
+	uint64_t next = v[divisorSize - 2];
+	for (size_t j = quotientSize; j-- > 0;) {
+		uint64_t numerator = static_cast<uint64_t>(u[j + divisorSize]) << 32 | u[j + divisorSize - 1];
+		uint64_t estimate = numerator / top;
+		uint64_t rest = numerator % top;
+		while (estimate >= LIMB_BASE
+			|| estimate * next > (rest << 32 | u[j + divisorSize - 2])) {
+			estimate--;
+			rest += top;
+			if (rest >= LIMB_BASE)
+				break;
+		}
+
+		int64_t borrow = 0;
+		for (size_t i = 0; i < divisorSize; i++) {
+			uint64_t product = estimate * v[i];
+			int64_t total = static_cast<int64_t>(u[i + j]) - borrow
+				- static_cast<int64_t>(product & 0xFFFFFFFFu);
+			u[i + j] = static_cast<uint32_t>(total);
+			borrow = static_cast<int64_t>(product >> 32) - (total >> 32);
+		}
+		int64_t total = static_cast<int64_t>(u[j + divisorSize]) - borrow;
+		u[j + divisorSize] = static_cast<uint32_t>(total);
+
+		quotient[j] = static_cast<uint32_t>(estimate);
+		if (total < 0) {
+			// The estimate was one too large: add the divisor back.
+			quotient[j]--;
+			uint64_t carry = 0;
+			for (size_t i = 0; i < divisorSize; i++) {
+				uint64_t sum = static_cast<uint64_t>(u[i + j]) + v[i] + carry;
+				u[i + j] = static_cast<uint32_t>(sum);
+				carry = sum >> 32;
+			}
+			u[j + divisorSize] = static_cast<uint32_t>(u[j + divisorSize] + carry);
+		}
+	}
+	delete[] largeScratch;
+	return trimmedSize(quotient, quotientSize);
+}
+
+BigInt::BigInt(void) : _limbs(_inline), _size(0), _capacity(INLINE_LIMBS), _negative(false) {
+}
+
+BigInt::BigInt(int value) : _limbs(_inline), _size(0), _capacity(INLINE_LIMBS), _negative(value < 0) {
+	// Negating in unsigned arithmetic keeps INT_MIN well defined.
+	uint32_t magnitude = static_cast<uint32_t>(value);
+	if (_negative)
+		magnitude = 0u - magnitude;
+	_inline[0] = magnitude;
+	_size = magnitude != 0 ? 1 : 0;
+}
+
+BigInt::BigInt(const BigInt& other)
+	: _limbs(_inline), _size(0), _capacity(INLINE_LIMBS), _negative(false) {
+	assign(other._limbs, other._size, other._negative);
+}
+
+BigInt& BigInt::operator=(const BigInt& other) {
+	if (this != &other) {
+		assign(other._limbs, other._size, other._negative);
+	}
+	return *this;
+}
+
+BigInt::~BigInt(void) {
+	if (_limbs != _inline)
+		delete[] _limbs;
+}
+
+const char* BigInt::DivisionByZeroException::what() const throw() {
+	return "Division by zero";
+}
+
+void BigInt::reserve(size_t capacity) {
+	if (capacity <= _capacity)
+		return;
+	uint32_t* limbs = new uint32_t[capacity];
+	std::copy(_limbs, _limbs + _size, limbs);
+	if (_limbs != _inline)
+		delete[] _limbs;
+	_limbs = limbs;
+	_capacity = capacity;
+}
+
+void BigInt::assign(const uint32_t* limbs, size_t size, bool negative) {
+	reserve(size);
+	std::copy(limbs, limbs + size, _limbs);
+	_size = size;
+	_negative = negative;
+	trim();
+}
+
+void BigInt::trim(void) {
+	_size = trimmedSize(_limbs, _size);
+	if (_size == 0)
+		_negative = false;
+}
+
+// Same-sign operands add magnitudes; otherwise the smaller magnitude is
+// taken from the larger and the result has the larger one's sign.
+BigInt BigInt::operator+(const BigInt& other) const {
+	BigInt result;
+	if (_negative == other._negative) {
+		result.reserve(std::max(_size, other._size) + 1);
+		result._size = addMagnitudes(_limbs, _size, other._limbs, other._size, result._limbs);
+		result._negative = _negative;
+	} else if (compareMagnitudes(_limbs, _size, other._limbs, other._size) >= 0) {
+		result.reserve(_size);
+		result._size = subtractMagnitudes(_limbs, _size, other._limbs, other._size, result._limbs);
+		result._negative = _negative;
+	} else {
+		result.reserve(other._size);
+		result._size = subtractMagnitudes(other._limbs, other._size, _limbs, _size, result._limbs);
+		result._negative = other._negative;
+	}
+	result.trim();
+	return result;
+}
+
+BigInt BigInt::operator-(const BigInt& other) const {
+	BigInt negated(other);
+	negated._negative = !negated._negative;
+	negated.trim();
+	return *this + negated;
+}
+
+BigInt BigInt::operator*(const BigInt& other) const {
+	BigInt result;
+	result.reserve(_size + other._size);
+	result._size = multiplyMagnitudes(_limbs, _size, other._limbs, other._size, result._limbs);
+	result._negative = _negative != other._negative;
+	result.trim();
+	return result;
+}
+
+BigInt BigInt::operator/(const BigInt& other) const {
+	if (other.isZero())
+		throw DivisionByZeroException();
+	BigInt result;
+	result.reserve(_size);
+	result._size = divideMagnitudes(_limbs, _size, other._limbs, other._size, result._limbs);
+	result._negative = _negative != other._negative;
+	result.trim();
+	return result;
+}
+
+bool BigInt::operator==(const BigInt& other) const {
+	return _negative == other._negative
+		&& compareMagnitudes(_limbs, _size, other._limbs, other._size) == 0;
+}
+
+bool BigInt::operator!=(const BigInt& other) const {
+	return !(*this == other);
+}
+
+bool BigInt::operator<(const BigInt& other) const {
+	if (_negative != other._negative)
+		return _negative;
+	int order = compareMagnitudes(_limbs, _size, other._limbs, other._size);
+	return _negative ? order > 0 : order < 0;
+}
+
+bool BigInt::isZero(void) const {
+	return _size == 0;
+}
+
+bool BigInt::isNegative(void) const {
+	return _negative;
+}
+
+bool BigInt::isInline(void) const {
+	return _limbs == _inline;
+}
+
+size_t BigInt::limbCount(void) const {
+	return _size;
+}
+
+// Peels off nine decimal digits per division by 10^9; each limb yields
+// less than two chunks.
+std::string BigInt::toString(void) const {
+	if (_size == 0)
+		return "0";
+	uint32_t* rest = new uint32_t[_size * 3];
+	uint32_t* chunks = rest + _size;
+	std::copy(_limbs, _limbs + _size, rest);
+	size_t restSize = _size;
+	size_t chunkCount = 0;
+	while (restSize > 0)
+		chunks[chunkCount++] = divideBySmall(rest, restSize, DECIMAL_CHUNK);
+	std::string text;
+	try {
+		text.reserve(chunkCount * DECIMAL_CHUNK_DIGITS + 1);
+		if (_negative)
+			text += '-';
+		for (size_t i = chunkCount; i-- > 0;) {
+			char digits[DECIMAL_CHUNK_DIGITS];
+			uint32_t chunk = chunks[i];
+			for (int d = DECIMAL_CHUNK_DIGITS; d-- > 0;) {
+				digits[d] = static_cast<char>('0' + chunk % 10);
+				chunk /= 10;
+			}
+			int first = 0;
+			if (i == chunkCount - 1) {
+				while (first < DECIMAL_CHUNK_DIGITS - 1 && digits[first] == '0')
+					first++;
+			}
+			text.append(digits + first, digits + DECIMAL_CHUNK_DIGITS);
+		}
+	} catch (...) {
+		delete[] rest;
+		throw;
+	}
+	delete[] rest;
+	return text;
+}
+
+// The product without Karatsuba, as a reference for tests and benchmarks.
+BigInt BigInt::schoolbookProduct(const BigInt& left, const BigInt& right) {
+	BigInt result;
+	result.reserve(left._size + right._size);
+	result._size = schoolbook(left._limbs, left._size, right._limbs, right._size, result._limbs);
+	result._negative = left._negative != right._negative;
+	result.trim();
+	return result;
+}
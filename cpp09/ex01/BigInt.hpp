@@ -0,0 +1,60 @@
+#ifndef BIGINT_HPP
+#define BIGINT_HPP
+
+#include <cstddef>
+#include <exception>
+#include <stdint.h>
+#include <string>
+
+// Signed integer of any size: a sign and a magnitude in 32-bit limbs,
+// least significant first, without leading zero limbs. Magnitudes of up
+// to INLINE_LIMBS limbs live inside the object, so values the size of
+// int products never touch the heap. Multiplication switches from the
+// schoolbook method to Karatsuba once both operands reach
+// KARATSUBA_LIMBS limbs. Division truncates toward zero, like int.
+class BigInt {
+public:
+	static const size_t INLINE_LIMBS = 4;
+	static const size_t KARATSUBA_LIMBS = 32;
+
+private:
+	uint32_t _inline[INLINE_LIMBS];
+	uint32_t* _limbs;
+	size_t _size;
+	size_t _capacity;
+	bool _negative;
+
+	void reserve(size_t capacity);
+	void assign(const uint32_t* limbs, size_t size, bool negative);
+	void trim(void);
+
+public:
+	BigInt(void);
+	BigInt(int value);
+	BigInt(const BigInt& other);
+	BigInt& operator=(const BigInt& other);
+	~BigInt(void);
+
+	BigInt operator+(const BigInt& other) const;
+	BigInt operator-(const BigInt& other) const;
+	BigInt operator*(const BigInt& other) const;
+	BigInt operator/(const BigInt& other) const;
+	bool operator==(const BigInt& other) const;
+	bool operator!=(const BigInt& other) const;
+	bool operator<(const BigInt& other) const;
+
+	bool isZero(void) const;
+	bool isNegative(void) const;
+	bool isInline(void) const;
+	size_t limbCount(void) const;
+	std::string toString(void) const;
+
+	static BigInt schoolbookProduct(const BigInt& left, const BigInt& right);
+
+	class DivisionByZeroException : public std::exception {
+	public:
+		virtual const char* what() const throw();
+	};
+};
+
+#endif
@@ -0,0 +1,67 @@
+#include "CheckedInt.hpp"
+
+#include <climits>
+#include <stdint.h>
+
+#if !defined(CHECKEDINT_PORTABLE)
+# if defined(__clang__) && defined(__has_builtin)
+#  if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_mul_overflow)
+#   define CHECKEDINT_BUILTINS
+#  endif
+# elif defined(__GNUC__) && __GNUC__ >= 5
+#  define CHECKEDINT_BUILTINS
+# endif
+#endif
+
+#ifdef CHECKEDINT_BUILTINS
+
+bool checkedAdd(int left, int right, int& result) {
+	return !__builtin_add_overflow(left, right, &result);
+}
+
+bool checkedSubtract(int left, int right, int& result) {
+	return !__builtin_sub_overflow(left, right, &result);
+}
+
+bool checkedMultiply(int left, int right, int& result) {
+	return !__builtin_mul_overflow(left, right, &result);
+}
+
+#else
+
+static bool fitsInt(int64_t value) {
+	return value >= INT_MIN && value <= INT_MAX;
+}
+
+bool checkedAdd(int left, int right, int& result) {
+	int64_t value = static_cast<int64_t>(left) + right;
+	if (!fitsInt(value))
+		return false;
+	result = static_cast<int>(value);
+	return true;
+}
+
+bool checkedSubtract(int left, int right, int& result) {
+	int64_t value = static_cast<int64_t>(left) - right;
+	if (!fitsInt(value))
+		return false;
+	result = static_cast<int>(value);
+	return true;
+}
+
+bool checkedMultiply(int left, int right, int& result) {
+	int64_t value = static_cast<int64_t>(left) * right;
+	if (!fitsInt(value))
+		return false;
+	result = static_cast<int>(value);
+	return true;
+}
+
+#endif
+
+bool checkedDivide(int left, int right, int& result) {
+	if (right == 0 || (left == INT_MIN && right == -1))
+		return false;
+	result = left / right;
+	return true;
+}
@@ -0,0 +1,18 @@
+#ifndef CHECKEDINT_HPP
+#define CHECKEDINT_HPP
+
+// int arithmetic that reports overflow instead of producing it. Each
+// function stores the result and returns true, or returns false with
+// `result` unspecified. GCC 5+ and Clang use the checked-arithmetic
+// builtins, which compile to the operation and one branch on the
+// overflow flag; other compilers, or CHECKEDINT_PORTABLE, compute in 64
+// bits and range-check.
+bool checkedAdd(int left, int right, int& result);
+bool checkedSubtract(int left, int right, int& result);
+bool checkedMultiply(int left, int right, int& result);
+
+// Division that fails on a zero divisor and on INT_MIN / -1, the one
+// quotient outside int; the caller tells the two apart by `right`.
+bool checkedDivide(int left, int right, int& result);
+
+#endif
@@ -0,0 +1,67 @@
+#include "OperandStack.hpp"
+
+#include <algorithm>
+
+OperandStack::OperandStack(void)
+	: _values(_inline), _size(0), _capacity(INLINE_CAPACITY) {
+}
+
+OperandStack::OperandStack(const OperandStack& other)
+	: _values(_inline), _size(0), _capacity(INLINE_CAPACITY) {
+	*this = other;
+}
+
+OperandStack& OperandStack::operator=(const OperandStack& other) {
+	if (this != &other) {
+		reserve(other._size);
+		std::copy(other._values, other._values + other._size, _values);
+		_size = other._size;
+	}
+	return *this;
+}
+
+OperandStack::~OperandStack(void) {
+	if (_values != _inline)
+		delete[] _values;
+}
+
+bool OperandStack::empty(void) const {
+	return _size == 0;
+}
+
+size_t OperandStack::size(void) const {
+	return _size;
+}
+
+size_t OperandStack::capacity(void) const {
+	return _capacity;
+}
+
+void OperandStack::reserve(size_t capacity) {
+	if (capacity <= _capacity)
+		return;
+	int* values = new int[capacity];
+	std::copy(_values, _values + _size, values);
+	if (_values != _inline)
+		delete[] _values;
+	_values = values;
+	_capacity = capacity;
+}
+
+int& OperandStack::back(void) {
+	return _values[_size - 1];
+}
+
+const int& OperandStack::back(void) const {
+	return _values[_size - 1];
+}
+
+void OperandStack::push_back(const int& value) {
+	if (_size == _capacity)
+		reserve(_capacity * 2);
+	_values[_size++] = value;
+}
+
+void OperandStack::pop_back(void) {
+	_size--;
+}
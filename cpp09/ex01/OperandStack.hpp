@@ -0,0 +1,43 @@
+#ifndef OPERANDSTACK_HPP
+#define OPERANDSTACK_HPP
+
+#include <cstddef>
+
+// Contiguous sequence of ints, the container behind the std::stack that
+// holds RPN operands. The first INLINE_CAPACITY values live inside the
+// object, so short expressions never allocate; beyond that the array
+// doubles. Popping keeps the capacity, so one RPN reuses the storage for
+// every expression it evaluates. Provides what std::stack needs from its
+// container, under the std::vector names.
+class OperandStack {
+public:
+	typedef int value_type;
+	typedef size_t size_type;
+	typedef int& reference;
+	typedef const int& const_reference;
+
+	static const size_t INLINE_CAPACITY = 32;
+
+private:
+	int _inline[INLINE_CAPACITY];
+	int* _values;
+	size_t _size;
+	size_t _capacity;
+
+public:
+	OperandStack(void);
+	OperandStack(const OperandStack& other);
+	OperandStack& operator=(const OperandStack& other);
+	~OperandStack(void);
+
+	bool empty(void) const;
+	size_t size(void) const;
+	size_t capacity(void) const;
+	void reserve(size_t capacity);
+	int& back(void);
+	const int& back(void) const;
+	void push_back(const int& value);
+	void pop_back(void);
+};
+
+#endif
@@ -1,18 +1,20 @@
 #include "RPN.hpp"
+#include "CheckedInt.hpp"
 
 #include <cctype>
-#include <climits>
 #include <sstream>
 
 RPN::RPN(void) {
 }
 
-RPN::RPN(const RPN& other) : _operands(other._operands) {
+RPN::RPN(const RPN& other)
+	: _operands(other._operands), _bignumOperands(other._bignumOperands) {
 }
 
 RPN& RPN::operator=(const RPN& other) {
 	if (this != &other) {
 		_operands = other._operands;
+		_bignumOperands = other._bignumOperands;
 	}
 	return *this;
 }
@@ -47,55 +49,172 @@ bool RPN::isNumber(const std::string& token) const {
 		std::isdigit(static_cast<unsigned char>(token[0]));
 }
 
-int RPN::performOperation(int left, int right, const std::string& op) const {
+RPN::Operator RPN::decodeOperator(char c) {
+	switch (c) {
+	case '+':
+		return ADD;
+	case '-':
+		return SUBTRACT;
+	case '*':
+		return MULTIPLY;
+	case '/':
+		return DIVIDE;
+	default:
+		return NOT_OPERATOR;
+	}
+}
+
+RPN::Status RPN::performOperation(int left, int right, Operator op, int& result) const {
+	switch (op) {
+	case ADD:
+		return checkedAdd(left, right, result) ? OK : INTEGER_OVERFLOW;
+	case SUBTRACT:
+		return checkedSubtract(left, right, result) ? OK : INTEGER_OVERFLOW;
+	case MULTIPLY:
+		return checkedMultiply(left, right, result) ? OK : INTEGER_OVERFLOW;
+	default:
+		if (right == 0)
+			return DIVISION_BY_ZERO;
+		return checkedDivide(left, right, result) ? OK : INTEGER_OVERFLOW;
+	}
+}
+
+// Same operators without a range limit; only division by zero fails.
+BigInt RPN::performOperation(const BigInt& left, const BigInt& right, const std::string& op) const {
 	if (op == "+") {
-		double result = static_cast<double>(left) + right;
-		if (result < INT_MIN || result > INT_MAX)
-			throw InvalidExpressionException("Integer overflow");
-		return static_cast<int>(result);
+		return left + right;
 	} else if (op == "-") {
-		double result = static_cast<double>(left) - right;
-		if (result < INT_MIN || result > INT_MAX)
-			throw InvalidExpressionException("Integer overflow");
-		return static_cast<int>(result);
+		return left - right;
 	} else if (op == "*") {
-		double result = static_cast<double>(left) * right;
-		if (result < INT_MIN || result > INT_MAX)
-			throw InvalidExpressionException("Integer overflow");
-		return static_cast<int>(result);
+		return left * right;
 	} else if (op == "/") {
-		if (right == 0) {
+		if (right.isZero()) {
 			throw DivisionByZeroException();
 		}
-		if (left == INT_MIN && right == -1)
-			throw InvalidExpressionException("Integer overflow");
 		return left / right;
 	} else {
 		throw InvalidExpressionException("Unknown operator: " + op);
 	}
 }
 
-void RPN::processToken(const std::string& token) {
+RPN::Status RPN::processToken(const char* token, size_t length) {
+	char c = token[0];
+	if (length != 1) {
+		return INVALID_TOKEN;
+	}
+	if (std::isdigit(static_cast<unsigned char>(c))) {
+		_operands.push(c - '0');
+		return OK;
+	}
+	Operator op = decodeOperator(c);
+	if (op == NOT_OPERATOR) {
+		return INVALID_TOKEN;
+	}
+	if (_operands.size() < 2) {
+		return INSUFFICIENT_OPERANDS;
+	}
+	
+	int operand2 = _operands.top();
+	_operands.pop();
+	int& operand1 = _operands.top();
+	return performOperation(operand1, operand2, op, operand1);
+}
+
+void RPN::processBignumToken(const std::string& token) {
 	if (isNumber(token)) {
-		_operands.push(token[0] - '0');
+		_bignumOperands.push(BigInt(token[0] - '0'));
 	} else if (isOperator(token)) {
-		if (_operands.size() < 2) {
+		if (_bignumOperands.size() < 2) {
 			throw InsufficientOperandsException();
 		}
 		
-		int operand2 = _operands.top();
-		_operands.pop();
-		int operand1 = _operands.top();
-		_operands.pop();
+		BigInt operand2 = _bignumOperands.top();
+		_bignumOperands.pop();
+		BigInt operand1 = _bignumOperands.top();
+		_bignumOperands.pop();
 		
-		int result = performOperation(operand1, operand2, token);
-		_operands.push(result);
+		_bignumOperands.push(performOperation(operand1, operand2, token));
 	} else {
 		throw InvalidExpressionException("Invalid token: " + token);
 	}
 }
 
+// Throws the exception matching a tryEvaluate() status; the offending
+// token runs from `position` to the next space.
+static void throwStatus(RPN::Status status, const std::string& expression, size_t position) {
+	switch (status) {
+	case RPN::EMPTY_EXPRESSION:
+		throw RPN::InvalidExpressionException("Empty expression");
+	case RPN::INVALID_TOKEN: {
+		size_t end = position;
+		while (end < expression.size() && !std::isspace(static_cast<unsigned char>(expression[end])))
+			end++;
+		throw RPN::InvalidExpressionException("Invalid token: " + expression.substr(position, end - position));
+	}
+	case RPN::INSUFFICIENT_OPERANDS:
+		throw RPN::InsufficientOperandsException();
+	case RPN::DIVISION_BY_ZERO:
+		throw RPN::DivisionByZeroException();
+	case RPN::INTEGER_OVERFLOW:
+		throw RPN::InvalidExpressionException("Integer overflow");
+	default:
+		throw RPN::InvalidExpressionException("Invalid expression");
+	}
+}
+
 int RPN::evaluate(const std::string& expression) {
+	int result = 0;
+	size_t position;
+	Status status = tryEvaluate(expression, result, position);
+	if (status != OK) {
+		throwStatus(status, expression, position);
+	}
+	return result;
+}
+
+// Same grammar and checks as evaluate(), reported without exceptions:
+// on error `position` is the offset of the offending token, or the
+// length of the expression when operands are left over at the end.
+// Tokens are split on whitespace like `istringstream >> token`.
+RPN::Status RPN::tryEvaluate(const std::string& expression, int& result, size_t& position) {
+	reset();
+	position = 0;
+	
+	if (expression.empty()) {
+		return EMPTY_EXPRESSION;
+	}
+	
+	const char* text = expression.data();
+	size_t length = expression.size();
+	size_t i = 0;
+	
+	while (i < length) {
+		if (std::isspace(static_cast<unsigned char>(text[i]))) {
+			i++;
+			continue;
+		}
+		size_t start = i;
+		while (i < length && !std::isspace(static_cast<unsigned char>(text[i])))
+			i++;
+		Status status = processToken(text + start, i - start);
+		if (status != OK) {
+			position = start;
+			return status;
+		}
+	}
+	
+	if (_operands.size() != 1) {
+		position = length;
+		return INVALID_EXPRESSION;
+	}
+	
+	result = _operands.top();
+	return OK;
+}
+
+// Same grammar and errors as evaluate(), except that results of any size
+// are exact instead of failing with "Integer overflow".
+BigInt RPN::evaluateBignum(const std::string& expression) {
 	reset();
 	
 	if (expression.empty()) {
@@ -106,19 +225,21 @@ int RPN::evaluate(const std::string& expression) {
 	std::string token;
 	
 	while (iss >> token) {
-		processToken(token);
+		processBignumToken(token);
 	}
 	
-	if (_operands.size() != 1) {
+	if (_bignumOperands.size() != 1) {
 		throw InvalidExpressionException("Invalid expression");
 	}
 	
-	int result = _operands.top();
-	return result;
+	return _bignumOperands.top();
 }
 
 void RPN::reset(void) {
 	while (!_operands.empty()) {
 		_operands.pop();
 	}
+	while (!_bignumOperands.empty()) {
+		_bignumOperands.pop();
+	}
 }
@@ -1,19 +1,47 @@
 #ifndef RPN_HPP
 #define RPN_HPP
 
+#include "BigInt.hpp"
+#include "OperandStack.hpp"
+
 #include <exception>
 #include <list>
 #include <stack>
 #include <string>
 
 class RPN {
+public:
+	// Outcome of tryEvaluate(); each error matches one exception of
+	// evaluate().
+	enum Status {
+		OK,
+		EMPTY_EXPRESSION,
+		INVALID_TOKEN,
+		INSUFFICIENT_OPERANDS,
+		DIVISION_BY_ZERO,
+		INTEGER_OVERFLOW,
+		INVALID_EXPRESSION
+	};
+
 private:
-	std::stack<int, std::list<int> > _operands;
+	enum Operator {
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE,
+		NOT_OPERATOR
+	};
+
+	std::stack<int, OperandStack> _operands;
+	std::stack<BigInt, std::list<BigInt> > _bignumOperands;
 	
 	bool isOperator(const std::string& token) const;
 	bool isNumber(const std::string& token) const;
-	int performOperation(int left, int right, const std::string& op) const;
-	void processToken(const std::string& token);
+	static Operator decodeOperator(char c);
+	Status performOperation(int left, int right, Operator op, int& result) const;
+	BigInt performOperation(const BigInt& left, const BigInt& right, const std::string& op) const;
+	Status processToken(const char* token, size_t length);
+	void processBignumToken(const std::string& token);
 	void reset(void);
 
 public:
@@ -23,6 +51,8 @@ public:
 	~RPN(void);
 	
 	int evaluate(const std::string& expression);
+	Status tryEvaluate(const std::string& expression, int& result, size_t& position);
+	BigInt evaluateBignum(const std::string& expression);
 
 	class InvalidExpressionException : public std::exception {
 	private:
@@ -0,0 +1,230 @@
+#include "RPNBatch.hpp"
+#include "OutputBuffer.hpp"
+#include "RPN.hpp"
+#include "TaskFailure.hpp"
+
+#include <pthread.h>
+#include <string>
+
+// Round hand-off between run() and the workers. run() bumps `generation`
+// to start a round and waits on `done` until `pending` drops to zero.
+struct WorkerPool {
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	unsigned long generation;
+	size_t pending;
+	bool stop;
+};
+
+struct RPNBatch::Task {
+	WorkerPool* pool;
+	const std::string* lines;
+	size_t begin;
+	size_t end;
+	RPN calculator;
+	OutputBuffer output;
+	size_t failed;
+	TaskFailure failure;
+};
+
+RPNBatch::RPNBatch(void) : _threadCount(1) {
+}
+
+RPNBatch::RPNBatch(const RPNBatch& other) : _threadCount(other._threadCount) {
+}
+
+RPNBatch& RPNBatch::operator=(const RPNBatch& other) {
+	if (this != &other) {
+		_threadCount = other._threadCount;
+	}
+	return *this;
+}
+
+RPNBatch::~RPNBatch(void) {
+}
+
+void RPNBatch::setThreadCount(size_t threads) {
+	if (threads < 1) {
+		threads = 1;
+	}
+	if (threads > MAX_THREADS) {
+		threads = MAX_THREADS;
+	}
+	_threadCount = threads;
+}
+
+size_t RPNBatch::threadCount(void) const {
+	return _threadCount;
+}
+
+// Evaluation errors come back as statuses and become "Error" lines;
+// an exception (out of memory) is recorded in the task and rethrown by
+// run() once the round is over.
+void RPNBatch::runTask(Task& task) {
+	try {
+		for (size_t i = task.begin; i < task.end; i++) {
+			int result;
+			size_t position;
+			if (task.calculator.tryEvaluate(task.lines[i], result, position) == RPN::OK) {
+				task.output << result << '\n';
+			} else {
+				task.output << "Error\n";
+				task.failed++;
+			}
+		}
+	} catch (const std::exception& error) {
+		task.failure.capture(error);
+	} catch (...) {
+		task.failure.captureUnknown();
+	}
+}
+
+// Runs its task once per round until run() sets `stop`.
+void* RPNBatch::runWorker(void* argument) {
+	Task* task = static_cast<Task*>(argument);
+	WorkerPool* pool = task->pool;
+	unsigned long seen = 0;
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (!pool->stop && pool->generation == seen)
+			pthread_cond_wait(&pool->work, &pool->lock);
+		if (pool->stop)
+			break;
+		seen = pool->generation;
+		pthread_mutex_unlock(&pool->lock);
+		runTask(*task);
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->pending == 0)
+			pthread_cond_signal(&pool->done);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+// Reads up to `capacity` lines, without their '\r\n' or '\n'.
+static size_t readRound(std::istream& in, std::string* lines, size_t capacity) {
+	size_t count = 0;
+	while (count < capacity && std::getline(in, lines[count])) {
+		std::string& line = lines[count];
+		if (!line.empty() && line[line.size() - 1] == '\r')
+			line.erase(line.size() - 1);
+		count++;
+	}
+	return count;
+}
+
+static void startRound(WorkerPool& pool, size_t workers) {
+	pthread_mutex_lock(&pool.lock);
+	pool.pending = workers;
+	pool.generation++;
+	pthread_cond_broadcast(&pool.work);
+	pthread_mutex_unlock(&pool.lock);
+}
+
+static void awaitRound(WorkerPool& pool) {
+	pthread_mutex_lock(&pool.lock);
+	while (pool.pending > 0)
+		pthread_cond_wait(&pool.done, &pool.lock);
+	pthread_mutex_unlock(&pool.lock);
+}
+
+// Lets a round in flight finish, then ends and joins the started workers.
+static void stopWorkers(WorkerPool& pool, pthread_t* threads, const bool* started, size_t count) {
+	awaitRound(pool);
+	pthread_mutex_lock(&pool.lock);
+	pool.stop = true;
+	pthread_cond_broadcast(&pool.work);
+	pthread_mutex_unlock(&pool.lock);
+	for (size_t i = 0; i < count; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+	}
+}
+
+size_t RPNBatch::run(std::istream& in, std::ostream& out) {
+	OutputBuffer sink(out);
+	size_t capacity = _threadCount * ROUND_LINES;
+	std::string* buffers[2] = { NULL, NULL };
+	Task* tasks = NULL;
+	pthread_t* threads = NULL;
+	bool* started = NULL;
+	size_t spawned = 0;
+	size_t failed = 0;
+	WorkerPool pool;
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.work, NULL);
+	pthread_cond_init(&pool.done, NULL);
+	pool.generation = 0;
+	pool.pending = 0;
+	pool.stop = false;
+	try {
+		buffers[0] = new std::string[capacity];
+		buffers[1] = new std::string[capacity];
+		tasks = new Task[_threadCount];
+		threads = new pthread_t[_threadCount];
+		started = new bool[_threadCount];
+		for (size_t i = 0; i < _threadCount; i++)
+			started[i] = false;
+		// A worker that fails to start has its slice run here instead.
+		size_t workers = 0;
+		for (spawned = 0; spawned < _threadCount; spawned++) {
+			tasks[spawned].pool = &pool;
+			started[spawned] = pthread_create(&threads[spawned], NULL, runWorker, &tasks[spawned]) == 0;
+			workers += started[spawned];
+		}
+		
+		size_t current = 0;
+		size_t count = readRound(in, buffers[current], capacity);
+		while (count > 0) {
+			for (size_t i = 0; i < _threadCount; i++) {
+				tasks[i].lines = buffers[current];
+				tasks[i].begin = count * i / _threadCount;
+				tasks[i].end = count * (i + 1) / _threadCount;
+				tasks[i].output.clear();
+				tasks[i].failed = 0;
+				tasks[i].failure.clear();
+			}
+			startRound(pool, workers);
+			size_t next = 0;
+			if (count == capacity)
+				next = readRound(in, buffers[1 - current], capacity);
+			for (size_t i = 0; i < _threadCount; i++) {
+				if (!started[i])
+					runTask(tasks[i]);
+			}
+			awaitRound(pool);
+			
+			for (size_t i = 0; i < _threadCount; i++) {
+				tasks[i].failure.rethrow();
+				sink.write(tasks[i].output.data(), tasks[i].output.size());
+				failed += tasks[i].failed;
+			}
+			sink.flush();
+			current = 1 - current;
+			count = next;
+		}
+	} catch (...) {
+		if (started != NULL)
+			stopWorkers(pool, threads, started, spawned);
+		pthread_cond_destroy(&pool.done);
+		pthread_cond_destroy(&pool.work);
+		pthread_mutex_destroy(&pool.lock);
+		delete[] buffers[0];
+		delete[] buffers[1];
+		delete[] tasks;
+		delete[] threads;
+		delete[] started;
+		throw;
+	}
+	stopWorkers(pool, threads, started, spawned);
+	pthread_cond_destroy(&pool.done);
+	pthread_cond_destroy(&pool.work);
+	pthread_mutex_destroy(&pool.lock);
+	delete[] buffers[0];
+	delete[] buffers[1];
+	delete[] tasks;
+	delete[] threads;
+	delete[] started;
+	return failed;
+}
@@ -0,0 +1,42 @@
+#ifndef RPNBATCH_HPP
+#define RPNBATCH_HPP
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+// Evaluates newline-separated expressions and writes one line per
+// expression, in input order: the result, or "Error" for an expression
+// RPN::evaluate rejects. A fixed pool of worker threads lives for the
+// whole run. Input is read in rounds of up to ROUND_LINES lines per
+// thread into one of two buffers: while the workers evaluate a round,
+// one contiguous slice each with their own RPN into their own buffer, the
+// calling thread reads the next round into the other buffer, then writes
+// the finished round out in slice order.
+class RPNBatch {
+public:
+	static const size_t MAX_THREADS = 64;
+	static const size_t ROUND_LINES = 16384;
+
+private:
+	struct Task;
+
+	size_t _threadCount;
+
+	static void runTask(Task& task);
+	static void* runWorker(void* argument);
+
+public:
+	RPNBatch(void);
+	RPNBatch(const RPNBatch& other);
+	RPNBatch& operator=(const RPNBatch& other);
+	~RPNBatch(void);
+
+	void setThreadCount(size_t threads);
+	size_t threadCount(void) const;
+
+	// Returns the number of expressions that failed.
+	size_t run(std::istream& in, std::ostream& out);
+};
+
+#endif
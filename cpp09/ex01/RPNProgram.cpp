@@ -0,0 +1,570 @@
+#include "RPNProgram.hpp"
+#include "CheckedInt.hpp"
+#include "RPN.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+RPNProgram::RPNProgram(void)
+	: _code(NULL), _codeSize(0), _arguments(NULL), _argumentCount(0), _variables(NULL),
+	_variableCount(0), _maxDepth(0), _stack(NULL), _lanes(NULL) {
+}
+
+RPNProgram::RPNProgram(const RPNProgram& other)
+	: _code(NULL), _codeSize(0), _arguments(NULL), _argumentCount(0), _variables(NULL),
+	_variableCount(0), _maxDepth(0), _stack(NULL), _lanes(NULL) {
+	try {
+		allocate(other._codeSize, other._argumentCount, other._variableCount, other._maxDepth);
+		std::copy(other._code, other._code + _codeSize, _code);
+		std::copy(other._arguments, other._arguments + _argumentCount, _arguments);
+		std::copy(other._variables, other._variables + _variableCount, _variables);
+	} catch (...) {
+		release();
+		throw;
+	}
+}
+
+RPNProgram& RPNProgram::operator=(const RPNProgram& other) {
+	if (this != &other) {
+		RPNProgram copy(other);
+		swap(copy);
+	}
+	return *this;
+}
+
+RPNProgram::~RPNProgram(void) {
+	release();
+}
+
+// Sizes every array for a program; the stack and the lanes are scratch
+// space for run() and runColumns().
+void RPNProgram::allocate(size_t codeSize, size_t argumentCount, size_t variableCount,
+	size_t maxDepth) {
+	release();
+	if (codeSize != 0)
+		_code = new unsigned char[codeSize];
+	_codeSize = codeSize;
+	if (argumentCount != 0)
+		_arguments = new int[argumentCount];
+	_argumentCount = argumentCount;
+	if (variableCount != 0)
+		_variables = new std::string[variableCount];
+	_variableCount = variableCount;
+	if (maxDepth != 0) {
+		_stack = new int[maxDepth];
+		_lanes = new int64_t[maxDepth * BLOCK_ROWS];
+	}
+	_maxDepth = maxDepth;
+}
+
+void RPNProgram::release(void) {
+	delete[] _code;
+	delete[] _arguments;
+	delete[] _variables;
+	delete[] _stack;
+	delete[] _lanes;
+	_code = NULL;
+	_codeSize = 0;
+	_arguments = NULL;
+	_argumentCount = 0;
+	_variables = NULL;
+	_variableCount = 0;
+	_maxDepth = 0;
+	_stack = NULL;
+	_lanes = NULL;
+}
+
+void RPNProgram::swap(RPNProgram& other) {
+	std::swap(_code, other._code);
+	std::swap(_codeSize, other._codeSize);
+	std::swap(_arguments, other._arguments);
+	std::swap(_argumentCount, other._argumentCount);
+	std::swap(_variables, other._variables);
+	std::swap(_variableCount, other._variableCount);
+	std::swap(_maxDepth, other._maxDepth);
+	std::swap(_stack, other._stack);
+	std::swap(_lanes, other._lanes);
+}
+
+static bool isSpace(char c) {
+	return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+static bool isVariableStart(char c) {
+	return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+static bool isVariableName(const std::string& expression, size_t start, size_t end) {
+	if (!isVariableStart(expression[start]))
+		return false;
+	for (size_t i = start + 1; i < end; i++) {
+		if (!isVariableStart(expression[i]) && !std::isdigit(static_cast<unsigned char>(expression[i])))
+			return false;
+	}
+	return true;
+}
+
+// Finished bytecode for one parenthesized operand of an infix
+// expression, and the stack depth it needs. Joining two segments splices
+// their lists, so building a long formula copies no bytecode.
+struct InfixSegment {
+	std::list<unsigned char> code;
+	std::list<int> arguments;
+	size_t depth;
+
+	InfixSegment(void) : depth(0) {
+	}
+
+	bool isConstant(int value) const {
+		return isPush() && code.front() == RPNProgram::PUSH && arguments.front() == value;
+	}
+
+	bool isPush(void) const {
+		return !code.empty() && ++code.begin() == code.end();
+	}
+
+	void push(RPNProgram::Opcode opcode, int argument) {
+		code.push_back(static_cast<unsigned char>(opcode));
+		arguments.push_back(argument);
+		depth = 1;
+	}
+
+	void take(InfixSegment& other) {
+		code.swap(other.code);
+		arguments.swap(other.arguments);
+		depth = other.depth;
+	}
+
+	void join(InfixSegment& right, RPNProgram::Opcode opcode);
+};
+
+// Opcode of a one-character operator token, or PUSH when it is none.
+static RPNProgram::Opcode operatorCode(char c) {
+	switch (c) {
+	case '+':
+		return RPNProgram::ADD;
+	case '-':
+		return RPNProgram::SUBTRACT;
+	case '*':
+		return RPNProgram::MULTIPLY;
+	case '/':
+		return RPNProgram::DIVIDE;
+	default:
+		return RPNProgram::PUSH;
+	}
+}
+
+static int internVariable(std::list<std::string>& variables, const std::string& name) {
+	int index = 0;
+	std::list<std::string>::const_iterator it = variables.begin();
+	for (; it != variables.end() && *it != name; ++it)
+		index++;
+	if (it == variables.end())
+		variables.push_back(name);
+	return index;
+}
+
+static const char UNARY_MINUS = 'u';
+
+static int precedence(char op) {
+	if (op == UNARY_MINUS)
+		return 3;
+	return op == '*' || op == '/' ? 2 : 1;
+}
+
+static int parseLiteral(const std::string& token) {
+	int64_t value = 0;
+	for (size_t i = 0; i < token.size(); i++) {
+		if (!std::isdigit(static_cast<unsigned char>(token[i]))) {
+			throw RPN::InvalidExpressionException("Invalid token: " + token);
+		}
+		value = value * 10 + (token[i] - '0');
+		if (value > INT_MAX) {
+			throw RPN::InvalidExpressionException("Integer overflow");
+		}
+	}
+	return static_cast<int>(value);
+}
+
+// The value run() would compute, or false where it would throw.
+static bool foldOperation(RPNProgram::Opcode opcode, int left, int right, int& result) {
+	switch (opcode) {
+	case RPNProgram::ADD:
+		return checkedAdd(left, right, result);
+	case RPNProgram::SUBTRACT:
+		return checkedSubtract(left, right, result);
+	case RPNProgram::MULTIPLY:
+		return checkedMultiply(left, right, result);
+	default:
+		return checkedDivide(left, right, result);
+	}
+}
+
+void InfixSegment::join(InfixSegment& right, RPNProgram::Opcode opcode) {
+	int folded;
+	if (isPush() && right.isPush() && code.front() == RPNProgram::PUSH
+		&& right.code.front() == RPNProgram::PUSH
+		&& foldOperation(opcode, arguments.front(), right.arguments.front(), folded)) {
+		arguments.front() = folded;
+		return;
+	}
+	bool additive = opcode == RPNProgram::ADD || opcode == RPNProgram::SUBTRACT;
+	bool multiplicative = opcode == RPNProgram::MULTIPLY || opcode == RPNProgram::DIVIDE;
+	if ((additive && right.isConstant(0)) || (multiplicative && right.isConstant(1)))
+		return;
+	if ((opcode == RPNProgram::ADD && isConstant(0)) || (opcode == RPNProgram::MULTIPLY && isConstant(1))) {
+		take(right);
+		return;
+	}
+	if (opcode == RPNProgram::MULTIPLY
+		&& ((isConstant(0) && right.isPush()) || (right.isConstant(0) && isPush()))) {
+		code.assign(1, static_cast<unsigned char>(RPNProgram::PUSH));
+		arguments.assign(1, 0);
+		return;
+	}
+	if (right.depth + 1 > depth)
+		depth = right.depth + 1;
+	code.splice(code.end(), right.code);
+	arguments.splice(arguments.end(), right.arguments);
+	code.push_back(static_cast<unsigned char>(opcode));
+}
+
+static void reduceInfix(std::list<InfixSegment>& segments, char op) {
+	if (op == UNARY_MINUS) {
+		InfixSegment zero;
+		zero.push(RPNProgram::PUSH, 0);
+		segments.insert(--segments.end(), zero);
+		op = '-';
+	}
+	InfixSegment right;
+	right.take(segments.back());
+	segments.pop_back();
+	segments.back().join(right, operatorCode(op));
+}
+
+// Splits on whitespace like `istringstream >> token`. On error the
+// previous program is left untouched.
+void RPNProgram::compile(const std::string& expression) {
+	if (expression.empty()) {
+		throw RPN::InvalidExpressionException("Empty expression");
+	}
+	
+	std::list<unsigned char> code;
+	std::list<int> arguments;
+	std::list<std::string> variables;
+	size_t depth = 0;
+	size_t maxDepth = 0;
+	size_t length = expression.size();
+	size_t i = 0;
+	
+	while (i < length) {
+		if (isSpace(expression[i])) {
+			i++;
+			continue;
+		}
+		size_t start = i;
+		while (i < length && !isSpace(expression[i]))
+			i++;
+		char c = expression[start];
+		Opcode opcode = i - start == 1 ? operatorCode(c) : PUSH;
+		if (opcode != PUSH) {
+			if (depth < 2) {
+				throw RPN::InsufficientOperandsException();
+			}
+			depth--;
+		} else if (i - start == 1 && std::isdigit(static_cast<unsigned char>(c))) {
+			arguments.push_back(c - '0');
+		} else if (isVariableName(expression, start, i)) {
+			opcode = PUSH_VARIABLE;
+			arguments.push_back(internVariable(variables, expression.substr(start, i - start)));
+		} else {
+			throw RPN::InvalidExpressionException("Invalid token: " + expression.substr(start, i - start));
+		}
+		if (opcode == PUSH || opcode == PUSH_VARIABLE) {
+			depth++;
+			if (depth > maxDepth)
+				maxDepth = depth;
+		}
+		code.push_back(static_cast<unsigned char>(opcode));
+	}
+	
+	if (depth != 1) {
+		throw RPN::InvalidExpressionException("Invalid expression");
+	}
+	
+	install(code, arguments, variables, maxDepth);
+}
+
+// Standard precedence, left-associative binary operators, parentheses and
+// unary minus; literals are non-negative decimals up to INT_MAX. Each
+// operand becomes a segment of finished bytecode and each operator joins
+// two segments, folding them when both are constants and the operation
+// would succeed at run time. An operation that would fail stays in the
+// program, so run() still throws. Additions and subtractions of 0,
+// multiplications and divisions by 1, and products of a push with 0 are
+// dropped as well. Variables keep their numbering even when folded away.
+void RPNProgram::compileInfix(const std::string& expression) {
+	std::list<std::string> variables;
+	std::list<InfixSegment> segments;
+	std::list<char> operators;
+	bool expectOperand = true;
+	size_t length = expression.size();
+	size_t i = 0;
+	
+	while (i < length) {
+		char c = expression[i];
+		if (isSpace(c)) {
+			i++;
+			continue;
+		}
+		size_t start = i++;
+		if (std::isdigit(static_cast<unsigned char>(c)) || isVariableStart(c)) {
+			while (i < length && (isVariableStart(expression[i])
+				|| std::isdigit(static_cast<unsigned char>(expression[i]))))
+				i++;
+			if (!expectOperand) {
+				throw RPN::InvalidExpressionException("Missing operator before: "
+					+ expression.substr(start, i - start));
+			}
+			segments.push_back(InfixSegment());
+			if (isVariableName(expression, start, i)) {
+				segments.back().push(PUSH_VARIABLE,
+					internVariable(variables, expression.substr(start, i - start)));
+			} else {
+				segments.back().push(PUSH, parseLiteral(expression.substr(start, i - start)));
+			}
+			expectOperand = false;
+		} else if (c == '(') {
+			if (!expectOperand) {
+				throw RPN::InvalidExpressionException("Missing operator before: (");
+			}
+			operators.push_back(c);
+		} else if (c == ')') {
+			if (expectOperand) {
+				throw RPN::InvalidExpressionException("Missing operand before: )");
+			}
+			while (!operators.empty() && operators.back() != '(') {
+				reduceInfix(segments, operators.back());
+				operators.pop_back();
+			}
+			if (operators.empty()) {
+				throw RPN::InvalidExpressionException("Unbalanced parenthesis");
+			}
+			operators.pop_back();
+		} else if (operatorCode(c) != PUSH) {
+			if (expectOperand) {
+				if (c != '-') {
+					throw RPN::InvalidExpressionException(std::string("Missing operand before: ") + c);
+				}
+				operators.push_back(UNARY_MINUS);
+				continue;
+			}
+			while (!operators.empty() && operators.back() != '('
+				&& precedence(operators.back()) >= precedence(c)) {
+				reduceInfix(segments, operators.back());
+				operators.pop_back();
+			}
+			operators.push_back(c);
+			expectOperand = true;
+		} else {
+			throw RPN::InvalidExpressionException("Invalid token: " + std::string(1, c));
+		}
+	}
+	
+	if (expectOperand) {
+		throw RPN::InvalidExpressionException(segments.empty() && operators.empty()
+			? "Empty expression" : "Missing operand at end");
+	}
+	while (!operators.empty()) {
+		if (operators.back() == '(') {
+			throw RPN::InvalidExpressionException("Unbalanced parenthesis");
+		}
+		reduceInfix(segments, operators.back());
+		operators.pop_back();
+	}
+	
+	InfixSegment& program = segments.back();
+	install(program.code, program.arguments, variables, program.depth);
+}
+
+// Copies the compiled lists into a fresh set of arrays and only then
+// replaces the current program.
+void RPNProgram::install(const std::list<unsigned char>& code, const std::list<int>& arguments,
+	const std::list<std::string>& variables, size_t maxDepth) {
+	RPNProgram compiled;
+	compiled.allocate(code.size(), arguments.size(), variables.size(), maxDepth);
+	std::copy(code.begin(), code.end(), compiled._code);
+	std::copy(arguments.begin(), arguments.end(), compiled._arguments);
+	std::copy(variables.begin(), variables.end(), compiled._variables);
+	swap(compiled);
+}
+
+int RPNProgram::run(void) {
+	if (_variableCount != 0) {
+		throw RPN::InvalidExpressionException("Unbound variable: " + _variables[0]);
+	}
+	return run(NULL);
+}
+
+// compile() proved that every operator finds two operands and that the
+// depth never exceeds _stack, so the loop checks neither. `values` holds
+// one value per variable, in variableName() order.
+int RPNProgram::run(const int* values) {
+	if (_codeSize == 0) {
+		throw RPN::InvalidExpressionException("Empty expression");
+	}
+	
+	const unsigned char* code = _code;
+	const unsigned char* end = code + _codeSize;
+	const int* argument = _arguments;
+	int* stack = _stack;
+	size_t depth = 0;
+	
+	for (; code != end; code++) {
+		if (*code == PUSH) {
+			stack[depth++] = *argument++;
+			continue;
+		}
+		if (*code == PUSH_VARIABLE) {
+			stack[depth++] = values[*argument++];
+			continue;
+		}
+		int right = stack[--depth];
+		int& left = stack[depth - 1];
+		bool fits;
+		switch (*code) {
+		case ADD:
+			fits = checkedAdd(left, right, left);
+			break;
+		case SUBTRACT:
+			fits = checkedSubtract(left, right, left);
+			break;
+		case MULTIPLY:
+			fits = checkedMultiply(left, right, left);
+			break;
+		default:
+			if (right == 0) {
+				throw RPN::DivisionByZeroException();
+			}
+			fits = checkedDivide(left, right, left);
+			break;
+		}
+		if (!fits)
+			throw RPN::InvalidExpressionException("Integer overflow");
+	}
+	return stack[0];
+}
+
+// Row r uses columns[v][r] for variable v. Every row gets a result, 0 for
+// a failed row, and a RowStatus; returns the number of failed rows.
+size_t RPNProgram::runColumns(const int* const* columns, size_t rows, int* results,
+	unsigned char* status) {
+	if (_codeSize == 0) {
+		throw RPN::InvalidExpressionException("Empty expression");
+	}
+	
+	size_t failed = 0;
+	for (size_t first = 0; first < rows; first += BLOCK_ROWS) {
+		size_t count = rows - first < BLOCK_ROWS ? rows - first : BLOCK_ROWS;
+		runBlock(columns, first, count, results + first, status + first);
+		for (size_t r = 0; r < count; r++)
+			failed += status[first + r] != ROW_OK;
+	}
+	return failed;
+}
+
+// Operands stay within int, so sums, differences and products are exact
+// in 64-bit lanes and a range check afterwards finds every overflow;
+// division runs in int, with -1 negating in 64 bits for INT_MIN / -1. A
+// failing row keeps its first status and carries 0 onwards, so the lanes
+// never hold an out-of-range value.
+void RPNProgram::runBlock(const int* const* columns, size_t first, size_t count,
+	int* results, unsigned char* status) {
+	const unsigned char* code = _code;
+	const unsigned char* end = code + _codeSize;
+	const int* argument = _arguments;
+	int64_t* lanes = _lanes;
+	int64_t* top = lanes;
+	
+	std::memset(status, ROW_OK, count);
+	for (; code != end; code++) {
+		if (*code == PUSH) {
+			int64_t literal = *argument++;
+			for (size_t r = 0; r < count; r++)
+				top[r] = literal;
+			top += BLOCK_ROWS;
+			continue;
+		}
+		if (*code == PUSH_VARIABLE) {
+			const int* column = columns[*argument++] + first;
+			for (size_t r = 0; r < count; r++)
+				top[r] = column[r];
+			top += BLOCK_ROWS;
+			continue;
+		}
+		top -= BLOCK_ROWS;
+		const int64_t* right = top;
+		int64_t* left = top - BLOCK_ROWS;
+		switch (*code) {
+		case ADD:
+			for (size_t r = 0; r < count; r++)
+				left[r] += right[r];
+			break;
+		case SUBTRACT:
+			for (size_t r = 0; r < count; r++)
+				left[r] -= right[r];
+			break;
+		case MULTIPLY:
+			for (size_t r = 0; r < count; r++)
+				left[r] *= right[r];
+			break;
+		default:
+			for (size_t r = 0; r < count; r++) {
+				unsigned char zero = right[r] == 0 ? ROW_DIVISION_BY_ZERO : ROW_OK;
+				status[r] = status[r] != ROW_OK ? status[r] : zero;
+				int divisor = zero != ROW_OK ? 1 : static_cast<int>(right[r]);
+				int dividend = static_cast<int>(left[r]);
+				left[r] = divisor == -1 ? -left[r] : dividend / divisor;
+			}
+			break;
+		}
+		for (size_t r = 0; r < count; r++) {
+			bool outside = left[r] < INT_MIN || left[r] > INT_MAX;
+			unsigned char overflow = outside ? ROW_OVERFLOW : ROW_OK;
+			status[r] = status[r] != ROW_OK ? status[r] : overflow;
+			left[r] = outside ? 0 : left[r];
+		}
+	}
+	for (size_t r = 0; r < count; r++)
+		results[r] = status[r] != ROW_OK ? 0 : static_cast<int>(lanes[r]);
+}
+
+bool RPNProgram::isCompiled(void) const {
+	return _codeSize != 0;
+}
+
+size_t RPNProgram::instructionCount(void) const {
+	return _codeSize;
+}
+
+size_t RPNProgram::maxDepth(void) const {
+	return _maxDepth;
+}
+
+size_t RPNProgram::variableCount(void) const {
+	return _variableCount;
+}
+
+const std::string& RPNProgram::variableName(size_t index) const {
+	return _variables[index];
+}
+
+size_t RPNProgram::variableIndex(const std::string& name) const {
+	for (size_t i = 0; i < _variableCount; i++) {
+		if (_variables[i] == name)
+			return i;
+	}
+	return NO_VARIABLE;
+}
@@ -0,0 +1,88 @@
+#ifndef RPNPROGRAM_HPP
+#define RPNPROGRAM_HPP
+
+#include <cstddef>
+#include <stdint.h>
+#include <list>
+#include <string>
+
+// An RPN expression compiled once and evaluated any number of times.
+// compile() tokenizes, checks every token and the stack depth at each
+// step, and stores one opcode byte per token plus one argument (a literal
+// or a variable index) per push; run() is then a switch over those bytes
+// on a stack sized in advance, with no string handling. Errors follow
+// RPN::evaluate: the grammar errors surface from compile(), overflow and
+// division by zero from run(), all as RPN's exceptions.
+//
+// Besides single digits, a program may name variables ([A-Za-z_] then
+// [A-Za-z0-9_]), numbered in order of first appearance. runColumns()
+// evaluates it over whole columns of variable values, BLOCK_ROWS rows at
+// a time: each opcode is one loop over the block, in 64-bit lanes the
+// compiler can vectorize, and a row that fails gets a status instead of
+// stopping the batch.
+//
+// compileInfix() builds the same program from an infix formula, with
+// constant subexpressions folded and identity operations removed.
+class RPNProgram {
+public:
+	static const size_t BLOCK_ROWS = 256;
+	static const size_t NO_VARIABLE = static_cast<size_t>(-1);
+
+	enum Opcode {
+		PUSH,
+		PUSH_VARIABLE,
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE
+	};
+
+	// First error of a row, in evaluation order, as run() would throw it.
+	enum RowStatus {
+		ROW_OK,
+		ROW_OVERFLOW,
+		ROW_DIVISION_BY_ZERO
+	};
+
+private:
+	unsigned char* _code;
+	size_t _codeSize;
+	int* _arguments;
+	size_t _argumentCount;
+	std::string* _variables;
+	size_t _variableCount;
+	size_t _maxDepth;
+	int* _stack;
+	int64_t* _lanes;
+
+	void allocate(size_t codeSize, size_t argumentCount, size_t variableCount,
+		size_t maxDepth);
+	void release(void);
+	void swap(RPNProgram& other);
+	void install(const std::list<unsigned char>& code, const std::list<int>& arguments,
+		const std::list<std::string>& variables, size_t maxDepth);
+	void runBlock(const int* const* columns, size_t first, size_t count,
+		int* results, unsigned char* status);
+
+public:
+	RPNProgram(void);
+	RPNProgram(const RPNProgram& other);
+	RPNProgram& operator=(const RPNProgram& other);
+	~RPNProgram(void);
+
+	void compile(const std::string& expression);
+	void compileInfix(const std::string& expression);
+	int run(void);
+	int run(const int* values);
+	size_t runColumns(const int* const* columns, size_t rows, int* results,
+		unsigned char* status);
+
+	bool isCompiled(void) const;
+	size_t instructionCount(void) const;
+	size_t maxDepth(void) const;
+	size_t variableCount(void) const;
+	const std::string& variableName(size_t index) const;
+	size_t variableIndex(const std::string& name) const;
+};
+
+#endif
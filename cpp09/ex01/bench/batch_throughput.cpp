@@ -0,0 +1,60 @@
+#include "BenchClock.hpp"
+#include "RPNBatch.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Expressions per second through RPNBatch at growing thread counts, from
+// an in-memory input of short formulas with one in twenty failing.
+
+int main(int argc, char** argv)
+{
+	size_t lines = 1000000;
+	if (argc > 1)
+		lines = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (lines == 0)
+		lines = 1;
+
+	std::string input;
+	unsigned seed = 7;
+	for (size_t i = 0; i < lines; i++) {
+		if (i % 20 == 0) {
+			input += "1 0 /\n";
+			continue;
+		}
+		seed = seed * 1103515245u + 12345u;
+		char a = static_cast<char>('0' + (seed >> 8) % 10);
+		char b = static_cast<char>('0' + (seed >> 16) % 10);
+		char c = static_cast<char>('0' + (seed >> 24) % 10);
+		input += a;
+		input += " ";
+		input += b;
+		input += " *";
+		input += " ";
+		input += c;
+		input += " + 3 - 2 *\n";
+	}
+
+	std::cout << "RPN --batch throughput, " << lines << " expressions" << std::endl;
+	double single = 0.0;
+	for (size_t threads = 1; threads <= 16; threads *= 2) {
+		RPNBatch batch;
+		batch.setThreadCount(threads);
+		std::istringstream in(input);
+		std::ostringstream out;
+		double start = nowUs();
+		size_t failed = batch.run(in, out);
+		double elapsed = nowUs() - start;
+		if (threads == 1)
+			single = elapsed;
+		std::cout << "  " << std::setw(2) << threads << " threads  " << std::fixed
+			<< std::setprecision(1) << std::setw(7) << elapsed / 1000.0 << " ms  "
+			<< std::setw(6) << static_cast<double>(lines) / elapsed << " M expr/s  "
+			<< std::setprecision(2) << single / elapsed << "x  " << failed << " failed"
+			<< std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include "BenchClock.hpp"
+#include "BigInt.hpp"
+#include "RPN.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Bignum-mode evaluation of deep multiplication chains: a left-deep chain
+// (big times one digit at every step) and a balanced product tree, whose
+// last steps multiply two equally large operands. Then Karatsuba against
+// the schoolbook product on operands of growing size.
+
+static std::string leftChain(size_t factors)
+{
+	std::string expression = "9";
+	for (size_t i = 1; i < factors; i++)
+		expression += " 9 *";
+	return expression;
+}
+
+// Postfix of ((9 9 *) (9 9 *) *) ... with 2^depth nines.
+static std::string productTree(unsigned depth)
+{
+	if (depth == 0)
+		return "9";
+	std::string half = productTree(depth - 1);
+	return half + " " + half + " *";
+}
+
+static void runExpression(const char* shape, size_t factors, const std::string& expression)
+{
+	RPN calculator;
+	double start = nowUs();
+	BigInt result = calculator.evaluateBignum(expression);
+	double elapsed = nowUs() - start;
+	std::cout << "  " << std::left << std::setw(14) << shape << std::right
+		<< std::setw(8) << factors << " factors  " << std::setw(6) << result.limbCount()
+		<< " limbs  " << std::fixed << std::setprecision(2) << std::setw(10)
+		<< elapsed / 1000.0 << " ms" << std::endl;
+}
+
+static BigInt nines(size_t limbs)
+{
+	BigInt value(9);
+	while (value.limbCount() < limbs)
+		value = value * value + BigInt(7);
+	return value;
+}
+
+int main(int argc, char** argv)
+{
+	size_t scale = 1;
+	if (argc > 1)
+		scale = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (scale == 0)
+		scale = 1;
+
+	std::cout << "RPN --bignum multiplication chains" << std::endl;
+	for (size_t factors = 1000; factors <= 20000 * scale; factors *= 4)
+		runExpression("left chain", factors, leftChain(factors));
+	for (unsigned depth = 10; depth <= 16; depth += 2)
+		runExpression("product tree", static_cast<size_t>(1) << depth, productTree(depth));
+
+	std::cout << "square of an n-limb operand" << std::endl;
+	for (size_t limbs = 16; limbs <= 4096; limbs *= 4) {
+		BigInt operand = nines(limbs);
+		size_t rounds = 4096 * 16 / limbs + 1;
+		double start = nowUs();
+		BigInt fast;
+		for (size_t i = 0; i < rounds; i++)
+			fast = operand * operand;
+		double karatsuba = (nowUs() - start) / static_cast<double>(rounds);
+		start = nowUs();
+		BigInt slow;
+		for (size_t i = 0; i < rounds; i++)
+			slow = BigInt::schoolbookProduct(operand, operand);
+		double schoolbook = (nowUs() - start) / static_cast<double>(rounds);
+		std::cout << "  " << std::setw(6) << operand.limbCount() << " limbs  karatsuba "
+			<< std::fixed << std::setprecision(1) << std::setw(10) << karatsuba
+			<< " us  schoolbook " << std::setw(10) << schoolbook << " us"
+			<< (fast == slow ? "" : "  MISMATCH") << std::endl;
+	}
+	return 0;
+}
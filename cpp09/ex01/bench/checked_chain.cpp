@@ -0,0 +1,118 @@
+#include "BenchClock.hpp"
+#include "CheckedInt.hpp"
+#include "RPN.hpp"
+#include "RPNProgram.hpp"
+
+#include <climits>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Long arithmetic chains through the operator step alone: the former
+// std::string comparisons with double range checks against a decoded
+// opcode with the checked-arithmetic functions, then RPN::evaluate and
+// RPNProgram::run on the same chain.
+
+static bool stringStep(int left, int right, const std::string& op, int& result)
+{
+	double value;
+	if (op == "+")
+		value = static_cast<double>(left) + right;
+	else if (op == "-")
+		value = static_cast<double>(left) - right;
+	else if (op == "*")
+		value = static_cast<double>(left) * right;
+	else {
+		if (right == 0 || (left == INT_MIN && right == -1))
+			return false;
+		result = left / right;
+		return true;
+	}
+	if (value < INT_MIN || value > INT_MAX)
+		return false;
+	result = static_cast<int>(value);
+	return true;
+}
+
+static bool opcodeStep(int left, int right, unsigned char op, int& result)
+{
+	switch (op) {
+	case 0:
+		return checkedAdd(left, right, result);
+	case 1:
+		return checkedSubtract(left, right, result);
+	case 2:
+		return checkedMultiply(left, right, result);
+	default:
+		return right != 0 && checkedDivide(left, right, result);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t steps = 2000000;
+	if (argc > 1)
+		steps = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (steps == 0)
+		steps = 1;
+
+	// "9 2 * 3 + 4 / 5 - ..." stays small and never fails.
+	static const char symbols[] = "*+/-";
+	std::string expression = "9";
+	std::string* operators = new std::string[steps];
+	unsigned char* opcodes = new unsigned char[steps];
+	int* operands = new int[steps];
+	for (size_t i = 0; i < steps; i++) {
+		int digit = static_cast<int>(2 + i % 7);
+		char symbol = symbols[i % 4];
+		expression += ' ';
+		expression += static_cast<char>('0' + digit);
+		expression += ' ';
+		expression += symbol;
+		operators[i] = std::string(1, symbol);
+		opcodes[i] = static_cast<unsigned char>(symbol == '+' ? 0 : symbol == '-' ? 1
+			: symbol == '*' ? 2 : 3);
+		operands[i] = digit;
+	}
+
+	std::cout << "arithmetic chain of " << steps << " operators" << std::endl;
+	bool fits = true;
+	int value = 9;
+	double start = nowUs();
+	for (size_t i = 0; i < steps && fits; i++)
+		fits = stringStep(value, operands[i], operators[i], value);
+	double stringTime = nowUs() - start;
+	int stringValue = value;
+
+	value = 9;
+	start = nowUs();
+	for (size_t i = 0; i < steps && fits; i++)
+		fits = opcodeStep(value, operands[i], opcodes[i], value);
+	double opcodeTime = nowUs() - start;
+	delete[] operators;
+	delete[] opcodes;
+	delete[] operands;
+	if (!fits)
+		return 1;
+
+	RPN calculator;
+	start = nowUs();
+	int evaluated = calculator.evaluate(expression);
+	double evaluateTime = nowUs() - start;
+
+	RPNProgram program;
+	program.compile(expression);
+	start = nowUs();
+	int run = program.run();
+	double runTime = nowUs() - start;
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "  string + double check " << std::setw(7) << stringTime * 1000.0 / steps << " ns/op" << std::endl
+		<< "  opcode + checked      " << std::setw(7) << opcodeTime * 1000.0 / steps << " ns/op" << std::endl
+		<< "  RPN::evaluate         " << std::setw(7) << evaluateTime * 1000.0 / steps << " ns/op" << std::endl
+		<< "  RPNProgram::run       " << std::setw(7) << runTime * 1000.0 / steps << " ns/op" << std::endl;
+	if (stringValue != value || evaluated != value || run != value)
+		std::cout << "  MISMATCH" << std::endl;
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include "BenchClock.hpp"
+#include "RPNProgram.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// One formula over a million records: RPNProgram::run once per row
+// against runColumns over whole columns.
+
+int main(int argc, char** argv)
+{
+	size_t rows = 1000000;
+	if (argc > 1)
+		rows = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (rows == 0)
+		rows = 1;
+
+	static const char* const formulas[] = {
+		"price qty *",
+		"price qty * fee - 2 /",
+		"price qty * fee - price 9 * + qty 3 * - 4 / fee fee * +"
+	};
+	int* price = new int[rows];
+	int* qty = new int[rows];
+	int* fee = new int[rows];
+	unsigned seed = 12345;
+	for (size_t r = 0; r < rows; r++) {
+		seed = seed * 1103515245u + 12345u;
+		price[r] = static_cast<int>(seed >> 8) % 100000;
+		qty[r] = static_cast<int>(seed >> 20) % 100;
+		fee[r] = static_cast<int>(seed % 1000);
+	}
+	int* results = new int[rows];
+	unsigned char* status = new unsigned char[rows];
+
+	std::cout << "formula over " << rows << " rows" << std::endl;
+	for (size_t f = 0; f < sizeof(formulas) / sizeof(formulas[0]); f++) {
+		RPNProgram program;
+		program.compile(formulas[f]);
+		const int* sources[3] = { price, qty, fee };
+		const int* columns[3];
+		for (size_t v = 0; v < program.variableCount(); v++) {
+			std::string name = program.variableName(v);
+			columns[v] = sources[name == "price" ? 0 : name == "qty" ? 1 : 2];
+		}
+
+		long rowSum = 0;
+		int values[3];
+		double start = nowUs();
+		for (size_t r = 0; r < rows; r++) {
+			for (size_t v = 0; v < program.variableCount(); v++)
+				values[v] = columns[v][r];
+			rowSum += program.run(values);
+		}
+		double perRow = nowUs() - start;
+
+		start = nowUs();
+		size_t failed = program.runColumns(columns, rows, results, status);
+		double batched = nowUs() - start;
+		long batchSum = 0;
+		for (size_t r = 0; r < rows; r++)
+			batchSum += results[r];
+
+		std::cout << "  " << std::setw(2) << program.instructionCount() << " opcodes  run per row "
+			<< std::fixed << std::setprecision(1) << std::setw(7) << perRow / 1000.0
+			<< " ms  runColumns " << std::setw(6) << batched / 1000.0 << " ms  "
+			<< perRow / batched << "x"
+			<< (rowSum == batchSum && failed == 0 ? "" : "  MISMATCH") << std::endl;
+	}
+	delete[] price;
+	delete[] qty;
+	delete[] fee;
+	delete[] results;
+	delete[] status;
+	return 0;
+}
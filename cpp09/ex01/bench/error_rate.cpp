@@ -0,0 +1,70 @@
+#include "BenchClock.hpp"
+#include "RPN.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Throughput of the throwing evaluate() against tryEvaluate() on
+// workloads where a growing share of the expressions is bad: an invalid
+// token, a missing operand or a division by zero.
+
+int main(int argc, char** argv)
+{
+	size_t count = 500000;
+	if (argc > 1)
+		count = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (count == 0)
+		count = 1;
+
+	static const char* const good = "3 4 + 2 * 7 - 5 /";
+	static const char* const bad[] = { "3 4 + x * 7 -", "3 + 2 * 7 - 5 /", "3 4 + 0 / 7 -" };
+	static const unsigned rates[] = { 0, 1, 10, 50, 90 };
+
+	std::cout << "evaluate() against tryEvaluate(), " << count << " expressions" << std::endl;
+	std::string* expressions = new std::string[count];
+	for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+		unsigned seed = 99;
+		for (size_t i = 0; i < count; i++) {
+			seed = seed * 1103515245u + 12345u;
+			bool failing = (seed >> 8) % 100 < rates[r];
+			expressions[i] = failing ? bad[(seed >> 20) % 3] : good;
+		}
+
+		RPN calculator;
+		size_t thrown = 0;
+		long sum = 0;
+		double start = nowUs();
+		for (size_t i = 0; i < count; i++) {
+			try {
+				sum += calculator.evaluate(expressions[i]);
+			} catch (const std::exception&) {
+				thrown++;
+			}
+		}
+		double throwing = nowUs() - start;
+
+		size_t failed = 0;
+		long statusSum = 0;
+		start = nowUs();
+		for (size_t i = 0; i < count; i++) {
+			int result;
+			size_t position;
+			if (calculator.tryEvaluate(expressions[i], result, position) == RPN::OK)
+				statusSum += result;
+			else
+				failed++;
+		}
+		double status = nowUs() - start;
+
+		std::cout << "  " << std::setw(2) << rates[r] << "% bad  evaluate " << std::fixed
+			<< std::setprecision(1) << std::setw(7) << throwing / 1000.0 << " ms  tryEvaluate "
+			<< std::setw(6) << status / 1000.0 << " ms  " << std::setprecision(2)
+			<< throwing / status << "x" << (thrown == failed && sum == statusSum ? "" : "  MISMATCH")
+			<< std::endl;
+	}
+	delete[] expressions;
+	return 0;
+}
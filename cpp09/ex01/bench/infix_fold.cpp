@@ -0,0 +1,91 @@
+#include "BenchClock.hpp"
+#include "RPNProgram.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// Formulas with constant parts, compiled as hand-written postfix (every
+// operation kept) and through compileInfix (folded), then evaluated per
+// row and over columns of a million rows.
+
+struct Formula {
+	const char* infix;
+	const char* postfix;
+};
+
+// The formulas use the variables a, b and c.
+static const size_t MAX_VARIABLES = 3;
+
+static void measure(RPNProgram& program, const int* const* columns, size_t rows,
+	int* results, unsigned char* status, double& perRow, double& batched, long& checksum)
+{
+	int values[MAX_VARIABLES];
+	checksum = 0;
+	double start = nowUs();
+	for (size_t r = 0; r < rows; r++) {
+		for (size_t v = 0; v < program.variableCount(); v++)
+			values[v] = columns[v][r];
+		checksum += program.run(values);
+	}
+	perRow = nowUs() - start;
+	start = nowUs();
+	program.runColumns(columns, rows, results, status);
+	batched = nowUs() - start;
+}
+
+int main(int argc, char** argv)
+{
+	size_t rows = 1000000;
+	if (argc > 1)
+		rows = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (rows == 0)
+		rows = 1;
+
+	static const Formula formulas[] = {
+		{ "a * (1 + 2 * 3) - b", "a 1 2 3 * + * b -" },
+		{ "(a + 0) * (9 - 8) + b * (2 * 2 - 4) - (6 / 3) * c",
+			"a 0 + 9 8 - * b 2 2 * 4 - * + 6 3 / c * -" },
+		{ "((a - b) * (4 + 5) + (c * 1) / (7 - 6)) * (1 + 1)",
+			"a b - 4 5 + * c 1 * 7 6 - / + 1 1 + *" }
+	};
+	int* a = new int[rows];
+	int* b = new int[rows];
+	int* c = new int[rows];
+	for (size_t r = 0; r < rows; r++) {
+		a[r] = static_cast<int>(r % 1000);
+		b[r] = static_cast<int>(r % 77) - 30;
+		c[r] = static_cast<int>(r % 5000);
+	}
+	int* results = new int[rows];
+	unsigned char* status = new unsigned char[rows];
+
+	std::cout << "folded infix against hand-written postfix, " << rows << " rows" << std::endl;
+	for (size_t f = 0; f < sizeof(formulas) / sizeof(formulas[0]); f++) {
+		RPNProgram programs[2];
+		programs[0].compile(formulas[f].postfix);
+		programs[1].compileInfix(formulas[f].infix);
+		long checksums[2];
+		for (int p = 0; p < 2; p++) {
+			const int* sources[MAX_VARIABLES] = { a, b, c };
+			const int* columns[MAX_VARIABLES];
+			for (size_t v = 0; v < programs[p].variableCount(); v++)
+				columns[v] = sources[programs[p].variableName(v)[0] - 'a'];
+			double perRow;
+			double batched;
+			measure(programs[p], columns, rows, results, status, perRow, batched, checksums[p]);
+			std::cout << "  " << (p == 0 ? "postfix " : "infix   ") << std::setw(2)
+				<< programs[p].instructionCount() << " opcodes  run " << std::fixed
+				<< std::setprecision(1) << std::setw(6) << perRow / 1000.0 << " ms  runColumns "
+				<< std::setw(6) << batched / 1000.0 << " ms" << std::endl;
+		}
+		if (checksums[0] != checksums[1])
+			std::cout << "  MISMATCH" << std::endl;
+	}
+	delete[] a;
+	delete[] b;
+	delete[] c;
+	delete[] results;
+	delete[] status;
+	return 0;
+}
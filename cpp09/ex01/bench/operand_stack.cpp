@@ -0,0 +1,126 @@
+#include "BenchClock.hpp"
+#include "OperandStack.hpp"
+#include "RPN.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <stack>
+#include <string>
+
+// Very long expressions through the operand stack: std::stack over
+// std::list (allocations counted by its allocator) against std::stack
+// over OperandStack, on the same token loop, then RPN::evaluate end to
+// end.
+
+static size_t g_allocations = 0;
+
+template<typename T>
+class CountingAllocator : public std::allocator<T> {
+public:
+	template<typename U>
+	struct rebind {
+		typedef CountingAllocator<U> other;
+	};
+
+	CountingAllocator(void) {
+	}
+
+	template<typename U>
+	CountingAllocator(const CountingAllocator<U>&) {
+	}
+
+	typename std::allocator<T>::pointer allocate(typename std::allocator<T>::size_type n,
+		const void* hint = 0) {
+		g_allocations++;
+		return std::allocator<T>::allocate(n, hint);
+	}
+};
+
+// Runs of pushes and additions, so the depth keeps rising and falling.
+static std::string longExpression(size_t tokens)
+{
+	std::string expression = "1";
+	size_t depth = 1;
+	size_t count = 1;
+	while (count < tokens) {
+		size_t run = 1 + count % 50;
+		for (size_t i = 0; i < run && count < tokens; i++, count++, depth++)
+			expression += " 1";
+		while (depth > 1 && count < tokens) {
+			expression += " +";
+			depth--;
+			count++;
+		}
+	}
+	while (depth-- > 1)
+		expression += " +";
+	return expression;
+}
+
+template<typename Stack>
+static int runTokens(const std::string& expression, Stack& stack)
+{
+	for (size_t i = 0; i < expression.size(); i += 2) {
+		if (expression[i] == '+') {
+			int right = stack.top();
+			stack.pop();
+			stack.top() += right;
+		} else {
+			stack.push(expression[i] - '0');
+		}
+	}
+	return stack.top();
+}
+
+int main(int argc, char** argv)
+{
+	size_t scale = 1;
+	if (argc > 1)
+		scale = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (scale == 0)
+		scale = 1;
+
+	std::cout << "operand stack on long expressions" << std::endl;
+	for (size_t tokens = 1000000; tokens <= 4000000 * scale; tokens *= 2) {
+		std::string expression = longExpression(tokens);
+
+		g_allocations = 0;
+		double start = nowUs();
+		std::stack<int, std::list<int, CountingAllocator<int> > > listed;
+		int listResult = runTokens(expression, listed);
+		double listTime = nowUs() - start;
+		size_t listAllocations = g_allocations;
+
+		start = nowUs();
+		std::stack<int, OperandStack> contiguous;
+		int contiguousResult = runTokens(expression, contiguous);
+		double contiguousTime = nowUs() - start;
+		// The array doubles from INLINE_CAPACITY up to the deepest point.
+		size_t depth = 0;
+		size_t deepest = 0;
+		for (size_t i = 0; i < expression.size(); i += 2) {
+			depth = expression[i] == '+' ? depth - 1 : depth + 1;
+			deepest = depth > deepest ? depth : deepest;
+		}
+		size_t growths = 0;
+		for (size_t capacity = OperandStack::INLINE_CAPACITY; capacity < deepest; capacity *= 2)
+			growths++;
+
+		RPN calculator;
+		start = nowUs();
+		int evaluated = calculator.evaluate(expression);
+		double evaluateTime = nowUs() - start;
+
+		std::cout << "  " << std::setw(8) << tokens << " tokens  list " << std::fixed
+			<< std::setprecision(1) << std::setw(6) << listTime / 1000.0 << " ms "
+			<< std::setw(8) << listAllocations << " allocs  contiguous " << std::setw(5)
+			<< contiguousTime / 1000.0 << " ms " << std::setw(2) << growths
+			<< " allocs  evaluate " << std::setw(6) << evaluateTime / 1000.0 << " ms"
+			<< (listResult == contiguousResult && listResult == evaluated ? "" : "  MISMATCH")
+			<< std::endl;
+	}
+	return 0;
+}
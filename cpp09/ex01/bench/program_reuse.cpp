@@ -0,0 +1,58 @@
+#include "BenchClock.hpp"
+#include "RPN.hpp"
+#include "RPNProgram.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// The same expression evaluated many times: RPN::evaluate, which
+// tokenizes on every call, against one RPNProgram::compile followed by
+// run() per evaluation.
+
+static std::string formula(size_t operators)
+{
+	static const char* const steps[] = { " 7 +", " 3 *", " 5 -", " 4 /" };
+	std::string expression = "9";
+	for (size_t i = 0; i < operators; i++)
+		expression += steps[i % 4];
+	return expression;
+}
+
+int main(int argc, char** argv)
+{
+	size_t scale = 1;
+	if (argc > 1)
+		scale = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+	if (scale == 0)
+		scale = 1;
+
+	std::cout << "repeated evaluation of one expression" << std::endl;
+	static const size_t sizes[] = { 4, 16, 64, 256 };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		std::string expression = formula(sizes[s]);
+		size_t rounds = scale * 2000000 / sizes[s];
+		RPN calculator;
+		long checksum = 0;
+		double start = nowUs();
+		for (size_t i = 0; i < rounds; i++)
+			checksum += calculator.evaluate(expression);
+		double interpreted = nowUs() - start;
+
+		RPNProgram program;
+		long compiledChecksum = 0;
+		start = nowUs();
+		program.compile(expression);
+		for (size_t i = 0; i < rounds; i++)
+			compiledChecksum += program.run();
+		double compiled = nowUs() - start;
+
+		std::cout << "  " << std::setw(4) << sizes[s] << " operators x " << std::setw(7) << rounds
+			<< "  evaluate " << std::fixed << std::setprecision(1) << std::setw(8)
+			<< interpreted / 1000.0 << " ms  compiled " << std::setw(7) << compiled / 1000.0
+			<< " ms  " << std::setprecision(1) << interpreted / compiled << "x"
+			<< (checksum == compiledChecksum ? "" : "  MISMATCH") << std::endl;
+	}
+	return 0;
+}
@@ -1,18 +1,73 @@
 #include "RPN.hpp"
+#include "RPNBatch.hpp"
 
+#include <cstdlib>
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <string>
 
+// ./RPN --batch [--threads=N] [FILE] evaluates one expression per line of
+// FILE, or of standard input when FILE is missing or "-", and prints one
+// result or "Error" per line in input order. The exit status is nonzero
+// when any expression failed.
+static int runBatch(int argc, char** argv) {
+	RPNBatch batch;
+	int i = 2;
+	if (i < argc && std::string(argv[i]).compare(0, 10, "--threads=") == 0) {
+		const char* digits = argv[i] + 10;
+		char* end = NULL;
+		unsigned long threads = std::strtoul(digits, &end, 10);
+		if (*digits == '\0' || *end != '\0' || threads == 0) {
+			std::cerr << "Error" << std::endl;
+			return 1;
+		}
+		batch.setThreadCount(threads);
+		i++;
+	}
+	if (argc - i > 1) {
+		std::cerr << "Error" << std::endl;
+		return 1;
+	}
+	
+	try {
+		if (i == argc || std::string(argv[i]) == "-") {
+			return batch.run(std::cin, std::cout) == 0 ? 0 : 1;
+		}
+		std::ifstream in(argv[i]);
+		if (!in) {
+			std::cerr << "Error" << std::endl;
+			return 1;
+		}
+		return batch.run(in, std::cout) == 0 ? 0 : 1;
+	} catch (const std::exception&) {
+		std::cerr << "Error" << std::endl;
+		return 1;
+	}
+}
+
+// ./RPN "expression" computes in int; ./RPN --bignum "expression" computes
+// exactly with integers of any size.
 int main(int argc, char** argv) {
-	if (argc != 2) {
+	if (argc >= 2 && std::string(argv[1]) == "--batch") {
+		return runBatch(argc, argv);
+	}
+	
+	bool bignum = argc == 3 && std::string(argv[1]) == "--bignum";
+	if (argc != 2 && !bignum) {
 		std::cerr << "Error" << std::endl;
 		return 1;
 	}
 	
 	try {
 		RPN calculator;
-		std::string expression = argv[1];
-		int result = calculator.evaluate(expression);
-		std::cout << result << std::endl;
+		std::string expression = argv[argc - 1];
+		if (bignum) {
+			std::cout << calculator.evaluateBignum(expression).toString() << std::endl;
+		} else {
+			int result = calculator.evaluate(expression);
+			std::cout << result << std::endl;
+		}
 	} catch (const std::exception&) {
 		std::cerr << "Error" << std::endl;
 		return 1;
@@ -20,4 +75,3 @@ int main(int argc, char** argv) {
 	
 	return 0;
 }
-
@@ -0,0 +1,385 @@
+#include "ParallelFordJohnson.hpp"
+
+#include <pthread.h>
+
+static const size_t NO_LIST = static_cast<size_t>(-1);
+static const size_t BLOCK_GAPS = 64;
+
+// The main chain during one Jacobsthal group: the chain as it was when the
+// group started (`base`), plus the losers inserted since, kept in one list
+// per gap. Gap p sits just before base[p]; gap base.size() is the tail.
+// Loser counts are kept per gap and, in a Fenwick tree, per block of
+// BLOCK_GAPS gaps, so mapping a chain position to its element is a short
+// descent over a cache-resident tree and a scan inside one block. The
+// binary searches therefore see exactly the chain the sequential version
+// would have built.
+struct ParallelFordJohnson::GapChain {
+	const std::vector<int>* values;
+	const std::vector<size_t>* base;
+	std::vector<int> baseValues;
+	size_t gapCount;
+	size_t blockCount;
+	size_t topStep;
+	size_t inserted;
+	std::vector<size_t> blockTree;
+	std::vector<size_t> gapLosers;
+	std::vector<size_t> listOf;
+	std::vector<std::vector<size_t> > lists;
+	size_t listsUsed;
+
+	GapChain(void)
+		: values(NULL), base(NULL), gapCount(0), blockCount(0), topStep(0), inserted(0),
+		  listsUsed(0) {
+	}
+
+	// baseValues must already hold the values of `chain`.
+	void reset(const std::vector<size_t>& chain) {
+		base = &chain;
+		gapCount = chain.size() + 1;
+		blockCount = (gapCount + BLOCK_GAPS - 1) / BLOCK_GAPS;
+		topStep = 1;
+		while (topStep * 2 <= blockCount)
+			topStep *= 2;
+		inserted = 0;
+		blockTree.assign(blockCount + 1, 0);
+		gapLosers.assign(gapCount, 0);
+		listOf.assign(gapCount, NO_LIST);
+		listsUsed = 0;
+	}
+
+	size_t size(void) const {
+		return base->size() + inserted;
+	}
+
+	size_t gapWeight(size_t gap) const {
+		return gapLosers[gap] + (gap < base->size() ? 1 : 0);
+	}
+
+	// Chain position of the first loser in `gap`, or of base[gap] when the
+	// gap is empty.
+	size_t gapStart(size_t gap) const {
+		size_t block = gap / BLOCK_GAPS;
+		size_t start = gap;
+		for (size_t i = block; i > 0; i -= i & (~i + 1))
+			start += blockTree[i];
+		for (size_t g = block * BLOCK_GAPS; g < gap; g++)
+			start += gapLosers[g];
+		return start;
+	}
+
+	size_t basePosition(size_t index) const {
+		return gapStart(index) + gapLosers[index];
+	}
+
+	// Last gap whose start is at or before `position`; `start` receives
+	// that start.
+	size_t findGap(size_t position, size_t& start) const {
+		size_t block = 0;
+		size_t losers = 0;
+		size_t baseSize = base->size();
+		for (size_t step = topStep; step > 0; step /= 2) {
+			size_t next = block + step;
+			if (next > blockCount)
+				continue;
+			size_t bases = next * BLOCK_GAPS;
+			if (bases > baseSize)
+				bases = baseSize;
+			if (losers + blockTree[next] + bases <= position) {
+				block = next;
+				losers += blockTree[next];
+			}
+		}
+		size_t gap = block * BLOCK_GAPS;
+		start = gap + losers;
+		while (start + gapWeight(gap) <= position) {
+			start += gapWeight(gap);
+			gap++;
+		}
+		return gap;
+	}
+
+	int valueAt(size_t position) const {
+		size_t start;
+		size_t gap = findGap(position, start);
+		size_t offset = position - start;
+		if (offset < gapLosers[gap])
+			return (*values)[lists[listOf[gap]][offset]];
+		return baseValues[gap];
+	}
+
+	void insert(size_t position, size_t id) {
+		size_t gap = base->size();
+		size_t offset = gapLosers[gap];
+		if (position < size()) {
+			size_t start;
+			gap = findGap(position, start);
+			offset = position - start;
+		}
+		if (listOf[gap] == NO_LIST) {
+			if (listsUsed == lists.size())
+				lists.push_back(std::vector<size_t>());
+			lists[listsUsed].clear();
+			listOf[gap] = listsUsed++;
+		}
+		std::vector<size_t>& list = lists[listOf[gap]];
+		list.insert(list.begin() + offset, id);
+		gapLosers[gap]++;
+		for (size_t i = gap / BLOCK_GAPS + 1; i <= blockCount; i += i & (~i + 1))
+			blockTree[i]++;
+		inserted++;
+	}
+};
+
+struct ParallelFordJohnson::Pass {
+	const std::vector<int>* values;
+	const std::vector<size_t>* order;
+	std::vector<size_t>* winners;
+	std::vector<size_t>* losers;
+	std::vector<size_t>* partnerOf;
+	std::vector<size_t>* positionOf;
+	const std::vector<size_t>* chain;
+	GapChain* gaps;
+	std::vector<size_t>* flattened;
+};
+
+struct ParallelFordJohnson::Slice {
+	const Pass* pass;
+	void (*body)(const Pass&, size_t, size_t);
+	size_t begin;
+	size_t end;
+};
+
+ParallelFordJohnson::ParallelFordJohnson(void)
+	: _threadCount(1), _comparisons(0), _values(NULL) {
+}
+
+ParallelFordJohnson::ParallelFordJohnson(const ParallelFordJohnson& other)
+	: _threadCount(other._threadCount), _comparisons(other._comparisons),
+	  _values(NULL) {
+}
+
+ParallelFordJohnson& ParallelFordJohnson::operator=(
+	const ParallelFordJohnson& other) {
+	if (this != &other) {
+		_threadCount = other._threadCount;
+		_comparisons = other._comparisons;
+	}
+	return *this;
+}
+
+ParallelFordJohnson::~ParallelFordJohnson(void) {
+}
+
+void ParallelFordJohnson::setThreadCount(size_t threads) {
+	if (threads < 1)
+		threads = 1;
+	if (threads > MAX_THREADS)
+		threads = MAX_THREADS;
+	_threadCount = threads;
+}
+
+size_t ParallelFordJohnson::threadCount(void) const {
+	return _threadCount;
+}
+
+size_t ParallelFordJohnson::comparisons(void) const {
+	return _comparisons;
+}
+
+void* ParallelFordJohnson::runSlice(void* argument) {
+	Slice* slice = static_cast<Slice*>(argument);
+	slice->body(*slice->pass, slice->begin, slice->end);
+	return NULL;
+}
+
+// One comparison per pair; the larger value wins, ties keep the first.
+void ParallelFordJohnson::pairSlice(const Pass& pass, size_t begin,
+	size_t end) {
+	const std::vector<int>& values = *pass.values;
+	const std::vector<size_t>& order = *pass.order;
+	for (size_t i = begin; i < end; i++) {
+		size_t a = order[2 * i];
+		size_t b = order[2 * i + 1];
+		if (values[a] < values[b]) {
+			size_t tmp = a;
+			a = b;
+			b = tmp;
+		}
+		(*pass.winners)[i] = a;
+		(*pass.losers)[i] = b;
+	}
+}
+
+void ParallelFordJohnson::partnerSlice(const Pass& pass, size_t begin,
+	size_t end) {
+	for (size_t i = begin; i < end; i++)
+		(*pass.partnerOf)[(*pass.winners)[i]] = (*pass.losers)[i];
+}
+
+// Chain positions for the winners' search bounds, and the chain's values
+// in chain order for the searches.
+void ParallelFordJohnson::positionSlice(const Pass& pass, size_t begin,
+	size_t end) {
+	const std::vector<int>& values = *pass.values;
+	const std::vector<size_t>& chain = *pass.chain;
+	std::vector<int>& baseValues = pass.gaps->baseValues;
+	for (size_t i = begin; i < end; i++) {
+		(*pass.positionOf)[chain[i]] = i;
+		baseValues[i] = values[chain[i]];
+	}
+}
+
+void ParallelFordJohnson::flattenSlice(const Pass& pass, size_t begin,
+	size_t end) {
+	const GapChain& gaps = *pass.gaps;
+	const std::vector<size_t>& base = *gaps.base;
+	size_t out = gaps.gapStart(begin);
+	for (size_t gap = begin; gap < end; gap++) {
+		if (gaps.gapLosers[gap] != 0) {
+			const std::vector<size_t>& list = gaps.lists[gaps.listOf[gap]];
+			for (size_t i = 0; i < list.size(); i++)
+				(*pass.flattened)[out++] = list[i];
+		}
+		if (gap < base.size())
+			(*pass.flattened)[out++] = base[gap];
+	}
+}
+
+// Splits [0, count) into one slice per thread, at least MIN_SLICE items
+// each, runs slice 0 on the calling thread and the rest on new threads;
+// a slice whose thread cannot be created runs inline after the joins.
+void ParallelFordJohnson::forEachSlice(size_t count,
+	void (*body)(const Pass&, size_t, size_t), const Pass& pass) const {
+	size_t sliceCount = count / MIN_SLICE;
+	if (sliceCount > _threadCount)
+		sliceCount = _threadCount;
+	if (sliceCount < 2) {
+		body(pass, 0, count);
+		return;
+	}
+	std::vector<Slice> slices(sliceCount);
+	std::vector<pthread_t> threads(sliceCount);
+	std::vector<bool> started(sliceCount, false);
+	for (size_t i = 0; i < sliceCount; i++) {
+		slices[i].pass = &pass;
+		slices[i].body = body;
+		slices[i].begin = count * i / sliceCount;
+		slices[i].end = count * (i + 1) / sliceCount;
+	}
+	for (size_t i = 1; i < sliceCount; i++)
+		started[i] = pthread_create(&threads[i], NULL, runSlice, &slices[i]) == 0;
+	runSlice(&slices[0]);
+	for (size_t i = 1; i < sliceCount; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			runSlice(&slices[i]);
+	}
+}
+
+void ParallelFordJohnson::sort(const std::vector<int>& values,
+	std::vector<size_t>& order) {
+	_values = &values;
+	_comparisons = 0;
+	_partnerOf.assign(values.size(), 0);
+	_positionOf.assign(values.size(), 0);
+	sortLevel(order);
+}
+
+// The partner mapping is written after the recursive sort, which reuses
+// _partnerOf for its own winners.
+void ParallelFordJohnson::sortLevel(std::vector<size_t>& order) {
+	size_t n = order.size();
+	if (n < 2)
+		return;
+	size_t pairs = n / 2;
+	bool hasStraggler = (n % 2 != 0);
+	size_t straggler = hasStraggler ? order[n - 1] : 0;
+
+	std::vector<size_t> winners(pairs);
+	std::vector<size_t> losers(pairs);
+	Pass pass;
+	pass.values = _values;
+	pass.order = &order;
+	pass.winners = &winners;
+	pass.losers = &losers;
+	pass.partnerOf = &_partnerOf;
+	forEachSlice(pairs, pairSlice, pass);
+	_comparisons += pairs;
+
+	std::vector<size_t> sorted(winners);
+	sortLevel(sorted);
+	forEachSlice(pairs, partnerSlice, pass);
+
+	std::vector<size_t> chain;
+	insertLosers(sorted, hasStraggler, straggler, chain);
+	order.swap(chain);
+}
+
+// Same Jacobsthal groups, search bounds and upper-bound searches as
+// PmergeMe::fordJohnsonVector. Before each group the winners' chain
+// positions are refreshed from the flattened chain.
+void ParallelFordJohnson::insertLosers(const std::vector<size_t>& winners,
+	bool hasStraggler, size_t straggler, std::vector<size_t>& chain) {
+	const std::vector<int>& values = *_values;
+	size_t count = winners.size();
+	chain.reserve(2 * count + 1);
+	chain.push_back(_partnerOf[winners[0]]);
+	chain.insert(chain.end(), winners.begin(), winners.end());
+
+	size_t pendCount = count - 1;
+	if (hasStraggler)
+		pendCount++;
+	GapChain gaps;
+	gaps.values = _values;
+	std::vector<size_t> flattened;
+	Pass pass;
+	pass.values = _values;
+	pass.positionOf = &_positionOf;
+	pass.chain = &chain;
+	pass.gaps = &gaps;
+	pass.flattened = &flattened;
+
+	size_t inserted = 0;
+	size_t prev = 1;
+	size_t cur = 3;
+	while (inserted < pendCount) {
+		size_t upper = cur;
+		if (upper > pendCount + 1)
+			upper = pendCount + 1;
+		gaps.baseValues.resize(chain.size());
+		forEachSlice(chain.size(), positionSlice, pass);
+		gaps.reset(chain);
+		for (size_t b = upper; b > prev; b--) {
+			size_t winnerIndex = b - 1;
+			size_t loser;
+			size_t limit;
+			if (winnerIndex == count) {
+				loser = straggler;
+				limit = gaps.size();
+			} else {
+				loser = _partnerOf[winners[winnerIndex]];
+				limit = gaps.basePosition(_positionOf[winners[winnerIndex]]);
+			}
+			int value = values[loser];
+			size_t lo = 0;
+			size_t hi = limit;
+			while (lo < hi) {
+				size_t mid = lo + (hi - lo) / 2;
+				_comparisons++;
+				if (gaps.valueAt(mid) <= value)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			gaps.insert(lo, loser);
+			inserted++;
+		}
+		flattened.resize(gaps.size());
+		forEachSlice(gaps.gapCount, flattenSlice, pass);
+		chain.swap(flattened);
+		size_t next = cur + 2 * prev;
+		prev = cur;
+		cur = next;
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef PARALLELFORDJOHNSON_HPP
+#define PARALLELFORDJOHNSON_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Ford-Johnson merge-insertion over an index permutation, with the same
+// comparisons in the same order as PmergeMe::fordJohnsonVector. The
+// pairing pass, the partner mapping and the chain rebuilds between
+// Jacobsthal groups are split into one contiguous slice per thread; the
+// binary searches stay sequential because each depends on the last.
+// Inside a group the losers go into per-gap lists over the chain built so
+// far instead of shifting the chain tail, and the chain is rebuilt once
+// per group.
+class ParallelFordJohnson {
+public:
+	static const size_t MAX_THREADS = 64;
+	static const size_t MIN_SLICE = 16384;
+
+private:
+	struct GapChain;
+	struct Pass;
+	struct Slice;
+
+	size_t _threadCount;
+	size_t _comparisons;
+	const std::vector<int>* _values;
+	std::vector<size_t> _partnerOf;
+	std::vector<size_t> _positionOf;
+
+	static void* runSlice(void* argument);
+	static void pairSlice(const Pass& pass, size_t begin, size_t end);
+	static void partnerSlice(const Pass& pass, size_t begin, size_t end);
+	static void positionSlice(const Pass& pass, size_t begin, size_t end);
+	static void flattenSlice(const Pass& pass, size_t begin, size_t end);
+
+	void forEachSlice(size_t count,
+		void (*body)(const Pass&, size_t, size_t), const Pass& pass) const;
+	void sortLevel(std::vector<size_t>& order);
+	void insertLosers(const std::vector<size_t>& winners, bool hasStraggler,
+		size_t straggler, std::vector<size_t>& chain);
+
+public:
+	ParallelFordJohnson(void);
+	ParallelFordJohnson(const ParallelFordJohnson& other);
+	ParallelFordJohnson& operator=(const ParallelFordJohnson& other);
+	~ParallelFordJohnson(void);
+
+	void setThreadCount(size_t threads);
+	size_t threadCount(void) const;
+
+	// Reorders `order` (indices into `values`) into ascending value order.
+	void sort(const std::vector<int>& values, std::vector<size_t>& order);
+	// Value comparisons made by the last sort().
+	size_t comparisons(void) const;
+};
+
+#endif
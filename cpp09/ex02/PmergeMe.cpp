@@ -1,4 +1,5 @@
 #include "PmergeMe.hpp"
+#include "ParallelFordJohnson.hpp"
 
 #include <cctype>
 #include <climits>
@@ -9,13 +10,15 @@
 #include <sys/time.h>
 
 PmergeMe::PmergeMe(void)
-	: _vectorTimeUs(0.0), _dequeTimeUs(0.0) {
+	: _vectorTimeUs(0.0), _dequeTimeUs(0.0), _threadCount(1),
+	  _vectorComparisons(0) {
 }
 
 PmergeMe::PmergeMe(const PmergeMe& other)
 	: _tokens(other._tokens), _vectorData(other._vectorData),
 	  _dequeData(other._dequeData), _vectorTimeUs(other._vectorTimeUs),
-	  _dequeTimeUs(other._dequeTimeUs) {
+	  _dequeTimeUs(other._dequeTimeUs), _threadCount(other._threadCount),
+	  _vectorComparisons(other._vectorComparisons) {
 }
 
 PmergeMe& PmergeMe::operator=(const PmergeMe& other) {
@@ -25,6 +28,8 @@ PmergeMe& PmergeMe::operator=(const PmergeMe& other) {
 		_dequeData = other._dequeData;
 		_vectorTimeUs = other._vectorTimeUs;
 		_dequeTimeUs = other._dequeTimeUs;
+		_threadCount = other._threadCount;
+		_vectorComparisons = other._vectorComparisons;
 	}
 	return *this;
 }
@@ -32,6 +37,22 @@ PmergeMe& PmergeMe::operator=(const PmergeMe& other) {
 PmergeMe::~PmergeMe(void) {
 }
 
+void PmergeMe::setThreadCount(size_t threads) {
+	if (threads < 1)
+		threads = 1;
+	if (threads > ParallelFordJohnson::MAX_THREADS)
+		threads = ParallelFordJohnson::MAX_THREADS;
+	_threadCount = threads;
+}
+
+size_t PmergeMe::threadCount(void) const {
+	return _threadCount;
+}
+
+size_t PmergeMe::vectorComparisons(void) const {
+	return _vectorComparisons;
+}
+
 bool PmergeMe::isValidNumber(const std::string& str) const {
 	if (str.empty())
 		return false;
@@ -64,11 +85,12 @@ int PmergeMe::stringToInt(const std::string& str) const {
 }
 
 size_t PmergeMe::upperBoundVector(const std::vector<int>& values,
-	const std::vector<size_t>& chain, size_t end, int value) const {
+	const std::vector<size_t>& chain, size_t end, int value) {
 	size_t lo = 0;
 	size_t hi = end;
 	while (lo < hi) {
 		size_t mid = lo + (hi - lo) / 2;
+		_vectorComparisons++;
 		if (values[chain[mid]] <= value)
 			lo = mid + 1;
 		else
@@ -119,6 +141,7 @@ void PmergeMe::fordJohnsonVector(const std::vector<int>& values,
 		winners.push_back(a);
 		partnerOf[a] = b;
 	}
+	_vectorComparisons += winners.size();
 
 	fordJohnsonVector(values, winners);
 
@@ -264,6 +287,7 @@ void PmergeMe::parseInput(int argc, char** argv) {
 	_dequeData.clear();
 	_vectorTimeUs = 0.0;
 	_dequeTimeUs = 0.0;
+	_vectorComparisons = 0;
 }
 
 void PmergeMe::sortVector(void) {
@@ -277,7 +301,15 @@ void PmergeMe::sortVector(void) {
 	std::vector<size_t> order(_vectorData.size());
 	for (size_t i = 0; i < order.size(); i++)
 		order[i] = i;
-	fordJohnsonVector(_vectorData, order);
+	if (_threadCount > 1) {
+		ParallelFordJohnson sorter;
+		sorter.setThreadCount(_threadCount);
+		sorter.sort(_vectorData, order);
+		_vectorComparisons = sorter.comparisons();
+	} else {
+		_vectorComparisons = 0;
+		fordJohnsonVector(_vectorData, order);
+	}
 	std::vector<int> sorted;
 	sorted.reserve(order.size());
 	for (size_t i = 0; i < order.size(); i++)
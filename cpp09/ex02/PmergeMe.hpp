@@ -13,11 +13,13 @@ private:
 	std::deque<int> _dequeData;
 	double _vectorTimeUs;
 	double _dequeTimeUs;
+	size_t _threadCount;
+	size_t _vectorComparisons;
 
 	void fordJohnsonVector(const std::vector<int>& values,
 		std::vector<size_t>& order);
 	size_t upperBoundVector(const std::vector<int>& values,
-		const std::vector<size_t>& chain, size_t end, int value) const;
+		const std::vector<size_t>& chain, size_t end, int value);
 	std::vector<size_t> jacobsthalOrderVector(size_t pendCount) const;
 
 	void fordJohnsonDeque(const std::deque<int>& values,
@@ -35,6 +37,12 @@ public:
 	PmergeMe& operator=(const PmergeMe& other);
 	~PmergeMe(void);
 
+	// With more than one thread, sortVector() runs ParallelFordJohnson,
+	// which makes the same comparisons as the single-threaded sort.
+	void setThreadCount(size_t threads);
+	size_t threadCount(void) const;
+	size_t vectorComparisons(void) const;
+
 	void parseInput(int argc, char** argv);
 	void sortVector(void);
 	void sortDeque(void);
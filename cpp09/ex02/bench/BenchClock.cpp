@@ -0,0 +1,11 @@
+#include "BenchClock.hpp"
+
+#include <cstddef>
+#include <sys/time.h>
+
+double nowUs(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
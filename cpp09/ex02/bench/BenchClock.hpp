@@ -0,0 +1,7 @@
+#ifndef BENCHCLOCK_HPP
+#define BENCHCLOCK_HPP
+
+// Wall-clock time in microseconds, shared by the ex02 benchmarks.
+double nowUs(void);
+
+#endif
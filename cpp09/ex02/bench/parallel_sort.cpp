@@ -0,0 +1,57 @@
+#include "BenchClock.hpp"
+#include "ParallelFordJohnson.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdint.h>
+#include <vector>
+
+// ParallelFordJohnson at growing thread counts on 10^6 and 4 * 10^6
+// random values (or the size given as argument). The comparison count
+// is the same on every row; only the pass work is split across threads.
+
+static void runSize(size_t size)
+{
+	std::vector<int> values(size);
+	uint32_t seed = 7;
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245u + 12345u;
+		values[i] = static_cast<int>((seed >> 1) % 2147483647u) + 1;
+	}
+
+	std::cout << "ParallelFordJohnson, " << size << " values" << std::endl;
+	double single = 0.0;
+	for (size_t threads = 1; threads <= 16; threads *= 2) {
+		std::vector<size_t> order(size);
+		for (size_t i = 0; i < size; i++)
+			order[i] = i;
+		ParallelFordJohnson sorter;
+		sorter.setThreadCount(threads);
+		double start = nowUs();
+		sorter.sort(values, order);
+		double elapsed = nowUs() - start;
+		if (threads == 1)
+			single = elapsed;
+		bool sorted = true;
+		for (size_t i = 1; i < size && sorted; i++)
+			sorted = values[order[i - 1]] <= values[order[i]];
+		std::cout << "  " << std::setw(2) << threads << " threads  " << std::fixed
+			<< std::setprecision(1) << std::setw(8) << elapsed / 1000.0 << " ms  "
+			<< std::setprecision(2) << single / elapsed << "x  "
+			<< sorter.comparisons() << " comparisons"
+			<< (sorted ? "" : "  NOT SORTED") << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1) {
+		size_t size = static_cast<size_t>(std::strtoul(argv[1], NULL, 10));
+		runSize(size == 0 ? 1 : size);
+		return 0;
+	}
+	runSize(1000000);
+	runSize(4000000);
+	return 0;
+}
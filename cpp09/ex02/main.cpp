@@ -1,15 +1,32 @@
 #include "PmergeMe.hpp"
 
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <string>
 
+// ./PmergeMe [--threads=N] numbers... sorts the std::vector copy with N
+// threads; the output is the same at every thread count.
 int main(int argc, char** argv) {
+	PmergeMe sorter;
+	if (argc >= 2 && std::string(argv[1]).compare(0, 10, "--threads=") == 0) {
+		const char* digits = argv[1] + 10;
+		char* end = NULL;
+		unsigned long threads = std::strtoul(digits, &end, 10);
+		if (*digits == '\0' || *end != '\0' || threads == 0) {
+			std::cerr << "Error" << std::endl;
+			return 1;
+		}
+		sorter.setThreadCount(threads);
+		argv[1] = argv[0];
+		argc--;
+		argv++;
+	}
 	if (argc < 2) {
 		std::cerr << "Error" << std::endl;
 		return 1;
 	}
 	try {
-		PmergeMe sorter;
 		sorter.parseInput(argc, argv);
 		sorter.displayBefore();
 		sorter.sortVector();
@@ -4,6 +4,7 @@ set -uo pipefail
 
 ROOT=$(CDPATH= cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)
 TESTS="$ROOT/tests/cpp05_09"
+TEST_SUPPORT="$TESTS/TestSupport.cpp"
 if ! RUN_DIR=$(mktemp -d "${TMPDIR:-/tmp}/cpp05-09-verify.XXXXXX"); then
 	printf 'Error: could not create verification directory.\n' >&2
 	exit 1
@@ -191,10 +192,10 @@ while IFS= read -r header; do
 done < <(find "$ROOT/cpp05" "$ROOT/cpp06" "$ROOT/cpp07" \
 	"$ROOT/cpp08" "$ROOT/cpp09" -type f -name '*.hpp' | sort)
 
-if [[ $header_count -eq 26 ]]; then
-	pass 'header inventory 26'
+if [[ $header_count -eq 46 ]]; then
+	pass 'header inventory 46'
 else
-	fail "header inventory expected 26 got $header_count"
+	fail "header inventory expected 46 got $header_count"
 fi
 
 cd "$RUN_DIR" || exit 1
@@ -298,11 +299,277 @@ else
 	fail 'cpp08 ex01 single-pass harness compile'
 fi
 
+RPN_SOURCES=("$ROOT/cpp09/ex01/BigInt.cpp" "$ROOT/cpp09/ex01/CheckedInt.cpp"
+	"$ROOT/cpp09/ex01/OperandStack.cpp" "$ROOT/cpp09/ex01/RPN.cpp"
+	"$ROOT/cpp09/ex01/RPNProgram.cpp")
+
 expect_compile_failure 'cpp09 RPN reset is not public' \
 	c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex01" \
-	"$TESTS/rpn_access.cpp" "$ROOT/cpp09/ex01/RPN.cpp" \
+	"$TESTS/rpn_access.cpp" "${RPN_SOURCES[@]}" \
 	-o "$RUN_DIR/rpn_access"
 
+BTC_SOURCES=("$ROOT/cpp09/ex00/AssetRateStore.cpp" "$ROOT/cpp09/ex00/BitcoinExchange.cpp"
+	"$ROOT/cpp09/ex00/DecimalParser.cpp" "$ROOT/cpp09/ex00/LineRing.cpp"
+	"$ROOT/cpp09/ex00/LineScanner.cpp" "$ROOT/cpp09/ex00/LiveRateTable.cpp"
+	"$ROOT/cpp09/ex00/MappedFile.cpp" "$ROOT/cpp09/ex00/PipelineStats.cpp"
+	"$ROOT/cpp09/ex00/RangeIndex.cpp" "$ROOT/cpp09/ex00/RateTable.cpp"
+	"$ROOT/cpp09/common/OutputBuffer.cpp" "$ROOT/cpp09/common/TaskFailure.cpp")
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/common" \
+	"$TESTS/output_buffer.cpp" "$TEST_SUPPORT" "$ROOT/cpp09/common/OutputBuffer.cpp" \
+	-o "$RUN_DIR/output_buffer"; then
+	if "$RUN_DIR/output_buffer"; then
+		pass 'cpp09 OutputBuffer matches ostream formatting'
+	else
+		fail 'cpp09 OutputBuffer matches ostream formatting'
+	fi
+else
+	fail 'cpp09 OutputBuffer harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/common" \
+	"$TESTS/task_failure.cpp" "$ROOT/cpp09/common/TaskFailure.cpp" \
+	-o "$RUN_DIR/task_failure"; then
+	if "$RUN_DIR/task_failure"; then
+		pass 'cpp09 TaskFailure rethrows the captured exception family'
+	else
+		fail 'cpp09 TaskFailure rethrows the captured exception family'
+	fi
+else
+	fail 'cpp09 TaskFailure harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex00" -I"$ROOT/cpp09/common" \
+	"$TESTS/btc_load.cpp" "$TEST_SUPPORT" "${BTC_SOURCES[@]}" -o "$RUN_DIR/btc_load"; then
+	if "$RUN_DIR/btc_load"; then
+		pass 'cpp09 ex00 mapped database loader'
+	else
+		fail 'cpp09 ex00 mapped database loader'
+	fi
+else
+	fail 'cpp09 ex00 mapped database loader harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex00" -I"$ROOT/cpp09/common" \
+	"$TESTS/btc_snapshot.cpp" "$TEST_SUPPORT" "${BTC_SOURCES[@]}" -o "$RUN_DIR/btc_snapshot"; then
+	if "$RUN_DIR/btc_snapshot"; then
+		pass 'cpp09 ex00 binary snapshot warm start and rebuild'
+	else
+		fail 'cpp09 ex00 binary snapshot warm start and rebuild'
+	fi
+else
+	fail 'cpp09 ex00 binary snapshot harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -O2 -I"$ROOT/cpp09/ex00" \
+	"$TESTS/btc_date.cpp" "$ROOT/cpp09/ex00/RateTable.cpp" "$ROOT/cpp09/ex00/MappedFile.cpp" \
+	"$ROOT/cpp09/ex00/RangeIndex.cpp" \
+	-o "$RUN_DIR/btc_date"; then
+	if "$RUN_DIR/btc_date"; then
+		pass 'cpp09 ex00 date decoder matches substr/atoi validation'
+	else
+		fail 'cpp09 ex00 date decoder matches substr/atoi validation'
+	fi
+else
+	fail 'cpp09 ex00 date decoder harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex00" \
+	"$TESTS/btc_stream.cpp" "$ROOT/cpp09/ex00/LineRing.cpp" -o "$RUN_DIR/btc_stream"; then
+	if "$RUN_DIR/btc_stream"; then
+		pass 'cpp09 ex00 ring buffer splits wrapped and overlong lines'
+	else
+		fail 'cpp09 ex00 ring buffer splits wrapped and overlong lines'
+	fi
+else
+	fail 'cpp09 ex00 ring buffer harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex00" -I"$ROOT/cpp09/common" \
+	"$TESTS/btc_batch.cpp" "${BTC_SOURCES[@]}" -o "$RUN_DIR/btc_batch"; then
+	if "$RUN_DIR/btc_batch"; then
+		pass 'cpp09 ex00 batch lookup matches per-query find'
+	else
+		fail 'cpp09 ex00 batch lookup matches per-query find'
+	fi
+else
+	fail 'cpp09 ex00 batch lookup harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -pthread -I"$ROOT/cpp09/ex00" -I"$ROOT/cpp09/common" \
+	"$TESTS/btc_live.cpp" "${BTC_SOURCES[@]}" -o "$RUN_DIR/btc_live"; then
+	if "$RUN_DIR/btc_live"; then
+		pass 'cpp09 ex00 live rate updates under concurrent readers'
+	else
+		fail 'cpp09 ex00 live rate updates under concurrent readers'
+	fi
+else
+	fail 'cpp09 ex00 live rate update harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex00" \
+	"$TESTS/btc_scan.cpp" "$ROOT/cpp09/ex00/LineScanner.cpp" -o "$RUN_DIR/btc_scan"; then
+	if "$RUN_DIR/btc_scan"; then
+		pass 'cpp09 ex00 block line scanner matches per-line split on every kernel'
+	else
+		fail 'cpp09 ex00 block line scanner matches per-line split on every kernel'
+	fi
+else
+	fail 'cpp09 ex00 block line scanner harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -pthread -I"$ROOT/cpp09/ex00" -I"$ROOT/cpp09/common" \
+	"$TESTS/btc_stats.cpp" "$TEST_SUPPORT" "${BTC_SOURCES[@]}" -o "$RUN_DIR/btc_stats"; then
+	if "$RUN_DIR/btc_stats"; then
+		pass 'cpp09 ex00 pipeline statistics count every outcome'
+	else
+		fail 'cpp09 ex00 pipeline statistics count every outcome'
+	fi
+else
+	fail 'cpp09 ex00 pipeline statistics harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex00" \
+	"$TESTS/btc_decimal.cpp" "$TEST_SUPPORT" "$ROOT/cpp09/ex00/DecimalParser.cpp" -o "$RUN_DIR/btc_decimal"; then
+	if "$RUN_DIR/btc_decimal"; then
+		pass 'cpp09 ex00 decimal parser matches strtod bit for bit'
+	else
+		fail 'cpp09 ex00 decimal parser matches strtod bit for bit'
+	fi
+else
+	fail 'cpp09 ex00 decimal parser harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -pthread -I"$ROOT/cpp09/ex00" -I"$ROOT/cpp09/common" \
+	"$TESTS/btc_assets.cpp" "$TEST_SUPPORT" "${BTC_SOURCES[@]}" -o "$RUN_DIR/btc_assets"; then
+	if "$RUN_DIR/btc_assets"; then
+		pass 'cpp09 ex00 compressed asset store matches per-asset tables'
+	else
+		fail 'cpp09 ex00 compressed asset store matches per-asset tables'
+	fi
+else
+	fail 'cpp09 ex00 compressed asset store harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -pthread -I"$ROOT/cpp09/ex00" -I"$ROOT/cpp09/common" \
+	"$TESTS/btc_range.cpp" "$TEST_SUPPORT" "${BTC_SOURCES[@]}" -o "$RUN_DIR/btc_range"; then
+	if "$RUN_DIR/btc_range"; then
+		pass 'cpp09 ex00 range aggregates match brute force exactly'
+	else
+		fail 'cpp09 ex00 range aggregates match brute force exactly'
+	fi
+else
+	fail 'cpp09 ex00 range aggregates harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex01" \
+	"$TESTS/rpn_bignum.cpp" "$TEST_SUPPORT" "${RPN_SOURCES[@]}" -o "$RUN_DIR/rpn_bignum"; then
+	if "$RUN_DIR/rpn_bignum"; then
+		pass 'cpp09 ex01 bignum arithmetic and Karatsuba match references'
+	else
+		fail 'cpp09 ex01 bignum arithmetic and Karatsuba match references'
+	fi
+else
+	fail 'cpp09 ex01 bignum harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex01" \
+	"$TESTS/rpn_program.cpp" "$TEST_SUPPORT" "${RPN_SOURCES[@]}" -o "$RUN_DIR/rpn_program"; then
+	if "$RUN_DIR/rpn_program"; then
+		pass 'cpp09 ex01 compiled programs match evaluate'
+	else
+		fail 'cpp09 ex01 compiled programs match evaluate'
+	fi
+else
+	fail 'cpp09 ex01 compiled program harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex01" \
+	"$TESTS/rpn_columns.cpp" "$TEST_SUPPORT" "${RPN_SOURCES[@]}" -o "$RUN_DIR/rpn_columns"; then
+	if "$RUN_DIR/rpn_columns"; then
+		pass 'cpp09 ex01 column batches match per-row runs'
+	else
+		fail 'cpp09 ex01 column batches match per-row runs'
+	fi
+else
+	fail 'cpp09 ex01 column batch harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex01" \
+	"$TESTS/rpn_operand_stack.cpp" "${RPN_SOURCES[@]}" -o "$RUN_DIR/rpn_operand_stack"; then
+	if "$RUN_DIR/rpn_operand_stack"; then
+		pass 'cpp09 ex01 contiguous operand stack'
+	else
+		fail 'cpp09 ex01 contiguous operand stack'
+	fi
+else
+	fail 'cpp09 ex01 operand stack harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex01" \
+	"$TESTS/rpn_infix.cpp" "$TEST_SUPPORT" "${RPN_SOURCES[@]}" -o "$RUN_DIR/rpn_infix"; then
+	if "$RUN_DIR/rpn_infix"; then
+		pass 'cpp09 ex01 folded infix programs match a tree evaluator'
+	else
+		fail 'cpp09 ex01 folded infix programs match a tree evaluator'
+	fi
+else
+	fail 'cpp09 ex01 infix harness compile'
+fi
+
+for checked_mode in builtins portable; do
+	checked_flags=()
+	if [[ $checked_mode == portable ]]; then
+		checked_flags=(-DCHECKEDINT_PORTABLE)
+	fi
+	if c++ -std=c++98 -Wall -Wextra -Werror "${checked_flags[@]}" -I"$ROOT/cpp09/ex01" \
+		"$TESTS/rpn_checked.cpp" "$TEST_SUPPORT" "$ROOT/cpp09/ex01/CheckedInt.cpp" \
+		-o "$RUN_DIR/rpn_checked_$checked_mode"; then
+		if "$RUN_DIR/rpn_checked_$checked_mode"; then
+			pass "cpp09 ex01 checked arithmetic ($checked_mode) matches 64-bit results"
+		else
+			fail "cpp09 ex01 checked arithmetic ($checked_mode) matches 64-bit results"
+		fi
+	else
+		fail "cpp09 ex01 checked arithmetic ($checked_mode) harness compile"
+	fi
+done
+
+if c++ -std=c++98 -Wall -Wextra -Werror -I"$ROOT/cpp09/ex01" \
+	"$TESTS/rpn_status.cpp" "$TEST_SUPPORT" "${RPN_SOURCES[@]}" -o "$RUN_DIR/rpn_status"; then
+	if "$RUN_DIR/rpn_status"; then
+		pass 'cpp09 ex01 status codes match the throwing evaluator'
+	else
+		fail 'cpp09 ex01 status codes match the throwing evaluator'
+	fi
+else
+	fail 'cpp09 ex01 status harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -pthread -I"$ROOT/cpp09/ex01" -I"$ROOT/cpp09/common" \
+	"$TESTS/rpn_batch.cpp" "$TEST_SUPPORT" "${RPN_SOURCES[@]}" "$ROOT/cpp09/ex01/RPNBatch.cpp" \
+	"$ROOT/cpp09/common/OutputBuffer.cpp" "$ROOT/cpp09/common/TaskFailure.cpp" \
+	-o "$RUN_DIR/rpn_batch"; then
+	if "$RUN_DIR/rpn_batch"; then
+		pass 'cpp09 ex01 batch output is ordered at every thread count'
+	else
+		fail 'cpp09 ex01 batch output is ordered at every thread count'
+	fi
+else
+	fail 'cpp09 ex01 batch harness compile'
+fi
+
+if c++ -std=c++98 -Wall -Wextra -Werror -pthread -I"$ROOT/cpp09/ex02" \
+	"$TESTS/pmerge_parallel.cpp" "$TEST_SUPPORT" "$ROOT/cpp09/ex02/ParallelFordJohnson.cpp" \
+	"$ROOT/cpp09/ex02/PmergeMe.cpp" -o "$RUN_DIR/pmerge_parallel"; then
+	if "$RUN_DIR/pmerge_parallel"; then
+		pass 'cpp09 ex02 parallel sort makes the sequential comparisons'
+	else
+		fail 'cpp09 ex02 parallel sort makes the sequential comparisons'
+	fi
+else
+	fail 'cpp09 ex02 parallel sort harness compile'
+fi
+
 scalar_static_count=$(grep -Ec '^[[:space:]]*static[[:space:]]' \
 	"$ROOT/cpp06/ex00/ScalarConverter.hpp")
 if [[ $scalar_static_count -eq 1 ]]; then
@@ -341,6 +608,18 @@ expect_error 'RPN rejects malformed expression' 'Error' "$ROOT/cpp09/ex01/RPN" '
 expect_error 'RPN rejects division by zero' 'Error' "$ROOT/cpp09/ex01/RPN" '1 0 /'
 expect_error 'RPN rejects integer overflow' 'Error' "$ROOT/cpp09/ex01/RPN" \
 	'9 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 *'
+expect_exact 'RPN --bignum keeps the overflowing product' '3486784401' "$ROOT/cpp09/ex01/RPN" \
+	--bignum '9 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 *'
+expect_error 'RPN --bignum rejects division by zero' 'Error' "$ROOT/cpp09/ex01/RPN" --bignum '1 0 /'
+printf '8 9 * 9 - 9 - 9 - 4 - 1 +\n1 0 /\n7 7 * 7 -\n' > "$RUN_DIR/rpn_batch.txt"
+batch_output=$("$ROOT/cpp09/ex01/RPN" --batch --threads=2 "$RUN_DIR/rpn_batch.txt" 2>&1)
+batch_status=$?
+if [[ $batch_status -ne 0 && "$batch_output" == $'42\nError\n42' ]]; then
+	pass 'RPN --batch keeps input order past errors'
+else
+	fail 'RPN --batch keeps input order past errors'
+	printf 'status=%s output=[%s]\n' "$batch_status" "$batch_output"
+fi
 
 expect_error 'PmergeMe rejects zero' 'Error' "$ROOT/cpp09/ex02/PmergeMe" 0 1
 expect_error 'PmergeMe rejects negative' 'Error' "$ROOT/cpp09/ex02/PmergeMe" 1 -2
@@ -351,6 +630,10 @@ expect_contains 'PmergeMe two values' 'After:  1 2' "$ROOT/cpp09/ex02/PmergeMe"
 expect_contains 'PmergeMe accepts explicit plus' 'After:  1 2 3' "$ROOT/cpp09/ex02/PmergeMe" +3 1 2
 expect_contains 'PmergeMe sorted input' 'After:  1 2 3 4 5' "$ROOT/cpp09/ex02/PmergeMe" 1 2 3 4 5
 expect_contains 'PmergeMe duplicates' 'After:  1 3 5 5' "$ROOT/cpp09/ex02/PmergeMe" 5 3 5 1
+expect_contains 'PmergeMe --threads subject' 'After:  1 3 4 5 7 9' \
+	"$ROOT/cpp09/ex02/PmergeMe" --threads=4 3 5 9 7 4 1
+expect_error 'PmergeMe rejects --threads=0' 'Error' "$ROOT/cpp09/ex02/PmergeMe" --threads=0 1 2
+expect_error 'PmergeMe --threads needs values' 'Error' "$ROOT/cpp09/ex02/PmergeMe" --threads=2
 
 descending=()
 expected_values=()
@@ -423,6 +706,36 @@ else
 	printf '%s\n' "$btc_output"
 fi
 
+btc_bulk="$RUN_DIR/btc_bulk.txt"
+for ((i = 0; i < 1000; i++)); do
+	cat "$TESTS/btc_edge.txt" "$ROOT/cpp09/ex00/input.txt"
+done > "$btc_bulk"
+if run_btc "$btc_bulk" >"$RUN_DIR/btc_serial.out" 2>&1 && \
+	(cd "$ROOT/cpp09/ex00" && ./btc --threads=4 "$btc_bulk") \
+	>"$RUN_DIR/btc_parallel.out" 2>&1 && \
+	cmp -s "$RUN_DIR/btc_serial.out" "$RUN_DIR/btc_parallel.out"; then
+	pass 'btc parallel output matches serial'
+else
+	fail 'btc parallel output matches serial'
+fi
+
+if cat "$btc_bulk" | (cd "$ROOT/cpp09/ex00" && ./btc --db=data.csv -) \
+	>"$RUN_DIR/btc_stream.out" 2>&1 && \
+	cmp -s "$RUN_DIR/btc_serial.out" "$RUN_DIR/btc_stream.out"; then
+	pass 'btc stdin stream matches file input'
+else
+	fail 'btc stdin stream matches file input'
+fi
+
+if (cd "$ROOT/cpp09/ex00" && ./btc --stats "$btc_bulk") \
+	>"$RUN_DIR/btc_stats.out" 2>"$RUN_DIR/btc_stats.err" && \
+	cmp -s "$RUN_DIR/btc_serial.out" "$RUN_DIR/btc_stats.out" && \
+	grep -q 'lines/s' "$RUN_DIR/btc_stats.err"; then
+	pass 'btc --stats reports on stderr and leaves stdout unchanged'
+else
+	fail 'btc --stats reports on stderr and leaves stdout unchanged'
+fi
+
 # Subject-example conformance and static policy checks (frozen against
 # official subject PDFs; do not edit expected strings without re-reading
 # the PDF).
@@ -439,6 +752,10 @@ expect_exact 'RPN subject example 3' '0' "$ROOT/cpp09/ex01/RPN" '1 2 * 2 / 2 * 2
 expect_error 'RPN rejects parenthesized infix' 'Error' "$ROOT/cpp09/ex01/RPN" '(1 + 1)'
 expect_error 'btc requires input file argument' 'Error: could not open file.' "$ROOT/cpp09/ex00/btc"
 expect_error 'btc missing input file' 'Error: could not open file.' run_btc missing-input.txt
+expect_error 'btc rejects a second file argument' 'Error: could not open file.' \
+	"$ROOT/cpp09/ex00/btc" a b
+expect_error 'btc rejects negative --threads' 'Error: invalid option: --threads=-1' \
+	"$ROOT/cpp09/ex00/btc" --threads=-1 "$ROOT/cpp09/ex00/input.txt"
 if "$ROOT/cpp09/ex02/PmergeMe" 3 5 9 7 4 >"$RUN_DIR/pmerge_subject.out" 2>&1 && \
 	[[ "$(wc -l < "$RUN_DIR/pmerge_subject.out" | tr -d '[:space:]')" == 4 ]] && \
 	sed -n '1p' "$RUN_DIR/pmerge_subject.out" | grep -qx 'Before: 3 5 9 7 4' && \
@@ -0,0 +1,24 @@
+#include "TestSupport.hpp"
+
+#include <fstream>
+
+static uint64_t g_state = 88172645463325252u;
+
+uint64_t nextRandomBits(void)
+{
+	g_state ^= g_state << 13;
+	g_state ^= g_state >> 7;
+	g_state ^= g_state << 17;
+	return g_state;
+}
+
+uint32_t nextRandom(void)
+{
+	return static_cast<uint32_t>(nextRandomBits() >> 32);
+}
+
+void writeFile(const char* name, const std::string& content)
+{
+	std::ofstream out(name, std::ios::out | std::ios::binary);
+	out << content;
+}
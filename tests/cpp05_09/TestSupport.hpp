@@ -0,0 +1,15 @@
+#ifndef TESTSUPPORT_HPP
+#define TESTSUPPORT_HPP
+
+#include <stdint.h>
+#include <string>
+
+// Helpers shared by the tests. The xorshift64 generator has a fixed seed,
+// so every run replays the same random cases.
+uint64_t nextRandomBits(void);
+uint32_t nextRandom(void);
+
+// Replaces the file with exactly `content`.
+void writeFile(const char* name, const std::string& content);
+
+#endif
@@ -0,0 +1,169 @@
+#include "AssetRateStore.hpp"
+#include "BitcoinExchange.hpp"
+#include "RateTable.hpp"
+#include "TestSupport.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Rates with few changing bits, a repeated value, and full-width noise.
+static double randomRate(double previous)
+{
+	switch (nextRandom() % 4) {
+	case 0:
+		return previous;
+	case 1:
+		return static_cast<double>(nextRandom() % 100000) / 100.0;
+	case 2:
+		return previous + 0.01;
+	default:
+		return static_cast<double>(nextRandom()) * 1e-5 / 3.0;
+	}
+}
+
+// The store answers like one RateTable per asset, bit for bit.
+static bool matchesTables(const AssetRateStore& store, const std::vector<RateTable>& tables,
+	int firstDay, int lastDay)
+{
+	for (int day = firstDay - 3; day <= lastDay + 3; day++) {
+		for (size_t asset = 0; asset < tables.size(); asset++) {
+			double expected = 0.0;
+			double rate = 0.0;
+			bool found = tables[asset].find(day, expected);
+			if (store.find(asset, day, rate) != found)
+				return false;
+			if (found && std::memcmp(&rate, &expected, sizeof(rate)) != 0)
+				return false;
+		}
+	}
+	return true;
+}
+
+static int expectFormatError(const std::string& content)
+{
+	writeFile("btc_assets.csv", content);
+	BitcoinExchange exchange;
+	try {
+		exchange.loadAssetDatabase("btc_assets.csv");
+	} catch (const BitcoinExchange::InvalidFormatException&) {
+		return 0;
+	}
+	return 1;
+}
+
+int main()
+{
+	AssetRateStore store;
+	std::vector<RateTable> tables(7);
+	for (size_t asset = 0; asset < tables.size(); asset++) {
+		std::string name = "A";
+		name += static_cast<char>('0' + asset);
+		if (store.addAsset(name) != asset)
+			return 1;
+	}
+	int firstDay = 5000;
+	int lastDay = firstDay;
+	for (size_t asset = 0; asset < tables.size(); asset++) {
+		if (asset == 6)
+			continue;
+		double rate = 1.0;
+		int day = firstDay + static_cast<int>(nextRandom() % 200);
+		// Asset 5 is sparse; the others skip a few days now and then.
+		for (int count = 0; count < 700; count++) {
+			day += asset == 5 ? 1 + static_cast<int>(nextRandom() % 40)
+				: 1 + static_cast<int>(nextRandom() % 3 == 0);
+			rate = randomRate(rate);
+			store.append(asset, day, rate);
+			tables[asset].append(day, rate);
+			if (nextRandom() % 10 == 0) {
+				rate = randomRate(rate);
+				store.append(asset, day, rate);
+				tables[asset].append(day, rate);
+			}
+			if (day > lastDay)
+				lastDay = day;
+		}
+	}
+	for (size_t asset = 0; asset < tables.size(); asset++)
+		tables[asset].finalize();
+	store.finalize();
+	if (!matchesTables(store, tables, firstDay, lastDay))
+		return 2;
+	if (store.compressedBytes() >= store.rows() * tables.size() * sizeof(double))
+		return 3;
+	double unused;
+	if (store.find(6, lastDay, unused) || store.find(7, lastDay, unused))
+		return 4;
+
+	// Appending to a finalized store keeps every earlier answer.
+	store.append(0, firstDay - 100, 0.25);
+	store.append(6, lastDay, 9.5);
+	store.append(3, lastDay + 1, 3.75);
+	tables[0].append(firstDay - 100, 0.25);
+	tables[6].append(lastDay, 9.5);
+	tables[3].append(lastDay + 1, 3.75);
+	for (size_t asset = 0; asset < tables.size(); asset++)
+		tables[asset].finalize();
+	store.finalize();
+	if (!matchesTables(store, tables, firstDay - 100, lastDay + 1))
+		return 5;
+
+	AssetRateStore copy(store);
+	AssetRateStore assigned;
+	assigned = copy;
+	store.clear();
+	if (!matchesTables(assigned, tables, firstDay - 100, lastDay + 1) || store.rows() != 0)
+		return 6;
+
+	writeFile("btc_assets.csv",
+		"date, BTC ,ETH,XAU\r\n"
+		"2010-01-01,1.5,,1200\r\n"
+		"\r\n"
+		" 2010-01-03 ,2,10\n"
+		"2010-01-03,4,,\n"
+		"2010-01-09,,+.5e1,1300.25\n");
+	BitcoinExchange exchange;
+	exchange.loadAssetDatabase("btc_assets.csv");
+	if (exchange.getAssetRate("BTC", "2010-01-01") != 1.5
+		|| exchange.getAssetRate("BTC", "2011-01-01") != 4
+		|| exchange.getAssetRate("ETH", "2010-01-08") != 10
+		|| exchange.getAssetRate("ETH", "2010-01-09") != 5
+		|| exchange.getAssetRate("XAU", "2010-01-08") != 1200
+		|| exchange.getAssetRate("XAU", "2010-01-09") != 1300.25)
+		return 7;
+	try {
+		exchange.getAssetRate("ETH", "2010-01-02");
+		return 8;
+	} catch (const BitcoinExchange::InvalidValueException&) {
+	}
+	try {
+		exchange.getAssetRate("DOGE", "2010-01-02");
+		return 9;
+	} catch (const BitcoinExchange::InvalidValueException&) {
+	}
+
+	if (expectFormatError("day,BTC\n2010-01-01,1\n") != 0)
+		return 10;
+	if (expectFormatError("date,BTC,BTC\n2010-01-01,1,2\n") != 0)
+		return 11;
+	if (expectFormatError("date,BTC\n2010-02-30,1\n") != 0)
+		return 12;
+	if (expectFormatError("date,BTC\n2010-01-01,1.5x\n") != 0)
+		return 13;
+	if (expectFormatError("date,BTC\n2010-01-01,1,2\n") != 0)
+		return 14;
+	if (expectFormatError("") != 0)
+		return 15;
+
+	// A failed load keeps the histories already loaded.
+	writeFile("btc_assets.csv", "date,BTC\n2010-01-01,-0.5\n");
+	try {
+		exchange.loadAssetDatabase("btc_assets.csv");
+		return 16;
+	} catch (const BitcoinExchange::InvalidValueException&) {
+	}
+	if (exchange.getAssetRate("BTC", "2010-01-01") != 1.5)
+		return 17;
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include "BitcoinExchange.hpp"
+#include "RateTable.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Checks findBatch against find() for one batch; returns false on any
+// difference in the resolved prefix or the rates within it.
+static bool matchesFind(const RateTable& table, const std::vector<int>& days)
+{
+	std::vector<double> rates(days.size() + 1, -1.0);
+	size_t resolved = table.findBatch(days.empty() ? NULL : &days[0], days.size(), &rates[0]);
+	for (size_t i = 0; i < days.size(); i++) {
+		double rate;
+		if (!table.find(days[i], rate))
+			return resolved == i;
+		if (rates[i] != rate)
+			return false;
+	}
+	return resolved == days.size();
+}
+
+int main()
+{
+	std::srand(11);
+	RateTable table;
+	int day = 1000;
+	for (int i = 0; i < 5000; i++) {
+		day += 1 + std::rand() % 40;
+		table.append(day, i * 0.5);
+	}
+	table.finalize();
+
+	for (int round = 0; round < 200; round++) {
+		std::vector<int> days;
+		size_t count = static_cast<size_t>(std::rand() % 3000);
+		for (size_t i = 0; i < count; i++)
+			days.push_back(1010 + std::rand() % (day + 500 - 1010));
+		std::sort(days.begin(), days.end());
+		if (!matchesFind(table, days))
+			return 1;
+		for (size_t i = 0; i + 1 < days.size(); i += 1 + static_cast<size_t>(std::rand() % 20))
+			std::swap(days[i], days[i + 1]);
+		if (!matchesFind(table, days))
+			return 2;
+		std::random_shuffle(days.begin(), days.end());
+		if (!matchesFind(table, days))
+			return 3;
+	}
+
+	std::vector<int> early(3, 2000);
+	early[1] = 999;
+	if (!matchesFind(table, early))
+		return 4;
+	RateTable empty;
+	if (!matchesFind(empty, early))
+		return 5;
+
+	std::ofstream csv("btc_batch.csv");
+	csv << "date,exchange_rate\n2010-01-01,1\n2010-02-01,2\n2010-03-01,3\n";
+	csv.close();
+	BitcoinExchange exchange;
+	exchange.loadDatabase("btc_batch.csv");
+	exchange.setDenseIndex(false);
+	std::vector<std::string> dates;
+	dates.push_back("2010-01-15");
+	dates.push_back("2010-02-01");
+	dates.push_back("2011-01-01");
+	dates.push_back("2010-01-01");
+	std::vector<double> rates(6, -1);
+	exchange.getExchangeRates(&dates[0], dates.size(), &rates[0]);
+	if (rates[0] != 1 || rates[1] != 2 || rates[2] != 3 || rates[3] != 1)
+		return 6;
+	dates.push_back("2009-12-31");
+	dates.push_back("2010-13-01");
+	try {
+		exchange.getExchangeRates(&dates[0], dates.size(), &rates[0]);
+		return 7;
+	} catch (const BitcoinExchange::InvalidValueException& e) {
+		if (std::string(e.what()).find("2009-12-31") == std::string::npos)
+			return 8;
+	}
+	// An empty batch touches neither array.
+	exchange.getExchangeRates(NULL, 0, NULL);
+	return 0;
+}
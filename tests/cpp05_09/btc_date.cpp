@@ -0,0 +1,80 @@
+#include "RateTable.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+
+// The substr/atoi validation RateTable::decodeDate replaced.
+static bool legacyDecode(const std::string& date, int& day)
+{
+	if (date.length() != 10 || date[4] != '-' || date[7] != '-')
+		return false;
+	for (int i = 0; i < 10; i++) {
+		if (i == 4 || i == 7)
+			continue;
+		if (!std::isdigit(static_cast<unsigned char>(date[i])))
+			return false;
+	}
+	int year = std::atoi(date.substr(0, 4).c_str());
+	int month = std::atoi(date.substr(5, 2).c_str());
+	int dayOfMonth = std::atoi(date.substr(8, 2).c_str());
+	if (year < 1 || month < 1 || month > 12)
+		return false;
+	int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	if ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)
+		daysInMonth[1] = 29;
+	if (dayOfMonth < 1 || dayOfMonth > daysInMonth[month - 1])
+		return false;
+	day = RateTable::dayNumber(year, month, dayOfMonth);
+	return true;
+}
+
+static bool agrees(const std::string& text)
+{
+	int expected = 0;
+	int actual = 0;
+	bool legacy = legacyDecode(text, expected);
+	if (RateTable::decodeDate(text.data(), text.size(), actual) != legacy)
+		return false;
+	return !legacy || actual == expected;
+}
+
+int main()
+{
+	char text[11] = "0000-00-00";
+	for (int year = 0; year <= 9999; year++) {
+		for (int month = 0; month <= 13; month++) {
+			for (int day = 0; day <= 32; day++) {
+				text[0] = static_cast<char>('0' + year / 1000);
+				text[1] = static_cast<char>('0' + year / 100 % 10);
+				text[2] = static_cast<char>('0' + year / 10 % 10);
+				text[3] = static_cast<char>('0' + year % 10);
+				text[5] = static_cast<char>('0' + month / 10);
+				text[6] = static_cast<char>('0' + month % 10);
+				text[8] = static_cast<char>('0' + day / 10);
+				text[9] = static_cast<char>('0' + day % 10);
+				if (!agrees(std::string(text, 10)))
+					return 1;
+			}
+		}
+	}
+
+	std::srand(7);
+	const char alphabet[] = "0123456789-/ +x\t";
+	for (int i = 0; i < 200000; i++) {
+		std::string fuzz("2012-02-29");
+		fuzz[static_cast<size_t>(std::rand() % 10)] = alphabet[std::rand() % 16];
+		if (std::rand() % 8 == 0)
+			fuzz.erase(static_cast<size_t>(std::rand() % 10), 1);
+		if (!agrees(fuzz))
+			return 2;
+	}
+
+	int day = 0;
+	if (!RateTable::decodeDate("1970-01-01", 10, day) || day != 0)
+		return 3;
+	if (RateTable::decodeDate("1970-01-01x", 11, day)
+		|| RateTable::decodeDate("1970-01-0", 9, day))
+		return 4;
+	return 0;
+}
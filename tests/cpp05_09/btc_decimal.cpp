@@ -0,0 +1,142 @@
+#include "DecimalParser.hpp"
+#include "TestSupport.hpp"
+
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <string>
+
+// Same verdict and same bits as strtod consuming the whole text.
+static bool agrees(const std::string& text)
+{
+	char* end = NULL;
+	double expected = std::strtod(text.c_str(), &end);
+	bool accepted = end == text.c_str() + text.size() && !text.empty()
+		&& expected - expected == 0.0;
+	double value = 0.0;
+	if (DecimalParser::parse(text.data(), text.size(), value) != accepted)
+		return false;
+	return !accepted || std::memcmp(&value, &expected, sizeof(value)) == 0;
+}
+
+static std::string randomDigits(size_t count)
+{
+	std::string digits;
+	for (size_t i = 0; i < count; i++)
+		digits += static_cast<char>('0' + nextRandom() % 10);
+	return digits;
+}
+
+static std::string randomNumber(size_t digits)
+{
+	std::string text = nextRandom() % 4 == 0 ? "-" : "";
+	std::string mantissa = randomDigits(digits);
+	size_t point = nextRandom() % (digits + 1);
+	text += mantissa.substr(0, point);
+	if (point < digits || nextRandom() % 2 == 0)
+		text += "." + mantissa.substr(point);
+	if (text.find_first_of("0123456789") == std::string::npos)
+		text += "0";
+	char exponent[16];
+	std::sprintf(exponent, "e%d", static_cast<int>(nextRandom() % 700) - 360);
+	return text + exponent;
+}
+
+// The exact decimal expansion of the point halfway between a random
+// double and the next one up, and the same with a digit added or taken
+// away far past the last place. Needs a 64-bit long double mantissa.
+static bool midpointsAgree(void)
+{
+	uint64_t bits = (static_cast<uint64_t>(nextRandom()) << 32 | nextRandom())
+		& ~(static_cast<uint64_t>(1) << 63);
+	uint64_t nextBits = bits + 1;
+	double lower;
+	double upper;
+	std::memcpy(&lower, &bits, sizeof(lower));
+	std::memcpy(&upper, &nextBits, sizeof(upper));
+	if (upper - upper != 0.0)
+		return true;
+	long double middle = (static_cast<long double>(lower) + static_cast<long double>(upper)) / 2;
+	char text[1300];
+	std::sprintf(text, "%.1150Le", middle);
+	std::string exact = text;
+	size_t mark = exact.find('e');
+	size_t last = exact.find_last_not_of('0', mark - 1);
+	std::string above = exact.substr(0, last + 1) + "0001" + exact.substr(mark);
+	std::string below = exact.substr(0, last + 1) + exact.substr(mark);
+	below[last]--;
+	below.insert(last + 1, "9999");
+	return agrees(exact) && agrees(above) && agrees(below);
+}
+
+int main()
+{
+	static const char* const fixed[] = {
+		"0", "-0", "1.5", "47115.93", " 0.3", "+.5e1", "1.", ".", "", "1e", "1e+",
+		"1e309", "1.7976931348623157e308", "1.7976931348623158e308",
+		"1.7976931348623159e308", "2.4703282292062327e-324",
+		"2.4703282292062328e-324", "4.9406564584124654e-324", "1e-400",
+		"2.2250738585072011e-308", "2.2250738585072012e-308",
+		"9007199254740993", "9007199254740993.0000000000000000001",
+		"123456789012345678901234567890e-20", "1e23", "8.5e22", "1 ", "1a",
+		"00000000000000000000000000001e0", "0.000000000000000000000000000001e30",
+		"1e100000000000000000000", "1e-100000000000000000000"
+	};
+	for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+		if (!agrees(fixed[i])) {
+			std::printf("mismatch: %s\n", fixed[i]);
+			return 1;
+		}
+	}
+
+	for (int i = 0; i < 200000; i++) {
+		std::string text = randomNumber(1 + nextRandom() % 25);
+		if (!agrees(text)) {
+			std::printf("mismatch: %s\n", text.c_str());
+			return 2;
+		}
+	}
+	for (int i = 0; i < 2000; i++) {
+		std::string text = randomNumber(20 + nextRandom() % 1000);
+		if (!agrees(text)) {
+			std::printf("mismatch: %s\n", text.c_str());
+			return 3;
+		}
+	}
+
+	if (std::numeric_limits<long double>::digits >= 64) {
+		for (int i = 0; i < 20000; i++) {
+			if (!midpointsAgree())
+				return 4;
+		}
+	}
+
+	static const char alphabet[] = " +-.eE0123456789a";
+	for (int i = 0; i < 300000; i++) {
+		std::string text;
+		for (size_t length = nextRandom() % 9; length > 0; length--)
+			text += alphabet[nextRandom() % (sizeof(alphabet) - 1)];
+		if (!agrees(text)) {
+			std::printf("mismatch: '%s'\n", text.c_str());
+			return 5;
+		}
+	}
+
+	// A locale with a decimal comma changes strtod but not the parser.
+	static const char* const commaLocales[] = { "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE" };
+	for (size_t i = 0; i < sizeof(commaLocales) / sizeof(commaLocales[0]); i++) {
+		if (std::setlocale(LC_ALL, commaLocales[i]) == NULL)
+			continue;
+		double value = 0.0;
+		bool parsed = DecimalParser::parse("1.5", 3, value);
+		std::setlocale(LC_ALL, "C");
+		if (!parsed || value != 1.5)
+			return 6;
+		break;
+	}
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include "BitcoinExchange.hpp"
+#include "LiveRateTable.hpp"
+
+#include <fstream>
+#include <pthread.h>
+#include <sstream>
+#include <string>
+
+static const int UPDATES = 300;
+static const int READERS = 4;
+
+struct Reader {
+	const BitcoinExchange* exchange;
+	volatile int* stop;
+	int failures;
+	long reads;
+};
+
+// Both dates are always loaded together, so a reader must see them equal;
+// versions only grow, so neither value may go backwards.
+static void* readRates(void* argument)
+{
+	Reader* reader = static_cast<Reader*>(argument);
+	const std::string dates[2] = { "2010-01-01", "2010-01-02" };
+	double lastPair = 0;
+	double lastSingle = 0;
+	while (!__sync_fetch_and_add(reader->stop, 0)) {
+		double rates[2];
+		reader->exchange->getExchangeRates(dates, 2, rates);
+		double single = reader->exchange->getExchangeRate("2010-01-05");
+		if (rates[0] != rates[1] || rates[0] < lastPair || rates[0] > UPDATES
+			|| single < lastSingle || single > UPDATES)
+			reader->failures++;
+		lastPair = rates[0];
+		lastSingle = single;
+		reader->reads++;
+	}
+	return NULL;
+}
+
+static void writeRates(int value)
+{
+	std::ofstream csv("btc_live.csv");
+	csv << "date,exchange_rate\n2010-01-01," << value << "\n2010-01-02," << value << "\n";
+}
+
+int main()
+{
+	writeRates(0);
+	BitcoinExchange exchange;
+	exchange.loadDatabase("btc_live.csv");
+	exchange.updateRate("2010-01-05", 0);
+
+	volatile int stop = 0;
+	Reader readers[READERS];
+	pthread_t threads[READERS];
+	for (int i = 0; i < READERS; i++) {
+		readers[i].exchange = &exchange;
+		readers[i].stop = &stop;
+		readers[i].failures = 0;
+		readers[i].reads = 0;
+		if (pthread_create(&threads[i], NULL, readRates, &readers[i]) != 0)
+			return 1;
+	}
+	for (int value = 1; value <= UPDATES; value++) {
+		writeRates(value);
+		exchange.loadDatabase("btc_live.csv");
+		exchange.updateRate("2010-01-05", value);
+		exchange.setDenseIndex(value % 2 == 0);
+	}
+	__sync_fetch_and_add(&stop, 1);
+	for (int i = 0; i < READERS; i++) {
+		pthread_join(threads[i], NULL);
+		if (readers[i].failures != 0 || readers[i].reads == 0)
+			return 2;
+	}
+	if (exchange.getExchangeRate("2010-01-02") != UPDATES
+		|| exchange.getExchangeRate("2010-01-07") != UPDATES)
+		return 3;
+
+	exchange.updateRate("2010-01-02", 7);
+	if (exchange.getExchangeRate("2010-01-02") != 7
+		|| exchange.getExchangeRate("2010-01-01") != UPDATES)
+		return 4;
+	try {
+		exchange.updateRate("2010-02-30", 1);
+		return 5;
+	} catch (const BitcoinExchange::InvalidFormatException&) {
+	}
+	try {
+		exchange.updateRate("2010-02-01", -1);
+		return 6;
+	} catch (const BitcoinExchange::InvalidValueException&) {
+	}
+
+	LiveRateTable live;
+	{
+		LiveRateTable::WriteGuard update(live);
+		update.draft().append(10, 1.0);
+		update.commit();
+	}
+	LiveRateTable::ReadGuard pinned(live);
+	for (int i = 0; i < 3; i++) {
+		LiveRateTable::WriteGuard update(live);
+		update.draft().append(10, 2.0 + i);
+		update.commit();
+	}
+	double rate = 0;
+	if (!pinned.table().find(10, rate) || rate != 1.0)
+		return 7;
+	LiveRateTable::ReadGuard fresh(live);
+	if (!fresh.table().find(10, rate) || rate != 4.0)
+		return 8;
+	return 0;
+}
@@ -0,0 +1,64 @@
+#include "BitcoinExchange.hpp"
+#include "TestSupport.hpp"
+
+#include <string>
+
+static int expectFormatError(const std::string& content)
+{
+	writeFile("btc_load.csv", content);
+	BitcoinExchange exchange;
+	try {
+		exchange.loadDatabase("btc_load.csv");
+	} catch (const BitcoinExchange::InvalidFormatException&) {
+		return 0;
+	}
+	return 1;
+}
+
+int main()
+{
+	writeFile("btc_load.csv",
+		"date,exchange_rate\r\n\r\n 2010-01-01 , 1.5 \r\n"
+		"2010-01-03,2\n2010-01-03,4\n2010-01-09,+.5e1");
+	BitcoinExchange exchange;
+	exchange.loadDatabase("btc_load.csv");
+	if (exchange.getExchangeRate("2010-01-01") != 1.5)
+		return 1;
+	if (exchange.getExchangeRate("2010-01-05") != 4)
+		return 2;
+	if (exchange.getExchangeRate("2011-01-01") != 5)
+		return 3;
+	exchange.setDenseIndex(false);
+	if (exchange.getExchangeRate("2010-01-08") != 4
+		|| exchange.getExchangeRate("2011-01-01") != 5)
+		return 4;
+	exchange.setDenseIndex(true);
+	try {
+		exchange.getExchangeRate("2009-12-31");
+		return 5;
+	} catch (const BitcoinExchange::InvalidValueException&) {
+	}
+
+	if (expectFormatError("2010-01-01\n") != 0)
+		return 6;
+	if (expectFormatError("2010-02-30,1\n") != 0)
+		return 7;
+	if (expectFormatError("2010-01-01,1.5x\n") != 0)
+		return 8;
+	if (expectFormatError("2010-01-01,1e999\n") != 0)
+		return 9;
+
+	writeFile("btc_load.csv", "2010-01-01,-0.5\n");
+	try {
+		exchange.loadDatabase("btc_load.csv");
+		return 10;
+	} catch (const BitcoinExchange::InvalidValueException&) {
+	}
+
+	try {
+		exchange.loadDatabase("btc_load_missing.csv");
+		return 11;
+	} catch (const BitcoinExchange::FileException&) {
+	}
+	return 0;
+}
@@ -0,0 +1,193 @@
+#include "BitcoinExchange.hpp"
+#include "RateTable.hpp"
+#include "TestSupport.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+static bool sameBits(double left, double right)
+{
+	return std::memcmp(&left, &right, sizeof(left)) == 0;
+}
+
+struct Entry {
+	int day;
+	double rate;
+};
+
+// Brute-force answers from the sorted entries. Multiples of 1/64 below
+// 2^20 sum exactly in a double, so sum / count is the correctly rounded
+// mean.
+static bool bruteRange(const std::vector<Entry>& entries, int from, int to,
+	double& average, double& minimum, double& maximum)
+{
+	double sum = 0.0;
+	size_t count = 0;
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].day < from || entries[i].day > to)
+			continue;
+		double rate = entries[i].rate;
+		if (count == 0 || rate < minimum)
+			minimum = rate;
+		if (count == 0 || rate > maximum)
+			maximum = rate;
+		sum += rate;
+		count++;
+	}
+	if (count == 0)
+		return false;
+	average = sum / static_cast<double>(count);
+	return true;
+}
+
+static bool bruteInterpolate(const std::vector<Entry>& entries, int day, double& rate)
+{
+	if (entries.empty() || day < entries[0].day)
+		return false;
+	size_t before = 0;
+	while (before + 1 < entries.size() && entries[before + 1].day <= day)
+		before++;
+	if (entries[before].day == day || before + 1 == entries.size()) {
+		rate = entries[before].rate;
+		return true;
+	}
+	const Entry& low = entries[before];
+	const Entry& high = entries[before + 1];
+	rate = low.rate + (high.rate - low.rate) * static_cast<double>(day - low.day)
+		/ static_cast<double>(high.day - low.day);
+	return true;
+}
+
+static bool averageIs(const double* rates, size_t count, double expected)
+{
+	RateTable table;
+	for (size_t i = 0; i < count; i++)
+		table.append(static_cast<int>(i), rates[i]);
+	double scanned;
+	double indexed;
+	if (!table.rangeAverage(0, static_cast<int>(count), scanned))
+		return false;
+	table.buildRangeIndex();
+	if (!table.rangeAverage(0, static_cast<int>(count), indexed))
+		return false;
+	return sameBits(scanned, expected) && sameBits(indexed, expected);
+}
+
+int main()
+{
+	for (int round = 0; round < 40; round++) {
+		std::vector<Entry> entries;
+		RateTable table;
+		int day = static_cast<int>(nextRandom() % 1000);
+		size_t size = 1 + nextRandom() % (round < 20 ? 100 : 3000);
+		for (size_t i = 0; i < size; i++) {
+			day += 1 + static_cast<int>(nextRandom() % 5);
+			Entry entry;
+			entry.day = day;
+			entry.rate = static_cast<double>(nextRandom() % (1u << 20)) / 64.0;
+			if (round % 4 == 3 && nextRandom() % 3 == 0)
+				entry.rate = -entry.rate;
+			entries.push_back(entry);
+			table.append(entry.day, entry.rate);
+		}
+		table.finalize();
+		RateTable indexed(table);
+		indexed.buildRangeIndex();
+		int firstDay = entries.front().day - 5;
+		int span = entries.back().day + 10 - firstDay;
+
+		for (int query = 0; query < 1000; query++) {
+			int from = firstDay + static_cast<int>(nextRandom() % static_cast<uint32_t>(span));
+			int to = from + static_cast<int>(nextRandom() % static_cast<uint32_t>(span)) - span / 8;
+			double average;
+			double minimum;
+			double maximum;
+			bool expected = bruteRange(entries, from, to, average, minimum, maximum);
+			const RateTable* tables[2] = { &table, &indexed };
+			for (int t = 0; t < 2; t++) {
+				double value;
+				if (tables[t]->rangeAverage(from, to, value) != expected
+					|| (expected && !sameBits(value, average)))
+					return 1;
+				if (tables[t]->rangeMinimum(from, to, value) != expected
+					|| (expected && !sameBits(value, minimum)))
+					return 2;
+				if (tables[t]->rangeMaximum(from, to, value) != expected
+					|| (expected && !sameBits(value, maximum)))
+					return 3;
+			}
+			double rate;
+			double reference;
+			bool interpolated = bruteInterpolate(entries, from, reference);
+			if (indexed.interpolate(from, rate) != interpolated
+				|| (interpolated && !sameBits(rate, reference)))
+				return 4;
+		}
+	}
+
+	// Means a double sum would get wrong: a tie to even, cancellation
+	// across the whole exponent range, overflow and subnormals.
+	double tie[] = { 1.0 + std::ldexp(1.0, -52), 1.0 };
+	if (!averageIs(tie, 2, 1.0))
+		return 5;
+	double third[] = { 1.0, 1.0 + std::ldexp(1.0, -52), 1.0 + std::ldexp(1.0, -52) };
+	if (!averageIs(third, 3, 1.0 + std::ldexp(1.0, -52)))
+		return 6;
+	double cancel[] = { 1e300, 1e-300, -1e300 };
+	if (!averageIs(cancel, 3, 1e-300 / 3))
+		return 7;
+	double huge[] = { 1e308, 1e308, 1e308 };
+	if (!averageIs(huge, 3, 1e308))
+		return 8;
+	double tiny[] = { std::ldexp(1.0, -1074), 0.0 };
+	if (!averageIs(tiny, 2, 0.0))
+		return 9;
+	double odd[] = { std::ldexp(3.0, -1074), 0.0 };
+	if (!averageIs(odd, 2, std::ldexp(2.0, -1074)))
+		return 10;
+	double decimals[] = { 0.1, 0.2, 0.3 };
+	if (!averageIs(decimals, 3, 0.2))
+		return 11;
+
+	writeFile("btc_range.csv",
+		"date,exchange_rate\n2010-01-01,10\n2010-01-05,20\n2010-01-06,5\n2010-01-10,30\n");
+	BitcoinExchange exchange;
+	exchange.setRangeIndex(true);
+	exchange.loadDatabase("btc_range.csv");
+	BitcoinExchange scanning;
+	scanning.loadDatabase("btc_range.csv");
+	if (scanning.getAverageRate("2010-01-01", "2010-01-10") != 16.25
+		|| scanning.getMinimumRate("2010-01-02", "2010-01-31") != 5)
+		return 12;
+	if (exchange.getAverageRate("2010-01-01", "2010-01-10") != 16.25
+		|| exchange.getMinimumRate("2010-01-02", "2010-01-31") != 5
+		|| exchange.getMaximumRate("2009-01-01", "2010-01-05") != 20
+		|| exchange.getInterpolatedRate("2010-01-03") != 15
+		|| exchange.getInterpolatedRate("2010-01-08") != 17.5
+		|| exchange.getInterpolatedRate("2011-01-01") != 30)
+		return 13;
+	exchange.updateRate("2010-01-07", 45);
+	if (exchange.getAverageRate("2010-01-06", "2010-01-07") != 25
+		|| exchange.getMaximumRate("2010-01-01", "2010-01-10") != 45)
+		return 14;
+	static const char* const empty[][2] = {
+		{ "2010-01-02", "2010-01-04" }, { "2010-01-10", "2010-01-01" },
+		{ "2011-01-01", "2012-01-01" }, { "2010-02-30", "2010-03-01" }
+	};
+	for (size_t i = 0; i < sizeof(empty) / sizeof(empty[0]); i++) {
+		try {
+			exchange.getAverageRate(empty[i][0], empty[i][1]);
+			return 15;
+		} catch (const BitcoinExchange::InvalidValueException&) {
+		}
+	}
+	try {
+		exchange.getInterpolatedRate("2009-12-31");
+		return 16;
+	} catch (const BitcoinExchange::InvalidValueException&) {
+	}
+	return 0;
+}
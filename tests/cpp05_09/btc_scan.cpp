@@ -0,0 +1,76 @@
+#include "LineScanner.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Line-at-a-time reference: memchr for the newline, findSeparator per line.
+static std::vector<LineScanner::Line> reference(const char* data, size_t length)
+{
+	std::vector<LineScanner::Line> lines;
+	const char* cursor = data;
+	const char* end = data + length;
+	while (cursor < end) {
+		LineScanner::Line line;
+		line.begin = cursor;
+		line.end = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+		cursor = line.end == NULL ? end : line.end + 1;
+		if (line.end == NULL)
+			line.end = end;
+		if (line.end != line.begin && line.end[-1] == '\r')
+			--line.end;
+		line.separator = LineScanner::findSeparator(line.begin, line.end);
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+static bool matches(const std::string& input, LineScanner::Kernel kernel, size_t batch)
+{
+	std::vector<LineScanner::Line> expected = reference(input.data(), input.size());
+	std::vector<LineScanner::Line> lines(batch);
+	LineScanner scanner(input.data(), input.size(), kernel);
+	size_t index = 0;
+	size_t count;
+	while ((count = scanner.next(&lines[0], batch)) > 0) {
+		for (size_t i = 0; i < count; i++, index++) {
+			if (index >= expected.size()
+				|| lines[i].begin != expected[index].begin
+				|| lines[i].end != expected[index].end
+				|| lines[i].separator != expected[index].separator)
+				return false;
+		}
+	}
+	return index == expected.size();
+}
+
+int main()
+{
+	const LineScanner::Kernel kernels[] = {
+		LineScanner::AUTO, LineScanner::SCALAR, LineScanner::SSE2, LineScanner::AVX2
+	};
+	const char* const fixed[] = {
+		"", "\n", "a", "a | b", "a | b\r\n", "| x\n x |\n x || y\n", " | \r", "a |\n b",
+		"2011-01-03 | 3\n2011-01-03 | 2\r\n\n2011-01-03 | 1", NULL
+	};
+	const char alphabet[] = "ab |\n\r-1\x80\xfe";
+
+	for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+		if (!LineScanner::supports(kernels[k]))
+			continue;
+		for (size_t i = 0; fixed[i] != NULL; i++) {
+			if (!matches(fixed[i], kernels[k], 1) || !matches(fixed[i], kernels[k], 7))
+				return 1;
+		}
+		std::srand(3);
+		for (int round = 0; round < 2000; round++) {
+			std::string input(static_cast<size_t>(std::rand() % 300), ' ');
+			for (size_t i = 0; i < input.size(); i++)
+				input[i] = alphabet[std::rand() % 10];
+			if (!matches(input, kernels[k], 1 + static_cast<size_t>(std::rand() % 9)))
+				return 2;
+		}
+	}
+	return LineScanner::supports(LineScanner::SCALAR) ? 0 : 3;
+}
@@ -0,0 +1,113 @@
+#include "BitcoinExchange.hpp"
+#include "RateTable.hpp"
+#include "TestSupport.hpp"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+
+static bool snapshotMatches(RateTable& table)
+{
+	struct stat info;
+	if (stat("btc_snapshot.csv", &info) != 0)
+		return false;
+	std::ifstream in("btc_snapshot.csv", std::ios::in | std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	uint64_t mtime = static_cast<uint64_t>(info.st_mtime) * 1000000000u
+		+ static_cast<uint64_t>(info.st_mtim.tv_nsec);
+	return table.loadSnapshot("btc_snapshot.bin", static_cast<uint64_t>(info.st_size),
+		mtime, RateTable::sourceSample(content.data(), content.size()));
+}
+
+// Rewrites the CSV with content of the same size and puts its mtime back,
+// so only the content differs from what the snapshot was written for.
+static bool rewriteKeepingStat(const std::string& content)
+{
+	struct stat before;
+	if (stat("btc_snapshot.csv", &before) != 0)
+		return false;
+	writeFile("btc_snapshot.csv", content);
+	struct timespec times[2];
+	times[0] = before.st_atim;
+	times[1] = before.st_mtim;
+	struct stat after;
+	return utimensat(AT_FDCWD, "btc_snapshot.csv", times, 0) == 0
+		&& stat("btc_snapshot.csv", &after) == 0
+		&& after.st_size == before.st_size
+		&& after.st_mtim.tv_sec == before.st_mtim.tv_sec
+		&& after.st_mtim.tv_nsec == before.st_mtim.tv_nsec;
+}
+
+int main()
+{
+	writeFile("btc_snapshot.csv", "date,exchange_rate\n2010-01-01,1.5\n2010-01-04,2\n");
+	std::remove("btc_snapshot.bin");
+	BitcoinExchange cold;
+	cold.loadDatabase("btc_snapshot.csv", "btc_snapshot.bin");
+
+	RateTable table;
+	if (!snapshotMatches(table) || table.size() != 2)
+		return 1;
+	double rate = 0;
+	if (!table.find(RateTable::dayNumber(2010, 1, 3), rate) || rate != 1.5)
+		return 2;
+	table.append(RateTable::dayNumber(2010, 2, 1), 7);
+	if (!table.find(RateTable::dayNumber(2011, 1, 1), rate) || rate != 7)
+		return 3;
+	if (table.loadSnapshot("btc_snapshot.bin", 1, 1, 1))
+		return 4;
+
+	std::fstream corrupt("btc_snapshot.bin",
+		std::ios::in | std::ios::out | std::ios::binary);
+	corrupt.seekp(-1, std::ios::end);
+	corrupt.put('\x7f');
+	corrupt.close();
+	if (snapshotMatches(table))
+		return 5;
+
+	BitcoinExchange warm;
+	warm.loadDatabase("btc_snapshot.csv", "btc_snapshot.bin");
+	if (warm.getExchangeRate("2010-01-03") != 1.5
+		|| warm.getExchangeRate("2010-02-01") != 2)
+		return 6;
+	if (!snapshotMatches(table))
+		return 7;
+
+	// Same size and the same mtime down to the nanosecond: only the
+	// sampled hash tells the edit apart. This file fits in the sample.
+	if (!rewriteKeepingStat("date,exchange_rate\n2010-01-01,1.5\n2010-01-04,3\n"))
+		return 8;
+	BitcoinExchange edited;
+	edited.loadDatabase("btc_snapshot.csv", "btc_snapshot.bin");
+	if (edited.getExchangeRate("2010-02-01") != 3)
+		return 9;
+
+	// A larger CSV is only sampled; its newest row is in the last window.
+	std::string large = "date,exchange_rate\n";
+	for (int day = 1; day <= 28; day++) {
+		for (int month = 1; month <= 12; month++) {
+			for (int year = 2010; year < 2014; year++) {
+				char line[32];
+				std::sprintf(line, "%d-%02d-%02d,1.5\n", year, month, day);
+				large += line;
+			}
+		}
+	}
+	large += "2014-01-01,4\n";
+	writeFile("btc_snapshot.csv", large);
+	BitcoinExchange largeCold;
+	largeCold.loadDatabase("btc_snapshot.csv", "btc_snapshot.bin");
+	if (large.size() <= 3 * 4096 || !snapshotMatches(table))
+		return 10;
+	large[large.size() - 2] = '5';
+	if (!rewriteKeepingStat(large))
+		return 11;
+	BitcoinExchange largeEdited;
+	largeEdited.loadDatabase("btc_snapshot.csv", "btc_snapshot.bin");
+	if (largeEdited.getExchangeRate("2014-01-02") != 5)
+		return 12;
+	return 0;
+}
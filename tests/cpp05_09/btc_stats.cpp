@@ -0,0 +1,84 @@
+#include "BitcoinExchange.hpp"
+#include "PipelineStats.hpp"
+#include "TestSupport.hpp"
+
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+static bool countsMatch(const PipelineStats& stats, unsigned long priced)
+{
+	return stats.outcomes(PipelineStats::PRICED) == priced
+		&& stats.outcomes(PipelineStats::BAD_INPUT) == 3
+		&& stats.outcomes(PipelineStats::NOT_POSITIVE) == 1
+		&& stats.outcomes(PipelineStats::TOO_LARGE) == 1
+		&& stats.outcomes(PipelineStats::NO_RATE) == 1;
+}
+
+int main()
+{
+	writeFile("btc_stats.csv", "date,exchange_rate\n2010-01-01,2\n2010-01-04,3\n");
+	std::string input = "date | value\n2010-01-02 | 1\n\n2010-01-05 | 2\n"
+		"2010-02-30 | 1\nnonsense\n2010-01-02 | x\n2010-01-02 | -1\n"
+		"2010-01-02 | 1001\n2009-12-31 | 1\n";
+	writeFile("btc_stats.txt", input);
+
+	std::ostringstream captured;
+	std::streambuf* saved = std::cout.rdbuf(captured.rdbuf());
+	BitcoinExchange quiet;
+	quiet.loadDatabase("btc_stats.csv");
+	quiet.processInput("btc_stats.txt");
+	std::string plain = captured.str();
+	captured.str("");
+
+	BitcoinExchange exchange;
+	exchange.setStatistics(true);
+	exchange.loadDatabase("btc_stats.csv");
+	exchange.processInput("btc_stats.txt");
+	std::string counted = captured.str();
+	PipelineStats serial = exchange.statistics();
+
+	BitcoinExchange threaded;
+	threaded.setStatistics(true);
+	threaded.setThreadCount(3);
+	threaded.loadDatabase("btc_stats.csv");
+	std::string bulk;
+	for (int i = 0; i < 20000; i++)
+		bulk += input.substr(13);
+	writeFile("btc_stats_bulk.txt", bulk);
+	threaded.processInput("btc_stats_bulk.txt");
+
+	BitcoinExchange streamed;
+	streamed.setStatistics(true);
+	streamed.loadDatabase("btc_stats.csv");
+	writeFile("btc_stats_long.txt", input + std::string(70000, '9') + "\n2010-01-02 | 1\n");
+	int fd = open("btc_stats_long.txt", O_RDONLY);
+	streamed.processStream(fd);
+	close(fd);
+	std::cout.rdbuf(saved);
+
+	if (plain != counted)
+		return 1;
+	if (!countsMatch(serial, 2) || serial.lines() != 8)
+		return 2;
+	if (threaded.statistics().lines() != 160000
+		|| threaded.statistics().outcomes(PipelineStats::PRICED) != 40000
+		|| threaded.statistics().outcomes(PipelineStats::NO_RATE) != 20000)
+		return 3;
+	if (!countsMatch(streamed.statistics(), 3)
+		|| streamed.statistics().outcomes(PipelineStats::LINE_TOO_LONG) != 1)
+		return 4;
+	if (quiet.statistics().lines() != 0)
+		return 5;
+
+	std::ostringstream report;
+	serial.print(report);
+	if (report.str().find("stats: input 8 lines, 132 bytes") == std::string::npos
+		|| report.str().find("lines/s") == std::string::npos
+		|| report.str().find("2 rates") == std::string::npos)
+		return 6;
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "LineRing.hpp"
+
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Reads everything written to a pipe through a ring of `capacity` bytes.
+// Overlong lines are recorded as "<long>".
+static std::vector<std::string> split(const std::string& input, size_t capacity)
+{
+	std::vector<std::string> lines;
+	int fds[2];
+	if (pipe(fds) != 0)
+		return lines;
+	if (write(fds[1], input.data(), input.size()) != static_cast<ssize_t>(input.size()))
+		lines.push_back("<short write>");
+	close(fds[1]);
+
+	LineRing ring(fds[0], capacity);
+	for (;;) {
+		const char* begin = NULL;
+		const char* end = NULL;
+		LineRing::Status status = ring.next(begin, end);
+		if (status == LineRing::END)
+			break;
+		if (status == LineRing::NEED_DATA) {
+			if (!ring.fill())
+				lines.push_back("<read error>");
+			continue;
+		}
+		if (status == LineRing::LONG_LINE)
+			lines.push_back("<long>");
+		else
+			lines.push_back(std::string(begin, end));
+	}
+	close(fds[0]);
+	return lines;
+}
+
+static bool expect(const std::vector<std::string>& lines, const char* const* expected)
+{
+	size_t i = 0;
+	for (; expected[i] != NULL; i++) {
+		if (i >= lines.size() || lines[i] != expected[i])
+			return false;
+	}
+	return i == lines.size();
+}
+
+int main()
+{
+	const char* const wrapped[] = { "abc", "defgh", "", "ij", "klmnop", "q", NULL };
+	if (!expect(split("abc\ndefgh\n\r\nij\r\nklmnop\nq", 8), wrapped))
+		return 1;
+
+	const char* const overlong[] = { "ab", "<long>", "cd", NULL };
+	if (!expect(split("ab\n0123456789abcdef\ncd\n", 8), overlong))
+		return 2;
+
+	const char* const trailingLong[] = { "<long>", NULL };
+	if (!expect(split("0123456789", 4), trailingLong))
+		return 3;
+
+	const char* const none[] = { NULL };
+	if (!expect(split("", 8), none))
+		return 4;
+
+	std::string bulk;
+	std::vector<std::string> expected;
+	for (int i = 0; i < 2000; i++) {
+		std::string line(static_cast<size_t>(i % 37), static_cast<char>('a' + i % 26));
+		bulk += line + "\n";
+		expected.push_back(line);
+	}
+	for (size_t capacity = 38; capacity < 80; capacity += 7) {
+		if (split(bulk, capacity) != expected)
+			return 5;
+	}
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include "OutputBuffer.hpp"
+#include "TestSupport.hpp"
+
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+
+static double sampleDouble(long round)
+{
+	uint64_t bits = nextRandomBits();
+	double value;
+	switch (round % 4) {
+	case 0:
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	case 1:
+		return static_cast<double>(bits % 100000000) / 1000.0;
+	case 2:
+		return static_cast<double>(bits % 10000) / 100.0
+			* static_cast<double>((bits >> 20) % 10000000) / 100.0;
+	default:
+		return -static_cast<double>(bits % 1000000) * 1e-12;
+	}
+}
+
+int main()
+{
+	for (long round = 0; round < 300000; round++) {
+		double value = sampleDouble(round);
+		int precision = round % 3 == 0 ? static_cast<int>(round % 18) : 15;
+		std::ostringstream expected;
+		expected.precision(precision);
+		expected << value;
+		OutputBuffer buffer;
+		buffer.setPrecision(precision);
+		buffer << value;
+		if (std::string(buffer.data(), buffer.size()) != expected.str()) {
+			std::cout << "precision " << precision << ": expected "
+				<< expected.str() << std::endl;
+			return 1;
+		}
+	}
+
+	std::ostringstream sink;
+	{
+		OutputBuffer buffer(sink, 16);
+		buffer << "n=" << 42 << ' ' << LONG_MIN << ' ' << 0.1 << '\n';
+		for (int i = 0; i < 100; i++)
+			buffer << i;
+	}
+	std::ostringstream expected;
+	expected << "n=" << 42 << ' ' << LONG_MIN << ' ' << 0.1 << '\n';
+	for (int i = 0; i < 100; i++)
+		expected << i;
+	if (sink.str() != expected.str())
+		return 2;
+	return 0;
+}
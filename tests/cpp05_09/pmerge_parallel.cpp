@@ -0,0 +1,136 @@
+#include "ParallelFordJohnson.hpp"
+#include "PmergeMe.hpp"
+#include "TestSupport.hpp"
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 0: wide random, 1: few distinct values, 2: ascending, 3: descending.
+static std::vector<int> makeValues(size_t n, int shape)
+{
+	std::vector<int> values(n);
+	for (size_t i = 0; i < n; i++) {
+		if (shape == 0)
+			values[i] = static_cast<int>(nextRandom() % 2147483647u) + 1;
+		else if (shape == 1)
+			values[i] = static_cast<int>(nextRandom() % 5) + 1;
+		else if (shape == 2)
+			values[i] = static_cast<int>(i) + 1;
+		else
+			values[i] = static_cast<int>(n - i);
+	}
+	return values;
+}
+
+static size_t sortedComparisons(const std::vector<int>& values, size_t threads)
+{
+	std::vector<std::string> tokens(values.size() + 1, "PmergeMe");
+	std::vector<char*> argv(values.size() + 1);
+	for (size_t i = 0; i < values.size(); i++) {
+		std::ostringstream out;
+		out << values[i];
+		tokens[i + 1] = out.str();
+	}
+	for (size_t i = 0; i < tokens.size(); i++)
+		argv[i] = &tokens[i][0];
+	PmergeMe sorter;
+	sorter.setThreadCount(threads);
+	sorter.parseInput(static_cast<int>(argv.size()), &argv[0]);
+	sorter.sortVector();
+	return sorter.vectorComparisons();
+}
+
+static bool isSortedPermutation(const std::vector<int>& values,
+	const std::vector<size_t>& order)
+{
+	if (order.size() != values.size())
+		return false;
+	std::vector<bool> seen(values.size(), false);
+	for (size_t i = 0; i < order.size(); i++) {
+		if (order[i] >= values.size() || seen[order[i]])
+			return false;
+		seen[order[i]] = true;
+		if (i > 0 && values[order[i - 1]] > values[order[i]])
+			return false;
+	}
+	return true;
+}
+
+// Worst-case comparisons of merge-insertion: sum of ceil(log2(3k/4)).
+static size_t fordJohnsonBound(size_t n)
+{
+	size_t bound = 0;
+	for (size_t k = 1; k <= n; k++) {
+		size_t bits = 0;
+		while ((static_cast<size_t>(4) << bits) < 3 * k)
+			bits++;
+		bound += bits;
+	}
+	return bound;
+}
+
+int main()
+{
+	// The sequential sort and ParallelFordJohnson make the same number of
+	// comparisons; any difference in search order or bounds changes it.
+	for (size_t n = 1; n <= 260; n++) {
+		for (int shape = 0; shape < 4; shape++) {
+			std::vector<int> values = makeValues(n, shape);
+			size_t sequential = sortedComparisons(values, 1);
+			if (sortedComparisons(values, 4) != sequential)
+				return 1;
+			if (sequential > fordJohnsonBound(n))
+				return 2;
+		}
+	}
+	for (int shape = 0; shape < 2; shape++) {
+		std::vector<int> values = makeValues(3001, shape);
+		if (sortedComparisons(values, 2) != sortedComparisons(values, 1))
+			return 3;
+	}
+
+	// Large enough that every pass is split across threads: the resulting
+	// permutation, duplicates included, is the same at every thread count.
+	for (int shape = 0; shape < 4; shape++) {
+		std::vector<int> values = makeValues(120001, shape);
+		std::vector<size_t> expected;
+		size_t expectedComparisons = 0;
+		static const size_t threads[] = { 1, 2, 3, 8 };
+		for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+			std::vector<size_t> order(values.size());
+			for (size_t i = 0; i < order.size(); i++)
+				order[i] = order.size() - 1 - i;
+			ParallelFordJohnson sorter;
+			sorter.setThreadCount(threads[t]);
+			sorter.sort(values, order);
+			if (!isSortedPermutation(values, order))
+				return 4;
+			if (t == 0) {
+				expected = order;
+				expectedComparisons = sorter.comparisons();
+			} else if (order != expected || sorter.comparisons() != expectedComparisons) {
+				return 5;
+			}
+		}
+		if (expectedComparisons > fordJohnsonBound(values.size()))
+			return 6;
+	}
+
+	ParallelFordJohnson sorter;
+	if (sorter.threadCount() != 1)
+		return 7;
+	sorter.setThreadCount(1000);
+	if (sorter.threadCount() != ParallelFordJohnson::MAX_THREADS)
+		return 8;
+	sorter.setThreadCount(0);
+	if (sorter.threadCount() != 1)
+		return 9;
+	std::vector<int> empty;
+	std::vector<size_t> none;
+	sorter.sort(empty, none);
+	if (!none.empty() || sorter.comparisons() != 0)
+		return 10;
+	return 0;
+}
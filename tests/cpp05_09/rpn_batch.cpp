@@ -0,0 +1,83 @@
+#include "RPN.hpp"
+#include "RPNBatch.hpp"
+#include "TestSupport.hpp"
+
+#include <sstream>
+#include <string>
+
+static std::string randomExpression(void)
+{
+	static const char operators[] = "+-*/";
+	std::string expression;
+	size_t depth = 0;
+	size_t tokens = nextRandom() % 24;
+	for (size_t i = 0; i < tokens; i++) {
+		if (!expression.empty())
+			expression += " ";
+		if (depth >= 2 && nextRandom() % 2 == 0) {
+			expression += operators[nextRandom() % 4];
+			depth--;
+		} else {
+			expression += static_cast<char>('0' + nextRandom() % 10);
+			depth++;
+		}
+	}
+	if (nextRandom() % 4 != 0) {
+		while (depth-- > 1)
+			expression += " +";
+	}
+	if (nextRandom() % 50 == 0)
+		expression += " x";
+	return expression;
+}
+
+int main()
+{
+	std::string input;
+	std::ostringstream expected;
+	size_t expectedFailed = 0;
+	RPN calculator;
+	for (int i = 0; i < 40000; i++) {
+		std::string expression = randomExpression();
+		input += expression;
+		input += i % 7 == 0 ? "\r\n" : "\n";
+		try {
+			expected << calculator.evaluate(expression) << '\n';
+		} catch (const std::exception&) {
+			expected << "Error\n";
+			expectedFailed++;
+		}
+	}
+	if (expectedFailed == 0 || expectedFailed == 40000)
+		return 1;
+
+	// 40000 lines take three rounds on one thread and one on eight.
+	static const size_t threads[] = { 1, 2, 3, 8, 1000 };
+	for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+		RPNBatch batch;
+		batch.setThreadCount(threads[t]);
+		std::istringstream in(input);
+		std::ostringstream out;
+		if (batch.run(in, out) != expectedFailed)
+			return 2;
+		if (out.str() != expected.str())
+			return 3;
+	}
+
+	RPNBatch batch;
+	if (batch.threadCount() != 1)
+		return 4;
+	batch.setThreadCount(1000);
+	if (batch.threadCount() != RPNBatch::MAX_THREADS)
+		return 5;
+	RPNBatch copy(batch);
+	std::istringstream in("8 9 * 9 - 9 - 9 - 4 - 1 +\n1 0 /\n\n5 2 / 2 *");
+	std::ostringstream out;
+	if (copy.run(in, out) != 2 || out.str() != "42\nError\nError\n4\n")
+		return 6;
+	std::istringstream empty("");
+	std::ostringstream nothing;
+	if (copy.run(empty, nothing) != 0 || !nothing.str().empty())
+		return 7;
+	return 0;
+}
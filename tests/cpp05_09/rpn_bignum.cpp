@@ -0,0 +1,130 @@
+#include "RPN.hpp"
+#include "TestSupport.hpp"
+
+#include <sstream>
+#include <stdint.h>
+#include <string>
+
+static BigInt appendLimb(const BigInt& value, uint32_t limb)
+{
+	BigInt half(65536);
+	return value * half * half + BigInt(static_cast<int>(limb >> 16)) * half
+		+ BigInt(static_cast<int>(limb & 0xFFFF));
+}
+
+// Limbs biased towards 0, all ones and the top bit, where carries and the
+// division's estimate corrections happen.
+static BigInt randomBig(size_t limbs)
+{
+	static const uint32_t edges[] = { 0u, 1u, 0xFFFFFFFFu, 0x80000000u, 0x7FFFFFFFu };
+	BigInt value;
+	for (size_t i = 0; i < limbs; i++) {
+		uint32_t limb = nextRandom();
+		if (nextRandom() % 3 == 0)
+			limb = edges[nextRandom() % (sizeof(edges) / sizeof(edges[0]))];
+		value = appendLimb(value, limb);
+	}
+	if (nextRandom() % 2 == 0)
+		value = BigInt(0) - value;
+	return value;
+}
+
+static BigInt absolute(const BigInt& value)
+{
+	return value.isNegative() ? BigInt(0) - value : value;
+}
+
+static std::string decimal(int64_t value)
+{
+	std::ostringstream out;
+	out << value;
+	return out.str();
+}
+
+// q = a / b truncates toward zero: |q b| <= |a| < |q b| + |b|, and q has
+// the sign of a b unless it is zero.
+static bool divisionHolds(const BigInt& a, const BigInt& b)
+{
+	BigInt q = a / b;
+	BigInt product = absolute(q * b);
+	if (absolute(a) < product || !(absolute(a) < product + absolute(b)))
+		return false;
+	return q.isZero() || q.isNegative() == (a.isNegative() != b.isNegative());
+}
+
+int main()
+{
+	for (int i = 0; i < 100000; i++) {
+		int64_t left = static_cast<int32_t>(nextRandom());
+		int64_t right = static_cast<int32_t>(nextRandom());
+		BigInt a(static_cast<int>(left));
+		BigInt b(static_cast<int>(right));
+		if ((a + b).toString() != decimal(left + right)
+			|| (a - b).toString() != decimal(left - right)
+			|| (a * b).toString() != decimal(left * right))
+			return 1;
+		if (right != 0 && (a / b).toString() != decimal(left / right))
+			return 2;
+		if (!(a * b).isInline() || (a < b) != (left < right))
+			return 3;
+	}
+
+	BigInt power(1);
+	for (int i = 0; i < 128; i++)
+		power = power * BigInt(2);
+	if (power.toString() != "340282366920938463463374607431768211456"
+		|| (BigInt(0) - power).toString() != "-340282366920938463463374607431768211456"
+		|| BigInt(0).toString() != "0" || BigInt(-2147483647 - 1).toString() != "-2147483648")
+		return 4;
+
+	for (int i = 0; i < 300; i++) {
+		BigInt a = randomBig(1 + nextRandom() % 200);
+		BigInt b = randomBig(1 + nextRandom() % 200);
+		if (a * b != BigInt::schoolbookProduct(a, b) || a * b != b * a)
+			return 5;
+		if ((a + b) - b != a || a - a != BigInt(0))
+			return 6;
+		if (!b.isZero() && !divisionHolds(a, b))
+			return 7;
+		if (!b.isZero() && (a * b) / b != a)
+			return 8;
+	}
+	for (int i = 0; i < 20000; i++) {
+		BigInt a = randomBig(1 + nextRandom() % 6);
+		BigInt b = randomBig(1 + nextRandom() % 4);
+		if (!b.isZero() && !divisionHolds(a, b))
+			return 9;
+	}
+
+	RPN calculator;
+	if (calculator.evaluateBignum("9 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 *").toString() != "3486784401"
+		|| calculator.evaluateBignum("1 2 * 2 / 2 * 2 4 - +").toString() != "0"
+		|| calculator.evaluateBignum("0 9 - 2 /").toString() != "-4")
+		return 10;
+	std::string chain = "9";
+	for (int i = 0; i < 100; i++)
+		chain += " 9 *";
+	BigInt expected(9);
+	for (int i = 0; i < 100; i++)
+		expected = expected * BigInt(9);
+	if (calculator.evaluateBignum(chain) != expected)
+		return 11;
+	if (calculator.evaluate("8 9 * 9 - 9 - 9 - 4 - 1 +") != 42)
+		return 12;
+	try {
+		calculator.evaluateBignum("1 0 /");
+		return 13;
+	} catch (const RPN::DivisionByZeroException&) {
+	}
+	try {
+		calculator.evaluateBignum("1 +");
+		return 14;
+	} catch (const RPN::InsufficientOperandsException&) {
+	}
+	try {
+		calculator.evaluateBignum("1 2");
+		return 15;
+	} catch (const RPN::InvalidExpressionException&) {
+	}
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include "CheckedInt.hpp"
+#include "TestSupport.hpp"
+
+#include <climits>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+static bool agrees(bool fits, int result, int64_t exact)
+{
+	bool expected = exact >= INT_MIN && exact <= INT_MAX;
+	return fits == expected && (!fits || result == exact);
+}
+
+// Built both with the compiler builtins and with -DCHECKEDINT_PORTABLE.
+int main()
+{
+	std::vector<int> values;
+	static const int edges[] = {
+		0, 1, -1, 2, -2, 3, 46340, 46341, -46341, 65535, 65536, -65536,
+		INT_MAX, INT_MAX - 1, INT_MIN, INT_MIN + 1, INT_MAX / 2, INT_MIN / 2
+	};
+	for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+		values.push_back(edges[i]);
+	for (int i = 0; i < 300; i++)
+		values.push_back(static_cast<int>(nextRandom()) >> (nextRandom() % 32));
+
+	for (size_t i = 0; i < values.size(); i++) {
+		for (size_t j = 0; j < values.size(); j++) {
+			int left = values[i];
+			int right = values[j];
+			int result = 0;
+			bool fits = checkedAdd(left, right, result);
+			if (!agrees(fits, result, static_cast<int64_t>(left) + right))
+				return 1;
+			fits = checkedSubtract(left, right, result);
+			if (!agrees(fits, result, static_cast<int64_t>(left) - right))
+				return 2;
+			fits = checkedMultiply(left, right, result);
+			if (!agrees(fits, result, static_cast<int64_t>(left) * right))
+				return 3;
+			fits = checkedDivide(left, right, result);
+			if (right == 0) {
+				if (fits)
+					return 4;
+			} else if (!agrees(fits, result, static_cast<int64_t>(left) / right)) {
+				return 5;
+			}
+		}
+	}
+
+	// The result may alias an operand, as in the evaluators.
+	int value = 7;
+	if (!checkedMultiply(value, value, value) || value != 49)
+		return 6;
+	if (!checkedSubtract(value, 50, value) || value != -1)
+		return 7;
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include "RPN.hpp"
+#include "RPNProgram.hpp"
+#include "TestSupport.hpp"
+
+#include <climits>
+#include <string>
+#include <vector>
+
+static const char* const g_names[] = { "a", "rate", "_x1" };
+
+// Well-formed expressions over three variables and digits.
+static std::string randomExpression(void)
+{
+	static const char operators[] = "+-*/";
+	std::string expression;
+	size_t depth = 0;
+	size_t tokens = 1 + nextRandom() % 30;
+	for (size_t i = 0; i < tokens; i++) {
+		if (!expression.empty())
+			expression += " ";
+		if (depth >= 2 && nextRandom() % 2 == 0) {
+			expression += operators[nextRandom() % 4];
+			depth--;
+		} else if (nextRandom() % 2 == 0) {
+			expression += g_names[nextRandom() % 3];
+			depth++;
+		} else {
+			expression += static_cast<char>('0' + nextRandom() % 10);
+			depth++;
+		}
+	}
+	while (depth > 1) {
+		expression += nextRandom() % 2 == 0 ? " +" : " /";
+		depth--;
+	}
+	return expression;
+}
+
+// Mostly small values, with zeros, signs and the int limits mixed in.
+static int randomValue(void)
+{
+	switch (nextRandom() % 8) {
+	case 0:
+		return 0;
+	case 1:
+		return nextRandom() % 2 == 0 ? INT_MAX : INT_MIN;
+	case 2:
+		return static_cast<int>(nextRandom());
+	default:
+		return static_cast<int>(nextRandom() % 201) - 100;
+	}
+}
+
+static unsigned char runRow(RPNProgram& program, const int* values, int& result)
+{
+	result = 0;
+	try {
+		result = program.run(values);
+		return RPNProgram::ROW_OK;
+	} catch (const RPN::DivisionByZeroException&) {
+		return RPNProgram::ROW_DIVISION_BY_ZERO;
+	} catch (const RPN::InvalidExpressionException&) {
+		return RPNProgram::ROW_OVERFLOW;
+	}
+}
+
+int main()
+{
+	for (int round = 0; round < 300; round++) {
+		RPNProgram program;
+		program.compile(randomExpression());
+		size_t rows = 1 + nextRandom() % 1000;
+		std::vector<std::vector<int> > values(program.variableCount(), std::vector<int>(rows));
+		std::vector<const int*> columns(program.variableCount() + 1);
+		for (size_t v = 0; v < program.variableCount(); v++) {
+			for (size_t r = 0; r < rows; r++)
+				values[v][r] = randomValue();
+			columns[v] = &values[v][0];
+		}
+		std::vector<int> results(rows);
+		std::vector<unsigned char> status(rows);
+		size_t failed = program.runColumns(&columns[0], rows, &results[0], &status[0]);
+
+		size_t expectedFailed = 0;
+		std::vector<int> row(program.variableCount() + 1);
+		for (size_t r = 0; r < rows; r++) {
+			for (size_t v = 0; v < program.variableCount(); v++)
+				row[v] = values[v][r];
+			int expected;
+			unsigned char expectedStatus = runRow(program, &row[0], expected);
+			if (status[r] != expectedStatus)
+				return 1;
+			if (results[r] != expected)
+				return 2;
+			expectedFailed += expectedStatus != RPNProgram::ROW_OK;
+		}
+		if (failed != expectedFailed)
+			return 3;
+	}
+
+	// With digits for values, a variable behaves like the literal.
+	RPN calculator;
+	for (int i = 0; i < 2000; i++) {
+		std::string expression = randomExpression();
+		RPNProgram program;
+		program.compile(expression);
+		int digits[3];
+		std::string substituted;
+		for (size_t v = 0; v < 3; v++)
+			digits[v] = static_cast<int>(nextRandom() % 10);
+		size_t start = 0;
+		while (start < expression.size()) {
+			size_t end = expression.find(' ', start);
+			if (end == std::string::npos)
+				end = expression.size();
+			std::string token = expression.substr(start, end - start);
+			size_t index = program.variableIndex(token);
+			if (!substituted.empty())
+				substituted += " ";
+			substituted += index == RPNProgram::NO_VARIABLE ? token
+				: std::string(1, static_cast<char>('0' + digits[index]));
+			start = end + 1;
+		}
+		int expected;
+		int value;
+		unsigned char expectedStatus = RPNProgram::ROW_OK;
+		try {
+			expected = calculator.evaluate(substituted);
+		} catch (const RPN::DivisionByZeroException&) {
+			expectedStatus = RPNProgram::ROW_DIVISION_BY_ZERO;
+			expected = 0;
+		} catch (const RPN::InvalidExpressionException&) {
+			expectedStatus = RPNProgram::ROW_OVERFLOW;
+			expected = 0;
+		}
+		if (runRow(program, digits, value) != expectedStatus || value != expected)
+			return 4;
+	}
+
+	RPNProgram program;
+	program.compile("price qty * price 2 / -");
+	if (program.variableCount() != 2 || program.variableName(0) != "price"
+		|| program.variableIndex("qty") != 1 || program.variableIndex("tax") != RPNProgram::NO_VARIABLE)
+		return 5;
+	int price[] = { 10, 7, INT_MAX, 3 };
+	int qty[] = { 3, 0, 2, -1 };
+	const int* columns[] = { price, qty };
+	int results[4];
+	unsigned char status[4];
+	if (program.runColumns(columns, 4, results, status) != 1)
+		return 6;
+	if (results[0] != 25 || results[1] != -3 || results[2] != 0 || results[3] != -4
+		|| status[2] != RPNProgram::ROW_OVERFLOW || status[3] != RPNProgram::ROW_OK)
+		return 7;
+	try {
+		program.run();
+		return 8;
+	} catch (const RPN::InvalidExpressionException&) {
+	}
+	static const char* const invalid[] = { "1a 2 +", "a-b", "a $", "12" };
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		try {
+			program.compile(invalid[i]);
+			return 9;
+		} catch (const RPN::InvalidExpressionException&) {
+		}
+	}
+	try {
+		calculator.evaluate("a 1 +");
+		return 10;
+	} catch (const RPN::InvalidExpressionException&) {
+	}
+	return 0;
+}
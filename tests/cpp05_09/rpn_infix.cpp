@@ -0,0 +1,210 @@
+#include "RPN.hpp"
+#include "RPNProgram.hpp"
+#include "TestSupport.hpp"
+
+#include <climits>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Expression tree node: op is 'n' (literal), 'v' (variable), 'u' (unary
+// minus) or a binary operator.
+struct Node {
+	char op;
+	int value;
+	int left;
+	int right;
+};
+
+static const char* const g_names[] = { "x", "y", "zeta" };
+
+static int literal(void)
+{
+	static const int values[] = { 0, 1, 2, 3, 7, 10, 65536, 2147483647 };
+	return values[nextRandom() % (sizeof(values) / sizeof(values[0]))];
+}
+
+static int grow(std::vector<Node>& nodes, int depth)
+{
+	Node node;
+	node.left = -1;
+	node.right = -1;
+	node.value = 0;
+	uint32_t pick = nextRandom() % 10;
+	if (depth == 0 || pick < 3) {
+		node.op = pick % 2 == 0 ? 'n' : 'v';
+		node.value = node.op == 'n' ? literal() : static_cast<int>(nextRandom() % 3);
+	} else if (pick == 3) {
+		node.op = 'u';
+		node.left = grow(nodes, depth - 1);
+	} else {
+		node.op = "+-*/"[nextRandom() % 4];
+		node.left = grow(nodes, depth - 1);
+		node.right = grow(nodes, depth - 1);
+	}
+	nodes.push_back(node);
+	return static_cast<int>(nodes.size() - 1);
+}
+
+static std::string render(const std::vector<Node>& nodes, int index)
+{
+	const Node& node = nodes[index];
+	std::ostringstream out;
+	if (node.op == 'n')
+		out << node.value;
+	else if (node.op == 'v')
+		out << g_names[node.value];
+	else if (node.op == 'u')
+		out << "-(" << render(nodes, node.left) << ")";
+	else
+		out << "(" << render(nodes, node.left) << " " << node.op << " " << render(nodes, node.right) << ")";
+	return out.str();
+}
+
+// Post-order, like the postfix program: the first failure wins.
+// Returns 0, 1 for overflow or 2 for division by zero.
+static int reference(const std::vector<Node>& nodes, int index, const int* values, int64_t& result)
+{
+	const Node& node = nodes[index];
+	if (node.op == 'n' || node.op == 'v') {
+		result = node.op == 'n' ? node.value : values[node.value];
+		return 0;
+	}
+	int64_t left = 0;
+	int64_t right;
+	int status;
+	if (node.op == 'u') {
+		status = reference(nodes, node.left, values, right);
+	} else {
+		status = reference(nodes, node.left, values, left);
+		if (status == 0)
+			status = reference(nodes, node.right, values, right);
+	}
+	if (status != 0)
+		return status;
+	if (node.op == '+')
+		result = left + right;
+	else if (node.op == '-' || node.op == 'u')
+		result = left - right;
+	else if (node.op == '*')
+		result = left * right;
+	else if (right == 0)
+		return 2;
+	else
+		result = right == -1 ? -left : left / right;
+	return result < INT_MIN || result > INT_MAX ? 1 : 0;
+}
+
+static int runStatus(RPNProgram& program, const int* values, int& result)
+{
+	try {
+		result = program.run(values);
+		return 0;
+	} catch (const RPN::DivisionByZeroException&) {
+		return 2;
+	} catch (const RPN::InvalidExpressionException&) {
+		return 1;
+	}
+}
+
+static bool evaluatesTo(const std::string& infix, int expected, size_t instructions)
+{
+	RPNProgram program;
+	program.compileInfix(infix);
+	return program.instructionCount() == instructions && program.run() == expected;
+}
+
+int main()
+{
+	for (int round = 0; round < 3000; round++) {
+		std::vector<Node> nodes;
+		int root = grow(nodes, 1 + static_cast<int>(nextRandom() % 6));
+		std::string infix = render(nodes, root);
+		RPNProgram program;
+		program.compileInfix(infix);
+		std::vector<int> values(program.variableCount() + 1);
+		std::vector<int> byName(3);
+		for (int sample = 0; sample < 20; sample++) {
+			for (size_t v = 0; v < 3; v++)
+				byName[v] = static_cast<int>(nextRandom() % 41) - 20;
+			if (sample == 0)
+				byName[0] = INT_MIN;
+			for (size_t v = 0; v < program.variableCount(); v++) {
+				std::string name = program.variableName(v);
+				values[v] = byName[name == "x" ? 0 : name == "y" ? 1 : 2];
+			}
+			int64_t expected;
+			int expectedStatus = reference(nodes, root, &byName[0], expected);
+			int result;
+			int status = runStatus(program, &values[0], result);
+			if (status != expectedStatus)
+				return 1;
+			if (status == 0 && result != expected)
+				return 2;
+		}
+	}
+
+	if (!evaluatesTo("2 + 3 * 4", 14, 1) || !evaluatesTo("(2 + 3) * 4", 20, 1)
+		|| !evaluatesTo("8 - 3 - 2", 3, 1) || !evaluatesTo("16 / 4 / 2", 2, 1)
+		|| !evaluatesTo("-3 * 2", -6, 1) || !evaluatesTo("7 / -2", -3, 1)
+		|| !evaluatesTo("--5", 5, 1) || !evaluatesTo("-2147483647 - 1", INT_MIN, 1))
+		return 3;
+
+	RPNProgram program;
+	program.compileInfix("(1 + 2) * price");
+	if (program.instructionCount() != 3 || program.variableCount() != 1)
+		return 4;
+	static const char* const reduced[] = { "x * 1 + 0", "0 + 1 * x / 1", "(x - 0) * (3 - 2)" };
+	for (size_t i = 0; i < sizeof(reduced) / sizeof(reduced[0]); i++) {
+		program.compileInfix(reduced[i]);
+		int value = -17;
+		if (program.instructionCount() != 1 || program.run(&value) != -17)
+			return 5;
+	}
+	// A variable folded away is still an input of the formula.
+	program.compileInfix("x * (4 - 4)");
+	int unused = 9;
+	if (program.instructionCount() != 1 || program.variableCount() != 1 || program.run(&unused) != 0)
+		return 6;
+	program.compileInfix("x - x");
+	if (program.instructionCount() != 3)
+		return 7;
+
+	// Operations that would fail are left for run() to report.
+	program.compileInfix("1 + 2 / 0");
+	try {
+		program.run();
+		return 8;
+	} catch (const RPN::DivisionByZeroException&) {
+	}
+	program.compileInfix("(65536 * 65536) * 0");
+	try {
+		program.run();
+		return 9;
+	} catch (const RPN::InvalidExpressionException&) {
+	}
+
+	// The same program as the postfix compiler builds.
+	RPNProgram postfix;
+	postfix.compile("a b * c - a /");
+	program.compileInfix("(a * b - c) / a");
+	int row[] = { 3, 5, 4 };
+	if (program.instructionCount() != postfix.instructionCount()
+		|| program.maxDepth() != postfix.maxDepth() || program.run(row) != postfix.run(row))
+		return 10;
+
+	static const char* const invalid[] = {
+		"", "(", "1 +", "1 2", "(1 + 2", "1 + 2)", "1 $ 2", "2147483648", "* 2", "()", "2x"
+	};
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		try {
+			program.compileInfix(invalid[i]);
+			return 11;
+		} catch (const RPN::InvalidExpressionException&) {
+		}
+	}
+	if (program.run(row) != 3)
+		return 12;
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include "OperandStack.hpp"
+#include "RPN.hpp"
+
+#include <stack>
+#include <string>
+#include <vector>
+
+static bool holds(OperandStack values, const std::vector<int>& expected)
+{
+	if (values.size() != expected.size())
+		return false;
+	for (size_t i = expected.size(); i-- > 0;) {
+		if (values.back() != expected[i])
+			return false;
+		values.pop_back();
+	}
+	return values.empty();
+}
+
+int main()
+{
+	OperandStack stack;
+	std::vector<int> reference;
+	if (!stack.empty() || stack.capacity() != OperandStack::INLINE_CAPACITY)
+		return 1;
+	for (int i = 0; i < 1000; i++) {
+		stack.push_back(i * 7 - 300);
+		reference.push_back(i * 7 - 300);
+		if (i % 3 == 2) {
+			stack.pop_back();
+			reference.pop_back();
+		}
+	}
+	if (!holds(stack, reference))
+		return 2;
+	OperandStack copy(stack);
+	OperandStack assigned;
+	assigned.push_back(5);
+	assigned = stack;
+	copy.push_back(1);
+	if (!holds(assigned, reference) || copy.size() != reference.size() + 1 || !holds(stack, reference))
+		return 3;
+	size_t capacity = stack.capacity();
+	while (!stack.empty())
+		stack.pop_back();
+	if (stack.capacity() != capacity)
+		return 4;
+	OperandStack reserved;
+	reserved.reserve(5000);
+	std::stack<int, OperandStack> adapted(reserved);
+	for (int i = 0; i < 5000; i++)
+		adapted.push(i);
+	adapted.pop();
+	if (adapted.size() != 4999 || adapted.top() != 4998)
+		return 5;
+
+	// Operands pushed far past the inline buffer before any operator.
+	std::string deep;
+	for (int i = 0; i < 100000; i++)
+		deep += "1 ";
+	for (int i = 1; i < 100000; i++)
+		deep += "+ ";
+	RPN calculator;
+	if (calculator.evaluate(deep) != 100000)
+		return 6;
+	RPN copied(calculator);
+	if (copied.evaluate("8 9 * 9 - 9 - 9 - 4 - 1 +") != 42 || calculator.evaluate("7 7 * 7 -") != 42)
+		return 7;
+	try {
+		calculator.evaluate(deep + "+");
+		return 8;
+	} catch (const RPN::InsufficientOperandsException&) {
+	}
+	if (calculator.evaluate("1 2 * 2 / 2 * 2 4 - +") != 0)
+		return 9;
+	return 0;
+}
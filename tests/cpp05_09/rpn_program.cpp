@@ -0,0 +1,145 @@
+#include "RPN.hpp"
+#include "RPNProgram.hpp"
+#include "TestSupport.hpp"
+
+#include <string>
+
+// Mostly well-formed expressions; a few get a stray token or operator.
+static std::string randomExpression(void)
+{
+	static const char operators[] = "+-*/";
+	std::string expression;
+	size_t depth = 0;
+	size_t tokens = 1 + nextRandom() % 40;
+	for (size_t i = 0; i < tokens; i++) {
+		if (!expression.empty())
+			expression += nextRandom() % 8 == 0 ? "  \t" : " ";
+		if (depth >= 2 && nextRandom() % 2 == 0) {
+			expression += operators[nextRandom() % 4];
+			depth--;
+		} else {
+			expression += static_cast<char>('0' + nextRandom() % 10);
+			depth++;
+		}
+	}
+	while (depth > 1) {
+		expression += " *";
+		depth--;
+	}
+	if (nextRandom() % 16 == 0)
+		expression += nextRandom() % 2 == 0 ? " +" : " 12";
+	return expression;
+}
+
+enum Outcome {
+	VALUE,
+	INVALID,
+	DIVISION_BY_ZERO,
+	INSUFFICIENT
+};
+
+static Outcome interpret(RPN& calculator, const std::string& expression, int& value)
+{
+	try {
+		value = calculator.evaluate(expression);
+		return VALUE;
+	} catch (const RPN::DivisionByZeroException&) {
+		return DIVISION_BY_ZERO;
+	} catch (const RPN::InsufficientOperandsException&) {
+		return INSUFFICIENT;
+	} catch (const RPN::InvalidExpressionException&) {
+		return INVALID;
+	}
+}
+
+// A grammar error is found before anything runs, so evaluate() may have
+// hit a runtime error at an earlier token instead; once an expression
+// compiles, both must agree exactly.
+static Outcome compileAndRun(RPNProgram& program, const std::string& expression, int& value,
+	bool& compiled)
+{
+	compiled = false;
+	try {
+		program.compile(expression);
+	} catch (const RPN::InsufficientOperandsException&) {
+		return INSUFFICIENT;
+	} catch (const RPN::InvalidExpressionException&) {
+		return INVALID;
+	}
+	compiled = true;
+	try {
+		value = program.run();
+		return VALUE;
+	} catch (const RPN::DivisionByZeroException&) {
+		return DIVISION_BY_ZERO;
+	} catch (const RPN::InsufficientOperandsException&) {
+		return INSUFFICIENT;
+	} catch (const RPN::InvalidExpressionException&) {
+		return INVALID;
+	}
+}
+
+int main()
+{
+	RPN calculator;
+	RPNProgram program;
+	for (int i = 0; i < 50000; i++) {
+		std::string expression = randomExpression();
+		int expected = 0;
+		int value = 0;
+		Outcome interpreted = interpret(calculator, expression, expected);
+		bool compiled;
+		Outcome outcome = compileAndRun(program, expression, value, compiled);
+		if (compiled ? outcome != interpreted : interpreted == VALUE)
+			return 1;
+		if (value != expected)
+			return 2;
+	}
+
+	RPNProgram subject;
+	subject.compile("8 9 * 9 - 9 - 9 - 4 - 1 +");
+	if (subject.instructionCount() != 13 || subject.maxDepth() != 2)
+		return 3;
+	for (int i = 0; i < 3; i++) {
+		if (subject.run() != 42)
+			return 4;
+	}
+	RPNProgram copy(subject);
+	RPNProgram assigned;
+	assigned = subject;
+	if (copy.run() != 42 || assigned.run() != 42)
+		return 5;
+
+	// A failed compile keeps the previous program; a failed run leaves the
+	// program reusable.
+	try {
+		subject.compile("1 2");
+		return 6;
+	} catch (const RPN::InvalidExpressionException&) {
+	}
+	if (subject.run() != 42)
+		return 7;
+	RPNProgram overflow;
+	overflow.compile("9 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 *");
+	for (int i = 0; i < 2; i++) {
+		try {
+			overflow.run();
+			return 8;
+		} catch (const RPN::InvalidExpressionException&) {
+		}
+	}
+	RPNProgram empty;
+	if (empty.isCompiled())
+		return 9;
+	try {
+		empty.run();
+		return 10;
+	} catch (const RPN::InvalidExpressionException&) {
+	}
+	try {
+		empty.compile("(1 + 1)");
+		return 11;
+	} catch (const RPN::InvalidExpressionException&) {
+	}
+	return 0;
+}
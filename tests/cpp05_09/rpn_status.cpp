@@ -0,0 +1,147 @@
+#include "RPN.hpp"
+#include "TestSupport.hpp"
+
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+static std::string randomExpression(void)
+{
+	static const char* const tokens[] = {
+		"+", "-", "*", "/", "0", "1", "2", "5", "7", "9", "9", "9", "x", "12", "(", "-1"
+	};
+	static const char* const spaces[] = { " ", "  ", "\t", " \n " };
+	std::string expression;
+	size_t count = nextRandom() % 30;
+	for (size_t i = 0; i < count; i++) {
+		if (i > 0 || nextRandom() % 8 == 0)
+			expression += spaces[nextRandom() % 4];
+		size_t limit = nextRandom() % 10 == 0 ? 16 : 12;
+		expression += tokens[nextRandom() % limit];
+	}
+	return expression;
+}
+
+// The original istringstream evaluator, kept as the reference: status
+// and the index of the failing token, or the token count for leftovers.
+static RPN::Status reference(const std::string& expression, int& result, size_t& tokenIndex)
+{
+	if (expression.empty())
+		return RPN::EMPTY_EXPRESSION;
+	std::istringstream in(expression);
+	std::string token;
+	std::vector<int64_t> stack;
+	tokenIndex = 0;
+	for (; in >> token; tokenIndex++) {
+		if (token.size() == 1 && token[0] >= '0' && token[0] <= '9') {
+			stack.push_back(token[0] - '0');
+			continue;
+		}
+		if (token.size() != 1 || std::strchr("+-*/", token[0]) == NULL)
+			return RPN::INVALID_TOKEN;
+		if (stack.size() < 2)
+			return RPN::INSUFFICIENT_OPERANDS;
+		int64_t right = stack.back();
+		stack.pop_back();
+		int64_t& left = stack.back();
+		if (token[0] == '+')
+			left += right;
+		else if (token[0] == '-')
+			left -= right;
+		else if (token[0] == '*')
+			left *= right;
+		else if (right == 0)
+			return RPN::DIVISION_BY_ZERO;
+		else
+			left /= right;
+		if (left < -2147483647 - 1 || left > 2147483647)
+			return RPN::INTEGER_OVERFLOW;
+	}
+	if (stack.size() != 1)
+		return RPN::INVALID_EXPRESSION;
+	result = static_cast<int>(stack[0]);
+	return RPN::OK;
+}
+
+// Index of the token starting at `position`, or the token count when the
+// position is the end of the expression.
+static size_t tokenAt(const std::string& expression, size_t position)
+{
+	std::istringstream in(expression.substr(0, position));
+	std::string token;
+	size_t count = 0;
+	while (in >> token)
+		count++;
+	return count;
+}
+
+static RPN::Status thrownStatus(RPN& calculator, const std::string& expression, int& result)
+{
+	try {
+		result = calculator.evaluate(expression);
+		return RPN::OK;
+	} catch (const RPN::DivisionByZeroException&) {
+		return RPN::DIVISION_BY_ZERO;
+	} catch (const RPN::InsufficientOperandsException&) {
+		return RPN::INSUFFICIENT_OPERANDS;
+	} catch (const RPN::InvalidExpressionException& e) {
+		std::string message = e.what();
+		if (message == "Empty expression")
+			return RPN::EMPTY_EXPRESSION;
+		if (message.compare(0, 15, "Invalid token: ") == 0)
+			return RPN::INVALID_TOKEN;
+		if (message == "Integer overflow")
+			return RPN::INTEGER_OVERFLOW;
+		return RPN::INVALID_EXPRESSION;
+	}
+}
+
+static bool reports(const std::string& expression, RPN::Status status, size_t position)
+{
+	RPN calculator;
+	int result;
+	size_t at = 12345;
+	return calculator.tryEvaluate(expression, result, at) == status && at == position;
+}
+
+int main()
+{
+	RPN calculator;
+	for (int i = 0; i < 100000; i++) {
+		std::string expression = randomExpression();
+		int expected = 0;
+		size_t expectedToken = 0;
+		RPN::Status expectedStatus = reference(expression, expected, expectedToken);
+		int result = 0;
+		size_t position;
+		RPN::Status status = calculator.tryEvaluate(expression, result, position);
+		if (status != expectedStatus)
+			return 1;
+		if (status == RPN::OK && result != expected)
+			return 2;
+		if (status != RPN::OK && status != RPN::EMPTY_EXPRESSION
+			&& tokenAt(expression, position) != expectedToken)
+			return 3;
+		int thrown = 0;
+		if (thrownStatus(calculator, expression, thrown) != status || thrown != result)
+			return 4;
+	}
+
+	if (!reports("8 9 * 9 - 9 - 9 - 4 - 1 +", RPN::OK, 0) || !reports("", RPN::EMPTY_EXPRESSION, 0)
+		|| !reports("1 +", RPN::INSUFFICIENT_OPERANDS, 2) || !reports("1 2\tx", RPN::INVALID_TOKEN, 4)
+		|| !reports("1 0 /", RPN::DIVISION_BY_ZERO, 4) || !reports("1 2", RPN::INVALID_EXPRESSION, 3)
+		|| !reports("   ", RPN::INVALID_EXPRESSION, 3) || !reports("(1 + 1)", RPN::INVALID_TOKEN, 0)
+		|| !reports("1 12 +", RPN::INVALID_TOKEN, 2)
+		|| !reports("9 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 *", RPN::INTEGER_OVERFLOW, 36))
+		return 5;
+	try {
+		calculator.evaluate("1 2 +x 3");
+		return 6;
+	} catch (const RPN::InvalidExpressionException& e) {
+		if (std::string(e.what()) != "Invalid token: +x")
+			return 7;
+	}
+	return 0;
+}
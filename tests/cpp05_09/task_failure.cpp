@@ -0,0 +1,73 @@
+#include "TaskFailure.hpp"
+
+#include <cstring>
+#include <ios>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+// Returns 0 when `failure` rethrows an exception catchable as Expected
+// whose what() equals `text`.
+template <typename Expected>
+static int rethrowsAs(const TaskFailure& failure, const char* text)
+{
+	try {
+		failure.rethrow();
+	} catch (const Expected& error) {
+		if (text != NULL && std::strcmp(error.what(), text) != 0)
+			return 1;
+		return 0;
+	} catch (...) {
+		return 1;
+	}
+	return 1;
+}
+
+int main()
+{
+	TaskFailure failure;
+	if (failure.failed())
+		return 1;
+	failure.rethrow();
+
+	failure.capture(std::bad_alloc());
+	if (!failure.failed() || rethrowsAs<std::bad_alloc>(failure, NULL) != 0)
+		return 2;
+
+	failure.capture(std::length_error("vector::reserve"));
+	if (rethrowsAs<std::length_error>(failure, "vector::reserve") != 0)
+		return 3;
+
+	failure.capture(std::out_of_range("index"));
+	if (rethrowsAs<std::out_of_range>(failure, "index") != 0)
+		return 4;
+
+	failure.capture(std::invalid_argument("argument"));
+	if (rethrowsAs<std::logic_error>(failure, "argument") != 0)
+		return 5;
+
+	std::ios_base::failure streamError("stream");
+	failure.capture(streamError);
+	if (rethrowsAs<std::runtime_error>(failure, streamError.what()) != 0)
+		return 6;
+
+	// Long messages are cut to the buffer instead of allocating.
+	std::string longText(3 * TaskFailure::MESSAGE_CAPACITY, 'x');
+	failure.capture(std::runtime_error(longText));
+	std::string expected(TaskFailure::MESSAGE_CAPACITY - 1, 'x');
+	if (rethrowsAs<std::runtime_error>(failure, expected.c_str()) != 0)
+		return 7;
+
+	TaskFailure copy(failure);
+	if (rethrowsAs<std::runtime_error>(copy, expected.c_str()) != 0)
+		return 8;
+
+	failure.captureUnknown();
+	if (rethrowsAs<std::runtime_error>(failure, NULL) != 0)
+		return 9;
+
+	failure.clear();
+	if (failure.failed() || rethrowsAs<std::exception>(failure, NULL) != 1)
+		return 10;
+	return 0;
+}